@@ -20,6 +20,10 @@
 #define MQTT_TOPIC_DISTANCE     "agv/distance"
 #define MQTT_TOPIC_COLOR        "agv/color"
 #define MQTT_TOPIC_STATUS       "agv/sensors/status"
+#define MQTT_TOPIC_RFID_TAGS    "agv/rfid/tags"     // Assinado (/<UID>, retido): cadastro de tags do backend
+#define MQTT_TOPIC_COLOR_CALIB  "agv/color/calibrate"   // Assinado: comandos de calibração de cor
+#define MQTT_TOPIC_COLOR_CALIB_REPORT "agv/color/calibration" // Resultado de cada comando
+#define MQTT_IN_PAYLOAD_MAX     256                 // Maior mensagem recebida aceita
 
 // ========== PINAGEM RFID (MFRC522) ==========
 #define PIN_MISO    4   // SPI MISO
@@ -27,12 +31,30 @@
 #define PIN_SCK     2   // SPI Clock
 #define PIN_MOSI    3   // SPI MOSI
 #define PIN_RST     0   // Reset do MFRC522
+#define PIN_IRQ     1   // IRQ do MFRC522 (-1 = sem fio: conclusão consultada por SPI)
+
+// Segundo leitor no mesmo SPI0 (MISO/MOSI/SCK compartilhados, CS próprio).
+// Leitor ausente é detectado no boot (VersionReg) e fica desligado.
+#define RFID_READER_COUNT   2   // 1 = só o leitor principal
+#define PIN_CS2     17  // SPI CS do segundo leitor
+#define PIN_RST2    -1  // Reset do segundo leitor (-1 = ligado ao PIN_RST)
+#define PIN_IRQ2    22  // IRQ do segundo leitor (-1 = sem fio)
+
+// ========== SPI DO RFID ==========
+// O boot começa a 1 MHz; PCD_SetSpiClock sobe até o máximo que o chip aceita
+// sem erro (versão + FIFO de ida e volta), dividindo por 2 a cada falha
+#define RFID_SPI_BAUDRATE_MAX   10000000    // Limite do MFRC522 (10 Mbit/s)
+#define RFID_SPI_USE_DMA        1           // 1 = transações por DMA (fila); 0 = CPU
+#define SPI_DMA_QUEUE_LEN       16          // Transações na fila (armar um comando usa 7; dois leitores)
+#define SPI_DMA_MIN_BYTES       8           // Bloqueantes menores que isso vão pela CPU
+#define SPI_DMA_IRQ_INDEX       1           // DMA_IRQ_1 (compartilhado)
 
 // ========== PINAGEM SENSORES DE DISTÂNCIA (I2C0) ==========
 #define I2C_PORT        i2c0
 #define I2C_SDA_PIN     20
 #define I2C_SCL_PIN     21
 #define NUM_SENSORS     3
+#define VL53L0X_ADDR    0x29    // Endereço I2C dos VL53L0X (7 bits)
 
 // ========== PINAGEM MPU6050 (I2C1) ==========
 #define MPU_I2C_PORT    i2c1
@@ -44,26 +66,223 @@
 #define SENSOR_CHANNEL_CENTER   1   // Centro
 #define SENSOR_CHANNEL_RIGHT    2   // Direita
 #define SENSOR_CHANNEL_COLOR    7   // Sensor de cor GY-33
+#define PIN_MUX_RESET           -1  // RESET do TCA9548A (-1 = não ligado)
+
+// ========== DISTRIBUIÇÃO DOS SENSORES NOS BARRAMENTOS ==========
+// TOF_LAYOUT_MUX: os três VL53L0X e o GY-33 no I2C0, atrás do TCA9548A
+//   (todas as leituras dividem um único barramento)
+// TOF_LAYOUT_PIO: sem multiplexador; esquerda no I2C0, centro e direita em
+//   barramentos I2C em PIO (resultados lidos em paralelo), GY-33 no I2C1
+//   junto do MPU6050
+#define TOF_LAYOUT_MUX          0
+#define TOF_LAYOUT_PIO          1
+#define TOF_BUS_LAYOUT          TOF_LAYOUT_MUX
+
+// Barramentos PIO (SCL deve ser SDA + 1; pull-ups externos recomendados)
+#define PIO_I2C_CENTER_SDA_PIN  6
+#define PIO_I2C_CENTER_SCL_PIN  7
+#define PIO_I2C_RIGHT_SDA_PIN   8
+#define PIO_I2C_RIGHT_SCL_PIN   9
+#define PIO_I2C_BAUDRATE        400000
+
+// ========== BARRAMENTO I2C (TIMEOUTS E RECUPERAÇÃO) ==========
+// Timeout de cada transferência: base (endereço + clock stretching) + por byte
+// (um byte a 400 kHz leva ~23 us; a folga cobre clock stretching)
+#define I2C_BUS_TIMEOUT_BASE_US     2000
+#define I2C_BUS_TIMEOUT_PER_BYTE_US 100
+#define I2C_BUS_RECOVER_ERRORS      8       // Falhas seguidas no barramento -> bus-clear + reset do mux
+#define BUS_DEVICE_OFFLINE_ERRORS   3       // Falhas seguidas no dispositivo -> offline
+#define BUS_DEVICE_REPROBE_MS       1000    // Intervalo entre tentativas de religar um dispositivo offline
+#define BUS_SUPERVISOR_MAX_DEVICES  8
 
 // ========== CONFIGURAÇÕES DE OPERAÇÃO ==========
-#define SCAN_INTERVAL_MS        100     // Intervalo entre leituras
-#define RFID_DEBOUNCE_TIME_MS   3000    // Tempo para ignorar mesma tag
+#define SCAN_INTERVAL_MS        100     // Espera máxima do loop sem nenhum prazo (rede, publicações)
+#define LOOP_BUSY_POLL_US       1000    // Consulta de medição ToF atrasada
+#define RFID_DEBOUNCE_TIME_MS   3000    // Tag não é republicada até ficar esse tempo sem ser vista
+#define RFID_POLL_FAST_MS       20      // Intervalo entre REQAs perto de uma tag esperada
+#define RFID_POLL_SLOW_MS       100     // Intervalo entre REQAs no resto do percurso
+#define RFID_BUSY_POLL_US       1000    // Consulta do leitor com comando no RF (sem pino IRQ)
+#define RFID_STEPS_PER_PASS     16      // Limite de passos por leitor a cada passagem do loop
+#define RFID_EXPECT_WINDOW_MS   2000    // Taxa alta mantida após uma leitura ou aviso de tag
+#define RFID_INVENTORY_MAX      8       // Tags lidas por ciclo de inventário (WUPA -> ... -> REQA sem resposta)
+#define TAG_CACHE_SIZE          16      // UIDs lembrados para não republicar a mesma tag
+#define RFID_TAG_OVERLAY_SIZE   16      // Tags alteradas por MQTT desde o último build
 #define RECONNECT_DELAY_MS      5000    // Delay antes de reconectar MQTT
 #define STATUS_PUBLISH_INTERVAL 30000000 // 30 segundos em microsegundos
+#define STATUS_PAYLOAD_MAX      2048    // Payload do status (cabe em MQTT_OUTPUT_RINGBUF_SIZE)
+#define LED_BLINK_MS            50      // LED apagado a cada publicação confirmada (volta no loop)
 
 // ========== FILTRO DE MEDIÇÃO ==========
-#define FILTER_SIZE             10      // Tamanho do buffer de média móvel
 #define DISTANCE_OFFSET         13      // Offset de calibração do sensor (mm)
 
+// Qualidade mínima e pesos (taxas em centésimos de MCPS)
+#define DIST_FILTER_MIN_SIGNAL_CMCPS    25      // Abaixo: amostra rejeitada (0.25 MCPS)
+#define DIST_FILTER_FULL_SIGNAL_CMCPS   500     // A partir daqui: peso máximo (5 MCPS)
+#define DIST_FILTER_MAX_AMBIENT_RATIO   4       // Ambiente > 4x sinal: rejeitada
+#define DIST_FILTER_ALPHA_MIN_Q8        32      // Peso da amostra com sinal fraco (/256)
+#define DIST_FILTER_ALPHA_MAX_Q8        160     // Peso da amostra com sinal forte (/256)
+#define DIST_FILTER_JUMP_MM             150     // Saltos maiores exigem 2 amostras consistentes
+#define DIST_FILTER_NO_TARGET_MM        8190    // Valor reportado sem alvo no alcance
+#define DIST_FILTER_NO_TARGET_CONFIRM   3       // Amostras "sem alvo" seguidas para confirmar
+
+// ========== DRIVER VL53L0X ==========
+// 1 = tabela de tuning com escritas contíguas em rajada (gerada no build por
+// tools/gen_vl53l0x_tuning.py); 0 = tabela original da ST, byte a byte
+#define VL53L0X_BURST_TUNING            1
+// 1 = cache write-through dos registradores de configuração (leituras repetidas
+// da API da ST não vão ao barramento); registradores de status/resultado sempre vão
+#define VL53L0X_REGISTER_CACHE          1
+// 1 = medições em regime permanente pelo caminho enxuto (VL53L0X_Lean*: uma
+// leitura em rajada por resultado); 0 = cadeia completa da API da ST
+#define VL53L0X_LEAN_RANGING            1
+// 1 = o caminho enxuto também verifica SIGNAL_REF_CLIP (+3 transações por medição)
+#define VL53L0X_LEAN_REF_CLIP           0
+
+// ========== PERFIS DE MEDIÇÃO VL53L0X ==========
+// Troca automática por sensor: high_speed / default / long_range / high_accuracy
+#define TOF_NEAR_ENTER_MM               400     // Abaixo: perfil rápido
+#define TOF_NEAR_EXIT_MM                500     // Sai do perfil rápido acima disso
+#define TOF_FAR_ENTER_MM                1000    // Acima: perfil de longo alcance
+#define TOF_FAR_EXIT_MM                 850     // Sai do longo alcance abaixo disso
+#define TOF_APPROACH_MM_S               150     // Aproximação que força o perfil rápido
+#define TOF_FAST_VEHICLE_MM_S           300     // Veículo acima disso: perfil rápido
+#define TOF_WEAK_SIGNAL_CMCPS           50      // Sinal abaixo de 0.5 MCPS: longo alcance
+#define TOF_ALLOW_HIGH_ACCURACY         1       // Usa 200 ms com o veículo parado
+#define TOF_PROFILE_CONFIRM             3       // Avaliações seguidas para trocar
+#define TOF_PROFILE_MIN_DWELL_MS        500     // Permanência mínima em um perfil
+
+// Intervalo mínimo entre medições de cada sensor conforme o perfil
+#define TOF_INTERVAL_HIGH_SPEED_MS      0       // Toda iteração
+#define TOF_INTERVAL_DEFAULT_MS         60
+#define TOF_INTERVAL_LONG_RANGE_MS      150
+#define TOF_INTERVAL_HIGH_ACCURACY_MS   150
+// Folga do loop entre o sensor ficar devido e a amostra chegar ao reflexo;
+// intervalo + budget + folga de cada perfil < SAFETY_STALE_TIMEOUT_MS
+#define TOF_STALE_MARGIN_MS             100
+
+// Medição disparada sem resultado após este tempo é descartada (> maior timing budget)
+#define TOF_RANGING_TIMEOUT_MS          250
+
+// ========== REFLEXO DE SEGURANÇA (PARADA LOCAL) ==========
+// Avaliado a cada leitura dos sensores de distância, sem depender do MQTT
+#define PIN_SAFETY_STOP             14      // Linha de parada para o controlador de motores
+#define PIN_SAFETY_SLOW             15      // Linha de redução de velocidade
+#define SAFETY_OUTPUT_ACTIVE_HIGH   1       // 1 = nível alto aciona a linha
+
+// Zonas por sensor (mm, já descontado DISTANCE_OFFSET)
+#define SAFETY_STOP_MM_LEFT         120
+#define SAFETY_STOP_MM_CENTER       200
+#define SAFETY_STOP_MM_RIGHT        120
+#define SAFETY_SLOW_MM_LEFT         250
+#define SAFETY_SLOW_MM_CENTER       450
+#define SAFETY_SLOW_MM_RIGHT        250
+#define SAFETY_HYSTERESIS_MM        40      // Folga para sair de uma zona
+
+// Tempo até colisão (distância / velocidade de aproximação)
+#define SAFETY_TTC_STOP_MS          600
+#define SAFETY_TTC_SLOW_MS          1500
+#define SAFETY_MIN_CLOSING_MM_S     60      // Abaixo disso não calcula TTC (ruído)
+#define SAFETY_RANGE_MAX_MM         2000    // Leituras acima = sem obstáculo
+
+#define SAFETY_RELEASE_HOLD_MS      500     // Tempo livre antes de liberar a parada
+#define SAFETY_STALE_TIMEOUT_MS     500     // Sensor sem leitura válida -> parada
+#define SAFETY_CHECK_INTERVAL_MS    10      // Reavaliação por timer (independe do loop)
+#define SAFETY_EVENT_QUEUE_SIZE     16      // Eventos pendentes (potência de 2)
+// Sensores fora do reflexo (bit i = sensor i: 1 esquerda, 2 centro, 4 direita).
+// Só para montagens sem o sensor: um sensor configurado que falha, no boot ou
+// em operação, mantém a parada até o supervisor religá-lo.
+#define SAFETY_SENSOR_EXCLUDE_MASK  0
+#define MQTT_TOPIC_SAFETY           "agv/safety"
+
 // ========== CONFIGURAÇÕES MPU6050 ==========
 #define MPU6050_ADDR        0x68    // Endereço I2C
 #define MQTT_TOPIC_IMU      "agv/imu"
 
 // ========== CONFIGURAÇÕES SENSOR DE COR GY-33 ==========
-// Nota: O sensor GY-33 usa o barramento I2C0 (GP20/GP21)
-// Conectado no canal 7 do multiplexador TCA9548A
-#define GY33_I2C_PORT       I2C_PORT        // i2c0 (compartilhado com sensores de distância)
+// Nota: Na montagem TOF_LAYOUT_MUX o sensor GY-33 usa o barramento I2C0
+// (GP20/GP21), compartilhado com os sensores de distância, no canal 7 do
+// multiplexador TCA9548A; em TOF_LAYOUT_PIO fica no I2C1 (GP18/GP19)
 #define GY33_CHANNEL        SENSOR_CHANNEL_COLOR  // Canal 7 do TCA9548A
 #define GY33_ADDR           0x29            // Endereço I2C do TCS34725
 
+// Exposição: a integração define a taxa de leitura (2,4 ms por ciclo, mais
+// 2,4 ms de inicialização do ADC). 6 ciclos = 14,4 ms -> um ciclo a cada
+// ~17 ms (~59/s nominal); o loop agenda a leitura pelo fim do ciclo e a taxa
+// real sai no status (color_sensor.rate_hz).
+#define GY33_INTEGRATION_CYCLES 6           // Também o máximo da exposição automática
+#define GY33_GAIN_DEFAULT   GY33_GAIN_16X   // Integração curta: compensa no ganho
+#define GY33_WAIT_MS        0               // Espera entre leituras (0 = taxa máxima)
+
+// Exposição automática: mantém o canal clear nesta faixa do fundo de escala
+// (ciclos x 1024). Cada ajuste muda a exposição em até 4x (ganho) ou 2x (integração).
+#define GY33_AE_HIGH_PCT    80              // Acima: reduz ganho, depois integração
+#define GY33_AE_LOW_PCT     10              // Abaixo: aumenta integração, depois ganho
+#define GY33_AE_MIN_CYCLES  1               // Integração mínima (2,4 ms) sob luz forte
+
+// Classificação: tabela de (2^COLOR_LUT_BITS)² células de 1 byte em RAM
+// (7 bits = 16 KB, passo de 0,0078 na cromaticidade)
+#define COLOR_LUT_BITS      7
+#define COLOR_MIN_CLEAR     30              // Abaixo: pouca luz, sem cor
+#define COLOR_MATCH_MAX_SIGMA   3           // Desvios-padrão em que a confiança chega a 0
+#define COLOR_DEFAULT_SIGMA_MILLI   27      // Dispersão (x1000) das cores de fábrica
+#define COLOR_SIGMA_MIN_MILLI   3           // Ruído mínimo somado a toda cor (x1000)
+
+// Calibração em campo (comandos em MQTT_TOPIC_COLOR_CALIB)
+// 64 leituras a ~59/s nominais (GY33_INTEGRATION_CYCLES) = ~1,1 s; o prazo
+// cobre o dobro disso, e a coleta que termina com menos da metade falha
+#define COLOR_CALIB_SAMPLES     64          // Leituras por cor (~1,1 s)
+#define COLOR_CALIB_TIMEOUT_MS  2500        // Prazo da coleta (~2x a duração nominal)
+#define COLOR_CALIB_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE) // Último setor
+#define COLOR_CALIB_FLASH_TIMEOUT_MS 100    // Espera pelo core1 antes de gravar
+
+// Despertar por limiar: no piso liso a leitura para e o TCS34725 avisa pelo
+// pino INT quando o canal clear sai da faixa do piso (borda de marcador). O
+// marcador precisa diferir do piso em brilho por mais que a faixa.
+#define PIN_COLOR_INT           16          // INT do TCS34725 (dreno aberto; -1 = sem fio: leitura contínua)
+#define COLOR_WAKE_BAND_PCT     25          // Faixa do piso: ± % do canal clear
+#define COLOR_WAKE_BAND_MIN     40          // Faixa mínima (contagens) com pouca luz
+#define COLOR_WAKE_PERSISTENCE  2           // PERS: ciclos seguidos fora da faixa (0..3 = 0..3, 4 = 5, 5 = 10, ...)
+#define COLOR_WAKE_QUIET_SAMPLES 16         // Leituras no piso antes de armar (16 ciclos do sensor, ~270 ms)
+#define COLOR_WAKE_HEARTBEAT_MS 500         // Leitura de conferência com o sensor armado
+#define COLOR_WAKE_FLOOR_SHIFT  3           // Média móvel do piso: 1/8 por leitura
+
+// Eventos de marcador (entrada/saída): votação sobre as últimas leituras.
+// A janela é dimensionada pelo ciclo do sensor ((ciclos + 1) x 2,4 ms, uma
+// leitura por ciclo com o loop pelo prazo): 6 ciclos = 16,8 ms -> 8 amostras
+// em ~135 ms. Um marcador de 3 cm a 0,3 m/s (100 ms) rende ~6 leituras.
+#define COLOR_VOTE_WINDOW_MS    135
+#define COLOR_VOTE_WINDOW       (COLOR_VOTE_WINDOW_MS * 10 / (24 * (GY33_INTEGRATION_CYCLES + 1)))
+#define COLOR_ENTER_VOTES       (COLOR_VOTE_WINDOW / 2)     // Votos da cor mais votada para entrar
+#define COLOR_STAY_VOTES        (COLOR_VOTE_WINDOW / 4)     // Abaixo disso, sai do marcador (histerese)
+#define COLOR_MIN_CONFIDENCE    4           // Leituras menos confiáveis contam como piso
+#define COLOR_EVENT_QUEUE_SIZE  8           // Eventos pendentes (potência de 2)
+
+// ========== LOG ==========
+// Níveis: LOG_LEVEL_NONE, LOG_LEVEL_ERROR, LOG_LEVEL_WARN, LOG_LEVEL_INFO, LOG_LEVEL_DEBUG
+// Mensagens acima do nível do módulo são removidas na compilação
+#define LOG_LEVEL_DEFAULT   LOG_LEVEL_INFO
+#define LOG_LEVEL_SYS       LOG_LEVEL_INFO
+#define LOG_LEVEL_WIFI      LOG_LEVEL_INFO
+#define LOG_LEVEL_MQTT      LOG_LEVEL_INFO
+#define LOG_LEVEL_RFID      LOG_LEVEL_INFO
+#define LOG_LEVEL_DIST      LOG_LEVEL_INFO
+#define LOG_LEVEL_IMU       LOG_LEVEL_INFO
+#define LOG_LEVEL_COLOR     LOG_LEVEL_INFO
+
+#define LOG_BUFFER_WORDS    1024    // Buffer circular (palavras de 32 bits, potência de 2)
+#define LOG_DRAIN_ON_CORE1  1       // 1 = core1 formata e envia; 0 = loop principal
+#define LOG_DRAIN_BATCH     16      // Registros por iteração quando drenado no loop
+#define LOG_OUTPUT_BINARY   0       // 1 = frames binários (tools/log_decoder.py)
+
+// ========== BENCHMARK ==========
+// 1 = mede no boot os ciclos das conversões em float vs ponto fixo (SysTick)
+#define BENCHMARK_FIXED_POINT   0
+// 1 = compara no boot o custo por medição da API da ST x caminho enxuto (sensor 0)
+#define BENCHMARK_VL53L0X_RANGING   0
+// 1 = mede no boot a vazão de leitura dos resultados de todos os VL53L0X
+// (um por vez x em grupo); comparar os números de TOF_LAYOUT_MUX e TOF_LAYOUT_PIO
+#define BENCHMARK_TOF_BUSES         0
+// 1 = compara no boot a leitura do FIFO do MFRC522 byte a byte x em rajada SPI
+#define BENCHMARK_MFRC522_SPI       0
+
 #endif // CONFIG_H
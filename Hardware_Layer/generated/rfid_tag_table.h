@@ -0,0 +1,29 @@
+// Gerado por tools/gen_rfid_table.py a partir de data/rfid-tags.json - não editar
+#ifndef RFID_TAG_TABLE_H
+#define RFID_TAG_TABLE_H
+
+#define RFID_TAG_TABLE_COUNT  5
+#define RFID_TAG_NODE_COUNT   0
+
+static const char *const RFID_TAG_NODES[RFID_TAG_NODE_COUNT + 1] = {
+    NULL
+};
+
+static const char RFID_TAG_NAMES[] =
+    "Cadeira\0"
+    "casa\0"
+    "Ar condicionado\0"
+    "Rem\303\251dio\0"
+    "Mercadoria\0"
+    "";
+
+static const rfid_tag_entry_t RFID_TAG_TABLE[RFID_TAG_TABLE_COUNT + 1] = {
+    { { 0x14, 0x57, 0x92, 0xE1 }, 4, 0xFF, 0 },  // 145792E1
+    { { 0x54, 0x84, 0xBF, 0xE1 }, 4, 0xFF, 8 },  // 5484BFE1
+    { { 0x74, 0x36, 0x8D, 0xE1 }, 4, 0xFF, 13 },  // 74368DE1
+    { { 0x91, 0xB6, 0x57, 0xA4 }, 4, 0xFF, 29 },  // 91B657A4
+    { { 0xE4, 0xAC, 0xB8, 0xE1 }, 4, 0xFF, 38 },  // E4ACB8E1
+    { { 0 }, 0, 0, 0 }
+};
+
+#endif // RFID_TAG_TABLE_H
@@ -0,0 +1,73 @@
+// Gerado por tools/gen_vl53l0x_tuning.py a partir de vl53l0x_tuning.h - não editar
+#ifndef VL53L0X_TUNING_BURST_H
+#define VL53L0X_TUNING_BURST_H
+
+#include <stdint.h>
+
+#define VL53L0X_TUNING_WRITES_DEFAULT  80   // Transações da tabela original
+#define VL53L0X_TUNING_WRITES_BURST    59   // Transações desta tabela
+
+static const uint8_t VL53L0X_TuningSettingsBurst[] = {
+    0x01, 0xFF, 0x01,
+    0x01, 0x00, 0x00,
+    0x01, 0xFF, 0x00,
+    0x01, 0x09, 0x00,
+    0x02, 0x10, 0x00, 0x00,
+    0x02, 0x24, 0x01, 0xFF,
+    0x01, 0x75, 0x00,
+    0x01, 0xFF, 0x01,
+    0x01, 0x4E, 0x2C,
+    0x01, 0x48, 0x00,
+    0x01, 0x30, 0x20,
+    0x01, 0xFF, 0x00,
+    0x01, 0x30, 0x09,
+    0x01, 0x54, 0x00,
+    0x02, 0x31, 0x04, 0x03,
+    0x01, 0x40, 0x83,
+    0x01, 0x46, 0x25,
+    0x01, 0x60, 0x00,
+    0x01, 0x27, 0x00,
+    0x03, 0x50, 0x06, 0x00, 0x96,
+    0x02, 0x56, 0x08, 0x30,
+    0x02, 0x61, 0x00, 0x00,
+    0x03, 0x64, 0x00, 0x00, 0xA0,
+    0x01, 0xFF, 0x01,
+    0x01, 0x22, 0x32,
+    0x01, 0x47, 0x14,
+    0x02, 0x49, 0xFF, 0x00,
+    0x01, 0xFF, 0x00,
+    0x02, 0x7A, 0x0A, 0x00,
+    0x01, 0x78, 0x21,
+    0x01, 0xFF, 0x01,
+    0x01, 0x23, 0x34,
+    0x01, 0x42, 0x00,
+    0x03, 0x44, 0xFF, 0x26, 0x05,
+    0x01, 0x40, 0x40,
+    0x01, 0x0E, 0x06,
+    0x01, 0x20, 0x1A,
+    0x01, 0x43, 0x40,
+    0x01, 0xFF, 0x00,
+    0x02, 0x34, 0x03, 0x44,
+    0x01, 0xFF, 0x01,
+    0x01, 0x31, 0x04,
+    0x03, 0x4B, 0x09, 0x05, 0x04,
+    0x01, 0xFF, 0x00,
+    0x02, 0x44, 0x00, 0x20,
+    0x02, 0x47, 0x08, 0x28,
+    0x01, 0x67, 0x00,
+    0x03, 0x70, 0x04, 0x01, 0xFE,
+    0x02, 0x76, 0x00, 0x00,
+    0x01, 0xFF, 0x01,
+    0x01, 0x0D, 0x01,
+    0x01, 0xFF, 0x00,
+    0x01, 0x80, 0x01,
+    0x01, 0x01, 0xF8,
+    0x01, 0xFF, 0x01,
+    0x01, 0x8E, 0x01,
+    0x01, 0x00, 0x01,
+    0x01, 0xFF, 0x00,
+    0x01, 0x80, 0x00,
+    0x00
+};
+
+#endif // VL53L0X_TUNING_BURST_H
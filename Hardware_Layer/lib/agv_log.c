@@ -0,0 +1,178 @@
+#include "agv_log.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+// --- Buffer circular ---
+// Cada registro ocupa (3 + nargs) palavras:
+//   [0] nargs | nível/módulo << 8
+//   [1] timestamp (us desde o boot)
+//   [2] endereço da string de formato
+//   [3..] argumentos
+
+#define LOG_MASK (LOG_BUFFER_WORDS - 1)
+#define LOG_HEADER_WORDS 3
+
+#if (LOG_BUFFER_WORDS & LOG_MASK) != 0
+#error "LOG_BUFFER_WORDS deve ser potencia de 2"
+#endif
+
+static uint32_t log_buffer[LOG_BUFFER_WORDS];
+static volatile uint32_t log_head = 0;  // Escrito pelos produtores (sob spinlock)
+static volatile uint32_t log_tail = 0;  // Escrito apenas pelo consumidor
+static volatile uint32_t log_dropped_count = 0;
+static uint32_t log_dropped_reported = 0;
+static spin_lock_t *log_lock = NULL;
+
+// --- Funções Internas ---
+
+#if LOG_OUTPUT_BINARY
+// Escreve bytes sem tradução de CR/LF
+static void log_emit_bytes(const uint8_t *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        putchar_raw(data[i]);
+    }
+}
+
+static void log_emit_word(uint32_t value) {
+    uint8_t bytes[4] = {
+        (uint8_t)value, (uint8_t)(value >> 8),
+        (uint8_t)(value >> 16), (uint8_t)(value >> 24)
+    };
+    log_emit_bytes(bytes, 4);
+}
+
+// Frame: A5 5A | nargs | nível/módulo | timestamp | formato | args (LE)
+static void log_emit_record(uint8_t level_module, uint32_t timestamp,
+                            const char *fmt, const uint32_t *args, uint8_t nargs) {
+    uint8_t header[4] = {AGV_LOG_SYNC0, AGV_LOG_SYNC1, nargs, level_module};
+    log_emit_bytes(header, 4);
+    log_emit_word(timestamp);
+    log_emit_word((uint32_t)(uintptr_t)fmt);
+    for (uint8_t i = 0; i < nargs; i++) {
+        log_emit_word(args[i]);
+    }
+}
+#else
+// Formata o registro em texto (printf ignora argumentos excedentes)
+static void log_emit_record(uint8_t level_module, uint32_t timestamp,
+                            const char *fmt, const uint32_t *args, uint8_t nargs) {
+    (void)level_module;
+    (void)timestamp;
+    (void)nargs;
+    printf(fmt, args[0], args[1], args[2], args[3],
+           args[4], args[5], args[6], args[7]);
+}
+#endif
+
+#if LOG_DRAIN_ON_CORE1
+// Laço do core1: dorme até um produtor sinalizar (__sev) e esvazia o buffer
+static void log_core1_entry(void) {
+    // Permite ao core0 pausar este core durante escritas na flash
+    multicore_lockout_victim_init();
+    while (1) {
+        if (agv_log_drain(UINT32_MAX) == 0) {
+            __wfe();
+        }
+    }
+}
+#endif
+
+// --- Funções Públicas (declaradas em agv_log.h) ---
+
+void agv_log_init(void) {
+    log_lock = spin_lock_instance(spin_lock_claim_unused(true));
+    log_head = 0;
+    log_tail = 0;
+    log_dropped_count = 0;
+
+#if LOG_DRAIN_ON_CORE1
+    multicore_launch_core1(log_core1_entry);
+#endif
+}
+
+void agv_log_write(uint8_t level_module, const char *fmt, const uint32_t *args, uint8_t nargs) {
+    if (log_lock == NULL) return;  // Ainda não inicializado
+    if (nargs > AGV_LOG_MAX_ARGS) nargs = AGV_LOG_MAX_ARGS;
+
+    uint32_t words = LOG_HEADER_WORDS + nargs;
+    uint32_t timestamp = time_us_32();
+
+    uint32_t irq_state = spin_lock_blocking(log_lock);
+
+    uint32_t head = log_head;
+    uint32_t used = head - log_tail;
+    if (LOG_BUFFER_WORDS - used < words) {
+        log_dropped_count++;
+        spin_unlock(log_lock, irq_state);
+        return;
+    }
+
+    log_buffer[head++ & LOG_MASK] = nargs | ((uint32_t)level_module << 8);
+    log_buffer[head++ & LOG_MASK] = timestamp;
+    log_buffer[head++ & LOG_MASK] = (uint32_t)(uintptr_t)fmt;
+    for (uint8_t i = 0; i < nargs; i++) {
+        log_buffer[head++ & LOG_MASK] = args[i];
+    }
+
+    __dmb();  // Conteúdo visível antes do novo head
+    log_head = head;
+
+    spin_unlock(log_lock, irq_state);
+    __sev();
+}
+
+uint32_t agv_log_drain(uint32_t max_records) {
+    uint32_t count = 0;
+    uint32_t tail = log_tail;
+
+    while (count < max_records && tail != log_head) {
+        __dmb();
+        uint32_t first = log_buffer[tail & LOG_MASK];
+        uint8_t nargs = (uint8_t)(first & 0xFF);
+        uint8_t level_module = (uint8_t)(first >> 8);
+        uint32_t timestamp = log_buffer[(tail + 1) & LOG_MASK];
+        const char *fmt = (const char *)(uintptr_t)log_buffer[(tail + 2) & LOG_MASK];
+
+        uint32_t args[AGV_LOG_MAX_ARGS] = {0};
+        for (uint8_t i = 0; i < nargs; i++) {
+            args[i] = log_buffer[(tail + LOG_HEADER_WORDS + i) & LOG_MASK];
+        }
+
+        // Libera o espaço antes de formatar (a saída pode ser lenta)
+        tail += LOG_HEADER_WORDS + nargs;
+        __dmb();
+        log_tail = tail;
+
+        log_emit_record(level_module, timestamp, fmt, args, nargs);
+        count++;
+    }
+
+    // Informa descartes acumulados desde o último aviso
+    uint32_t dropped = log_dropped_count;
+    if (dropped != log_dropped_reported) {
+        uint32_t args[AGV_LOG_MAX_ARGS] = {dropped - log_dropped_reported};
+        log_dropped_reported = dropped;
+        log_emit_record((LOG_LEVEL_WARN << 5) | LOG_MODULE_ID_SYS, time_us_32(),
+                        "[LOG] %lu registros descartados (buffer cheio)\n", args, 1);
+    }
+
+    return count;
+}
+
+void agv_log_flush(void) {
+#if LOG_DRAIN_ON_CORE1
+    absolute_time_t deadline = make_timeout_time_ms(LOG_FLUSH_TIMEOUT_MS);
+    while (log_tail != log_head && !time_reached(deadline)) {
+        tight_loop_contents();
+    }
+#else
+    agv_log_drain(UINT32_MAX);
+#endif
+    stdio_flush();
+}
+
+uint32_t agv_log_dropped(void) {
+    return log_dropped_count;
+}
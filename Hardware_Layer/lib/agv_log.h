@@ -0,0 +1,163 @@
+#ifndef AGV_LOG_H
+#define AGV_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+// =====================================================
+// Log com níveis em tempo de compilação e saída adiada
+//
+// Cada módulo tem seu nível em config.h (LOG_LEVEL_<MOD>). Chamadas acima
+// do nível viram "if (0)" e são removidas pelo compilador, junto com a
+// string de formato. As chamadas habilitadas apenas copiam (formato +
+// argumentos) para um buffer circular binário; a formatação e o envio para
+// UART/USB acontecem no core1 (ou em agv_log_drain() no loop principal).
+//
+// Restrições dos argumentos: no máximo AGV_LOG_MAX_ARGS valores inteiros de
+// até 32 bits ou ponteiros para strings constantes (literais, tabelas em
+// flash). Floats e inteiros de 64 bits não são aceitos (erro de compilação)
+// e "%s" nunca deve apontar para buffers na pilha, pois a formatação ocorre
+// depois.
+// =====================================================
+
+// Níveis de log
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+#ifndef LOG_LEVEL_DEFAULT
+#define LOG_LEVEL_DEFAULT   LOG_LEVEL_INFO
+#endif
+
+// Identificadores dos módulos (gravados no frame binário)
+#define LOG_MODULE_ID_SYS       0
+#define LOG_MODULE_ID_WIFI      1
+#define LOG_MODULE_ID_MQTT      2
+#define LOG_MODULE_ID_RFID      3
+#define LOG_MODULE_ID_DIST      4
+#define LOG_MODULE_ID_IMU       5
+#define LOG_MODULE_ID_COLOR     6
+
+// Nível de cada módulo (pode ser sobrescrito em config.h)
+#ifndef LOG_LEVEL_SYS
+#define LOG_LEVEL_SYS       LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_WIFI
+#define LOG_LEVEL_WIFI      LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_MQTT
+#define LOG_LEVEL_MQTT      LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_RFID
+#define LOG_LEVEL_RFID      LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_DIST
+#define LOG_LEVEL_DIST      LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_IMU
+#define LOG_LEVEL_IMU       LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_COLOR
+#define LOG_LEVEL_COLOR     LOG_LEVEL_DEFAULT
+#endif
+
+// Tamanho do buffer circular em palavras de 32 bits (potência de 2)
+#ifndef LOG_BUFFER_WORDS
+#define LOG_BUFFER_WORDS    1024
+#endif
+
+// 1 = drenagem contínua no core1; 0 = chamar agv_log_drain() no loop
+#ifndef LOG_DRAIN_ON_CORE1
+#define LOG_DRAIN_ON_CORE1  1
+#endif
+
+// 1 = frames binários (decodificar com tools/log_decoder.py); 0 = texto
+#ifndef LOG_OUTPUT_BINARY
+#define LOG_OUTPUT_BINARY   0
+#endif
+
+// Espera máxima de agv_log_flush() pelo core1 (ms)
+#ifndef LOG_FLUSH_TIMEOUT_MS
+#define LOG_FLUSH_TIMEOUT_MS 500
+#endif
+
+#define AGV_LOG_MAX_ARGS    8
+
+// Marcador de início de frame binário: A5 5A
+#define AGV_LOG_SYNC0       0xA5
+#define AGV_LOG_SYNC1       0x5A
+
+// --- Macros públicas ---
+
+#define LOG_E(mod, fmt, ...) AGV_LOG(mod, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_W(mod, fmt, ...) AGV_LOG(mod, LOG_LEVEL_WARN,  fmt, ##__VA_ARGS__)
+#define LOG_I(mod, fmt, ...) AGV_LOG(mod, LOG_LEVEL_INFO,  fmt, ##__VA_ARGS__)
+#define LOG_D(mod, fmt, ...) AGV_LOG(mod, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+// Verdadeiro em tempo de compilação se o nível estiver habilitado no módulo
+#define LOG_ENABLED(mod, lvl) ((lvl) <= LOG_LEVEL_##mod)
+
+#define AGV_LOG(mod, lvl, fmt, ...) do {                                        \
+    if (LOG_ENABLED(mod, lvl)) {                                                \
+        const uint32_t _agv_log_args[] = { 0 AGV_LOG_MAP(__VA_ARGS__) };        \
+        agv_log_write((uint8_t)(((lvl) << 5) | LOG_MODULE_ID_##mod), fmt,       \
+                      &_agv_log_args[1], AGV_LOG_NARGS(__VA_ARGS__));           \
+    }                                                                           \
+} while (0)
+
+// --- Detalhes internos das macros ---
+
+#define AGV_LOG_NARGS(...) AGV_LOG_NARGS_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define AGV_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
+// Floats e inteiros de 64 bits (int64_t/uint64_t, ex. time_us_64()) são
+// recusados em tempo de compilação: o registro guarda 32 bits por argumento
+// e o valor sairia truncado. A chamada nunca é gerada para os demais tipos,
+// pois _Generic descarta o ramo não selecionado.
+uint32_t agv_log_float_arg(void)
+    __attribute__((error("LOG_x nao aceita float/double: converta para inteiro")));
+uint32_t agv_log_wide_arg(void)
+    __attribute__((error("LOG_x nao aceita inteiro de 64 bits: converta para 32 bits")));
+
+#define AGV_LOG_ARG(x) , _Generic((x),                                          \
+    float: agv_log_float_arg(),                                                 \
+    double: agv_log_float_arg(),                                                \
+    long long: agv_log_wide_arg(),                                              \
+    unsigned long long: agv_log_wide_arg(),                                     \
+    default: (uint32_t)(uintptr_t)(x))
+#define AGV_LOG_MAP(...) AGV_LOG_CAT(AGV_LOG_MAP_, AGV_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define AGV_LOG_CAT(a, b) AGV_LOG_CAT_(a, b)
+#define AGV_LOG_CAT_(a, b) a##b
+#define AGV_LOG_MAP_0(...)
+#define AGV_LOG_MAP_1(a) AGV_LOG_ARG(a)
+#define AGV_LOG_MAP_2(a, ...) AGV_LOG_ARG(a) AGV_LOG_MAP_1(__VA_ARGS__)
+#define AGV_LOG_MAP_3(a, ...) AGV_LOG_ARG(a) AGV_LOG_MAP_2(__VA_ARGS__)
+#define AGV_LOG_MAP_4(a, ...) AGV_LOG_ARG(a) AGV_LOG_MAP_3(__VA_ARGS__)
+#define AGV_LOG_MAP_5(a, ...) AGV_LOG_ARG(a) AGV_LOG_MAP_4(__VA_ARGS__)
+#define AGV_LOG_MAP_6(a, ...) AGV_LOG_ARG(a) AGV_LOG_MAP_5(__VA_ARGS__)
+#define AGV_LOG_MAP_7(a, ...) AGV_LOG_ARG(a) AGV_LOG_MAP_6(__VA_ARGS__)
+#define AGV_LOG_MAP_8(a, ...) AGV_LOG_ARG(a) AGV_LOG_MAP_7(__VA_ARGS__)
+
+// --- Funções ---
+
+// Inicializa o buffer e, se configurado, inicia a drenagem no core1
+void agv_log_init(void);
+
+// Enfileira um registro (usar via macros LOG_x)
+void agv_log_write(uint8_t level_module, const char *fmt, const uint32_t *args, uint8_t nargs);
+
+// Envia até max_records registros pendentes para o stdio; retorna quantos enviou
+uint32_t agv_log_drain(uint32_t max_records);
+
+// Esvazia o buffer antes de um encerramento (caminho fatal): drena aqui
+// mesmo ou, com LOG_DRAIN_ON_CORE1, espera o core1 por até
+// LOG_FLUSH_TIMEOUT_MS
+void agv_log_flush(void);
+
+// Quantidade de registros descartados por buffer cheio desde o boot
+uint32_t agv_log_dropped(void);
+
+#endif // AGV_LOG_H
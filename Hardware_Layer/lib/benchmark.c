@@ -0,0 +1,389 @@
+#include "benchmark.h"
+#include "hardware/structs/systick.h"
+#include "agv_log.h"
+
+#define SYSTICK_MAX         0x00FFFFFF
+#define SYSTICK_CSR_ENABLE  0x1     // Contador habilitado
+#define SYSTICK_CSR_CLKSRC  0x4     // Clock do processador
+
+// --- Funções Públicas (declaradas em benchmark.h) ---
+
+void benchmark_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = SYSTICK_CSR_ENABLE | SYSTICK_CSR_CLKSRC;
+}
+
+uint32_t benchmark_start(void) {
+    return systick_hw->cvr;
+}
+
+uint32_t benchmark_elapsed(uint32_t start) {
+    // Contador decrescente de 24 bits
+    return (start - systick_hw->cvr) & SYSTICK_MAX;
+}
+
+#if BENCHMARK_FIXED_POINT
+
+#include "mpu6050.h"
+#include "color_classifier.h"
+#include "fixed_point.h"
+
+#define BENCH_ITERATIONS 256
+
+// Entradas voláteis impedem que o compilador calcule tudo em tempo de compilação
+static volatile uint8_t bench_imu_raw[14] = {
+    0x01, 0x2C, 0xFE, 0x0C, 0x3F, 0x80, 0xF2, 0x10, 0x00, 0x83, 0xFF, 0x7D, 0x01, 0x06
+};
+static volatile uint16_t bench_color[4] = {812, 1340, 1105, 3400};
+static volatile int32_t bench_sink;
+
+// --- Implementações em float (referência da versão anterior) ---
+
+typedef struct {
+    float accel_x, accel_y, accel_z;
+    float gyro_x, gyro_y, gyro_z;
+    float temp_c;
+} bench_imu_float_t;
+
+static void bench_imu_float(const uint8_t *buffer, bench_imu_float_t *data) {
+    int16_t raw[7];
+    for (int i = 0; i < 7; i++) {
+        raw[i] = (int16_t)((buffer[2 * i] << 8) | buffer[2 * i + 1]);
+    }
+    data->accel_x = (raw[0] / 16384.0f) * 9.81f;
+    data->accel_y = (raw[1] / 16384.0f) * 9.81f;
+    data->accel_z = (raw[2] / 16384.0f) * 9.81f;
+    data->temp_c = (raw[3] / 340.0f) + 36.53f;
+    data->gyro_x = raw[4] / 131.0f;
+    data->gyro_y = raw[5] / 131.0f;
+    data->gyro_z = raw[6] / 131.0f;
+}
+
+static int bench_variation_float(float current, float last) {
+    float a = last < 0 ? -last : last;
+    if (a <= 0.1f) return 1;
+    float d = current - last;
+    if (d < 0) d = -d;
+    return (d / a) > 0.15f;
+}
+
+static const float bench_cores_float[][3] = {
+    {0.400f, 0.300f, 0.300f}, {0.190f, 0.420f, 0.390f}, {0.360f, 0.340f, 0.290f},
+    {0.250f, 0.380f, 0.380f}, {0.300f, 0.350f, 0.360f}, {0.340f, 0.410f, 0.250f},
+    {0.290f, 0.370f, 0.340f}, {0.250f, 0.450f, 0.300f}, {0.245f, 0.355f, 0.395f},
+    {0.210f, 0.350f, 0.440f}, {0.240f, 0.380f, 0.380f}
+};
+
+static int bench_color_float(uint16_t r, uint16_t g, uint16_t b) {
+    float total = r + g + b;
+    float rn = r / total, gn = g / total, bn = b / total;
+    float menor = 999999.0f;
+    int melhor = 0;
+    for (int i = 0; i < (int)(sizeof(bench_cores_float) / sizeof(bench_cores_float[0])); i++) {
+        float dr = rn - bench_cores_float[i][0];
+        float dg = gn - bench_cores_float[i][1];
+        float db = bn - bench_cores_float[i][2];
+        float dist = dr * dr + dg * dg + db * db;
+        if (dist < menor) {
+            menor = dist;
+            melhor = i;
+        }
+    }
+    return melhor;
+}
+
+// --- Execução ---
+
+static void bench_report(const char *nome, uint32_t ciclos_float, uint32_t ciclos_fixo) {
+    LOG_I(SYS, "[BENCH] %-10s float: %5lu ciclos | ponto fixo: %5lu ciclos\n",
+          nome, ciclos_float / BENCH_ITERATIONS, ciclos_fixo / BENCH_ITERATIONS);
+}
+
+void benchmark_fixed_point_run(void) {
+    uint8_t raw[14];
+    for (int i = 0; i < 14; i++) raw[i] = bench_imu_raw[i];
+
+    benchmark_init();
+    uint32_t start, ciclos_float, ciclos_fixo;
+
+    // Conversão do IMU (7 canais)
+    bench_imu_float_t imu_f;
+    start = benchmark_start();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        bench_imu_float(raw, &imu_f);
+        bench_sink = (int32_t)imu_f.accel_x;
+    }
+    ciclos_float = benchmark_elapsed(start);
+
+    mpu6050_data_t imu_q;
+    start = benchmark_start();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        mpu6050_convert_raw(raw, &imu_q);
+        bench_sink = imu_q.accel_x;
+    }
+    ciclos_fixo = benchmark_elapsed(start);
+    bench_report("IMU", ciclos_float, ciclos_fixo);
+
+    // Verificação de variação de 15% (6 eixos)
+    start = benchmark_start();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int changed = 0;
+        changed |= bench_variation_float(imu_f.accel_x, 1.2f);
+        changed |= bench_variation_float(imu_f.accel_y, -0.4f);
+        changed |= bench_variation_float(imu_f.accel_z, 9.7f);
+        changed |= bench_variation_float(imu_f.gyro_x, 0.9f);
+        changed |= bench_variation_float(imu_f.gyro_y, -1.1f);
+        changed |= bench_variation_float(imu_f.gyro_z, 2.0f);
+        bench_sink = changed;
+    }
+    ciclos_float = benchmark_elapsed(start);
+
+    start = benchmark_start();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int changed = 0;
+        changed |= fixed_variation_exceeds(imu_q.accel_x, Q16_CONST(1.2), 3, 20);
+        changed |= fixed_variation_exceeds(imu_q.accel_y, Q16_CONST(-0.4), 3, 20);
+        changed |= fixed_variation_exceeds(imu_q.accel_z, Q16_CONST(9.7), 3, 20);
+        changed |= fixed_variation_exceeds(imu_q.gyro_x, Q16_CONST(0.9), 3, 20);
+        changed |= fixed_variation_exceeds(imu_q.gyro_y, Q16_CONST(-1.1), 3, 20);
+        changed |= fixed_variation_exceeds(imu_q.gyro_z, Q16_CONST(2.0), 3, 20);
+        bench_sink = changed;
+    }
+    ciclos_fixo = benchmark_elapsed(start);
+    bench_report("Variacao", ciclos_float, ciclos_fixo);
+
+    // Classificação de cor (11 referências): busca linear em float x tabela de cromaticidade
+    color_classifier_load_defaults();     // Roda antes de init_color_sensor()
+    start = benchmark_start();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        bench_sink = bench_color_float(bench_color[0], bench_color[1], bench_color[2]);
+    }
+    ciclos_float = benchmark_elapsed(start);
+
+    start = benchmark_start();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        bench_sink = color_classify(bench_color[0], bench_color[1],
+                                    bench_color[2], bench_color[3]).index;
+    }
+    ciclos_fixo = benchmark_elapsed(start);
+    bench_report("Cor", ciclos_float, ciclos_fixo);
+}
+
+#endif // BENCHMARK_FIXED_POINT
+
+#if BENCHMARK_VL53L0X_RANGING
+
+#include <string.h>
+#include "pico/stdlib.h"
+
+#define BENCH_RANGING_SAMPLES   16
+#define BENCH_RANGING_WAIT_MS   80      // Maior que o timing budget do perfil inicial
+
+typedef VL53L0X_Error (*bench_start_fn_t)(VL53L0X_Dev_t *pDevice);
+typedef VL53L0X_Error (*bench_poll_fn_t)(VL53L0X_Dev_t *pDevice, VL53L0X_RangeSample_t *pSample,
+                                         uint8_t *pReady);
+
+typedef struct {
+    uint32_t cycles;
+    uint32_t time_us;
+    uint32_t transactions;
+    uint32_t samples;
+    uint32_t range_sum_mm;
+} bench_ranging_t;
+
+// Soma apenas o custo das chamadas; a espera pela medição fica de fora
+static void bench_ranging_path(VL53L0X_Dev_t *pDevice, bench_start_fn_t start_fn,
+                               bench_poll_fn_t poll_fn, bench_ranging_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    for (int n = 0; n < BENCH_RANGING_SAMPLES; n++) {
+        VL53L0X_RangeSample_t sample;
+        uint8_t ready = 0;
+
+        uint32_t tr = pDevice->bus->transactions;
+        uint32_t us = time_us_32();
+        uint32_t start = benchmark_start();
+        VL53L0X_Error status = start_fn(pDevice);
+        out->cycles += benchmark_elapsed(start);
+        out->time_us += time_us_32() - us;
+        out->transactions += pDevice->bus->transactions - tr;
+        if (status != VL53L0X_ERROR_NONE) return;
+
+        sleep_ms(BENCH_RANGING_WAIT_MS);
+
+        tr = pDevice->bus->transactions;
+        us = time_us_32();
+        start = benchmark_start();
+        status = poll_fn(pDevice, &sample, &ready);
+        out->cycles += benchmark_elapsed(start);
+        out->time_us += time_us_32() - us;
+        out->transactions += pDevice->bus->transactions - tr;
+        if (status != VL53L0X_ERROR_NONE || !ready) return;
+
+        out->samples++;
+        out->range_sum_mm += sample.RangeMilliMeter;
+    }
+}
+
+static void bench_ranging_report(const char *nome, const bench_ranging_t *r) {
+    uint32_t n = r->samples ? r->samples : 1;
+    LOG_I(SYS, "[BENCH] VL53L0X %-6s: %6lu ciclos | %5lu us | %2lu transacoes I2C por medicao "
+               "(%lu amostras, media %lu mm)\n",
+          nome, r->cycles / n, r->time_us / n, r->transactions / n,
+          r->samples, r->range_sum_mm / n);
+}
+
+void benchmark_vl53l0x_ranging_run(VL53L0X_Dev_t *pDevice) {
+    bench_ranging_t api, lean;
+
+    benchmark_init();
+    bench_ranging_path(pDevice, VL53L0X_StartSingleRanging, VL53L0X_PollRangingSample, &api);
+    bench_ranging_path(pDevice, VL53L0X_LeanStartRanging, VL53L0X_LeanPollRanging, &lean);
+
+    bench_ranging_report("API ST", &api);
+    bench_ranging_report("enxuto", &lean);
+}
+
+#endif // BENCHMARK_VL53L0X_RANGING
+
+#if BENCHMARK_TOF_BUSES
+
+#include "pico/stdlib.h"
+
+#define BENCH_BUSES_ROUNDS  64
+#define BENCH_BUSES_BLOCK   13      // Status da interrupção (0x13) + resultado (0x14..0x1F)
+
+// Transações somadas dos barramentos distintos (troca de canal do mux inclusa)
+static uint32_t bench_buses_transactions(VL53L0X_Dev_t *const devs[], uint8_t count) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        bool seen = false;
+        for (uint8_t j = 0; j < i; j++) {
+            if (devs[j]->bus == devs[i]->bus) seen = true;
+        }
+        if (!seen) total += devs[i]->bus->transactions;
+    }
+    return total;
+}
+
+static void bench_buses_report(const char *nome, uint32_t time_us, uint32_t transactions,
+                               uint32_t failures, uint8_t count) {
+    uint32_t round_us = time_us / BENCH_BUSES_ROUNDS;
+    // bytes por ms = kB/s
+    uint32_t kbytes_s = round_us ? (count * BENCH_BUSES_BLOCK * 1000u) / round_us : 0;
+    LOG_I(SYS, "[BENCH] ToF %-7s: %5lu us por rodada | %4lu rodadas/s | %3lu kB/s | "
+               "%2lu transacoes I2C por rodada (%lu falhas)\n",
+          nome, round_us, round_us ? 1000000u / round_us : 0, kbytes_s,
+          transactions / BENCH_BUSES_ROUNDS, failures);
+}
+
+void benchmark_tof_buses_run(VL53L0X_Dev_t *const devs[], uint8_t count) {
+    uint8_t buf[VL53L0X_GROUP_MAX][BENCH_BUSES_BLOCK];
+    uint8_t *bufs[VL53L0X_GROUP_MAX];
+    VL53L0X_Error status[VL53L0X_GROUP_MAX];
+    uint32_t failures = 0;
+
+    if (count > VL53L0X_GROUP_MAX) count = VL53L0X_GROUP_MAX;
+    if (count == 0) return;
+    for (uint8_t i = 0; i < count; i++) bufs[i] = buf[i];
+
+    LOG_I(SYS, "[BENCH] Barramentos ToF (montagem %s, %u sensores)\n",
+          TOF_BUS_LAYOUT == TOF_LAYOUT_PIO ? "PIO" : "mux", count);
+
+    // Um sensor por vez (caminho de VL53L0X_LeanPollRanging)
+    uint32_t tr = bench_buses_transactions(devs, count);
+    uint32_t us = time_us_32();
+    for (int r = 0; r < BENCH_BUSES_ROUNDS; r++) {
+        for (uint8_t i = 0; i < count; i++) {
+            if (VL53L0X_ReadMulti(devs[i], VL53L0X_REG_RESULT_INTERRUPT_STATUS, buf[i],
+                                  BENCH_BUSES_BLOCK) != VL53L0X_ERROR_NONE) failures++;
+        }
+    }
+    bench_buses_report("serial", time_us_32() - us, bench_buses_transactions(devs, count) - tr,
+                       failures, count);
+
+    // Todos numa rodada (caminho de VL53L0X_LeanPollRangingGroup)
+    failures = 0;
+    tr = bench_buses_transactions(devs, count);
+    us = time_us_32();
+    for (int r = 0; r < BENCH_BUSES_ROUNDS; r++) {
+        VL53L0X_ReadMultiGroup(devs, VL53L0X_REG_RESULT_INTERRUPT_STATUS, bufs,
+                               BENCH_BUSES_BLOCK, status, count);
+        for (uint8_t i = 0; i < count; i++) {
+            if (status[i] != VL53L0X_ERROR_NONE) failures++;
+        }
+    }
+    bench_buses_report("grupo", time_us_32() - us, bench_buses_transactions(devs, count) - tr,
+                       failures, count);
+}
+
+#endif // BENCHMARK_TOF_BUSES
+
+#if BENCHMARK_MFRC522_SPI
+
+#include <string.h>
+#include "pico/stdlib.h"
+
+#define BENCH_SPI_ROUNDS    32
+
+// Custo de ler n bytes do FIFO: um byte por transação (método anterior) x
+// rajada única. O padrão é escrito no FIFO antes de cada leitura (FIFO
+// round-trip no próprio chip), então os dados lidos também são conferidos.
+static void bench_spi_fifo(MFRC522Ptr_t mfrc, const char *nome, uint8_t n) {
+    uint8_t pattern[MFRC522_FIFO_BYTES];
+    uint8_t got[MFRC522_FIFO_BYTES];
+    uint32_t cycles_single = 0, cycles_burst = 0;
+    uint32_t errors_single = 0, errors_burst = 0;
+
+    for (uint8_t i = 0; i < n; i++) pattern[i] = (uint8_t)(0xA5 ^ (i * 37));
+
+    for (int r = 0; r < BENCH_SPI_ROUNDS; r++) {
+        PCD_WriteRegister(mfrc, FIFOLevelReg, 0x80);
+        PCD_WriteNRegister(mfrc, FIFODataReg, n, pattern);
+        uint32_t start = benchmark_start();
+        for (uint8_t i = 0; i < n; i++) got[i] = PCD_ReadRegister(mfrc, FIFODataReg);
+        cycles_single += benchmark_elapsed(start);
+        if (memcmp(got, pattern, n) != 0) errors_single++;
+
+        PCD_WriteRegister(mfrc, FIFOLevelReg, 0x80);
+        PCD_WriteNRegister(mfrc, FIFODataReg, n, pattern);
+        start = benchmark_start();
+        PCD_ReadNRegister(mfrc, FIFODataReg, n, got, 0);
+        cycles_burst += benchmark_elapsed(start);
+        if (memcmp(got, pattern, n) != 0) errors_burst++;
+    }
+
+    uint32_t single = cycles_single / BENCH_SPI_ROUNDS;
+    uint32_t burst = cycles_burst / BENCH_SPI_ROUNDS;
+    uint32_t speedup = burst ? (single * 100u) / burst : 0;    // x100
+    LOG_I(SYS, "[BENCH] %-12s (%2u bytes): byte a byte %6lu ciclos | rajada %5lu ciclos | "
+               "%lu.%02lux | erros %lu/%lu\n",
+          nome, n, single, burst, speedup / 100, speedup % 100, errors_single, errors_burst);
+}
+
+void benchmark_mfrc522_spi_run(MFRC522Ptr_t mfrc) {
+    benchmark_init();
+    LOG_I(SYS, "[BENCH] MFRC522 SPI (FIFO round-trip, %d rodadas)\n", BENCH_SPI_ROUNDS);
+    bench_spi_fifo(mfrc, "Anticolisao", 5);     // UID CL + BCC
+    bench_spi_fifo(mfrc, "MIFARE_Read", 18);    // 16 bytes + CRC_A
+    bench_spi_fifo(mfrc, "FIFO cheio", MFRC522_FIFO_BYTES);
+
+    // Registradores de estado lidos depois de cada comando
+    static const uint8_t regs[] = {ErrorReg, FIFOLevelReg, ControlReg};
+    uint8_t values[3];
+    uint32_t start = benchmark_start();
+    for (int r = 0; r < BENCH_SPI_ROUNDS; r++) {
+        for (uint8_t i = 0; i < 3; i++) values[i] = PCD_ReadRegister(mfrc, regs[i]);
+    }
+    uint32_t single = benchmark_elapsed(start) / BENCH_SPI_ROUNDS;
+    start = benchmark_start();
+    for (int r = 0; r < BENCH_SPI_ROUNDS; r++) PCD_ReadRegisterList(mfrc, regs, 3, values);
+    uint32_t list = benchmark_elapsed(start) / BENCH_SPI_ROUNDS;
+    LOG_I(SYS, "[BENCH] Estado (3 regs): separados %lu ciclos | lista %lu ciclos\n", single, list);
+
+    PCD_WriteRegister(mfrc, FIFOLevelReg, 0x80);
+}
+
+#endif // BENCHMARK_MFRC522_SPI
@@ -0,0 +1,55 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include "../config.h"
+
+// =====================================================
+// Medição de ciclos com o SysTick do Cortex-M0+
+//
+// O M0+ não tem DWT->CYCCNT; o SysTick (24 bits, decrescente, clock do
+// processador) é usado como contador de ciclos. Medições devem durar menos
+// de 2^24 ciclos (~134 ms a 125 MHz).
+// =====================================================
+
+// Habilita o SysTick em modo livre (sem interrupção)
+void benchmark_init(void);
+
+// Valor atual do contador (usar com benchmark_elapsed)
+uint32_t benchmark_start(void);
+
+// Ciclos decorridos desde benchmark_start()
+uint32_t benchmark_elapsed(uint32_t start);
+
+#if BENCHMARK_FIXED_POINT
+// Compara as conversões em float (implementação anterior) com as de ponto
+// fixo e imprime os ciclos médios por operação
+void benchmark_fixed_point_run(void);
+#endif
+
+#if BENCHMARK_VL53L0X_RANGING
+#include "vl53l0x_rp2040.h"
+
+// Mede ciclos e transações I2C por medição (disparo + leitura do resultado)
+// na API completa da ST e no caminho enxuto, no mesmo sensor já inicializado
+void benchmark_vl53l0x_ranging_run(VL53L0X_Dev_t *pDevice);
+#endif
+
+#if BENCHMARK_TOF_BUSES
+#include "vl53l0x_rp2040.h"
+
+// Vazão da leitura do bloco de resultado (13 bytes) de todos os sensores:
+// um por vez x em grupo (paralelo nos barramentos PIO). Rodar nas duas
+// montagens (TOF_BUS_LAYOUT) para comparar mux x barramentos separados.
+void benchmark_tof_buses_run(VL53L0X_Dev_t *const devs[], uint8_t count);
+#endif
+
+#if BENCHMARK_MFRC522_SPI
+#include "mfrc522.h"
+
+// Leitura do FIFO do MFRC522 byte a byte x em rajada (tamanhos das respostas
+// de anticolisão e MIFARE_Read) e leitura em lista dos registradores de estado
+void benchmark_mfrc522_spi_run(MFRC522Ptr_t mfrc);
+#endif
+
+#endif // BENCHMARK_H
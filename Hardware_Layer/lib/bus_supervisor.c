@@ -0,0 +1,148 @@
+#include "bus_supervisor.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include "pico/stdlib.h"
+#include "agv_log.h"
+
+static bus_device_t *devices[BUS_SUPERVISOR_MAX_DEVICES];
+static uint8_t device_count = 0;
+
+// --- Funções Internas ---
+
+static void bus_device_schedule_probe(bus_device_t *dev, uint32_t now_us) {
+    dev->next_probe_us = now_us + BUS_DEVICE_REPROBE_MS * 1000u;
+}
+
+// Verdadeiro se o barramento já apareceu em um dispositivo anterior da lista
+static bool bus_seen_before(uint8_t index, const i2c_bus_t *bus) {
+    for (uint8_t i = 0; i < index; i++) {
+        if (devices[i]->bus == bus) return true;
+    }
+    return false;
+}
+
+// Bus-clear e reinício dos multiplexadores ligados ao barramento
+static void bus_recover(i2c_bus_t *bus) {
+    bool released = i2c_bus_recover(bus);
+    LOG_W(SYS, "[I2C] %s: barramento preso, bus-clear %s (%lu erros, %lu timeouts)\n",
+          bus->name, released ? "OK" : "FALHOU", bus->errors, bus->timeouts);
+
+    tca9548a_t *last_mux = NULL;
+    for (uint8_t i = 0; i < device_count; i++) {
+        tca9548a_t *mux = devices[i]->mux;
+        if (devices[i]->bus != bus || mux == NULL || mux == last_mux) continue;
+        tca9548a_reset(mux);
+        last_mux = mux;
+    }
+}
+
+static void bus_device_try_restore(bus_device_t *dev, uint32_t now_us) {
+    bus_device_schedule_probe(dev, now_us);
+    if (!dev->probe(dev->ctx)) return;
+
+    LOG_I(SYS, "[I2C] %s: respondeu, reinicializando...\n", dev->name);
+    if (!dev->reinit(dev->ctx)) {
+        LOG_W(SYS, "[I2C] %s: falha na reinicializacao\n", dev->name);
+        return;
+    }
+
+    dev->online = true;
+    dev->consecutive_errors = 0;
+    dev->reinits++;
+    LOG_I(SYS, "[I2C] %s: online de novo\n", dev->name);
+}
+
+// snprintf que nunca passa do fim do buffer
+static int health_append(char *buf, size_t size, int len, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static int health_append(char *buf, size_t size, int len, const char *fmt, ...) {
+    if ((size_t)len >= size) return len;
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, size - len, fmt, args);
+    va_end(args);
+    if (n < 0) return len;
+    return ((size_t)(len + n) < size) ? len + n : (int)size - 1;
+}
+
+// --- Funções Públicas (declaradas em bus_supervisor.h) ---
+
+bool bus_supervisor_register(bus_device_t *dev, bool online) {
+    if (device_count >= BUS_SUPERVISOR_MAX_DEVICES) return false;
+
+    dev->online = online;
+    dev->consecutive_errors = 0;
+    dev->errors = 0;
+    dev->reinits = 0;
+    bus_device_schedule_probe(dev, time_us_32());
+    devices[device_count++] = dev;
+    return true;
+}
+
+bool bus_device_report(bus_device_t *dev, bool ok) {
+    if (ok) {
+        dev->consecutive_errors = 0;
+        return dev->online;
+    }
+
+    dev->errors++;
+    if (dev->consecutive_errors < UINT8_MAX) dev->consecutive_errors++;
+
+    if (dev->online && dev->consecutive_errors >= BUS_DEVICE_OFFLINE_ERRORS) {
+        dev->online = false;
+        bus_device_schedule_probe(dev, time_us_32());
+        LOG_W(SYS, "[I2C] %s: %u falhas seguidas, dispositivo offline\n",
+              dev->name, dev->consecutive_errors);
+    }
+    return dev->online;
+}
+
+void bus_supervisor_poll(uint32_t now_us) {
+    // Barramentos com falhas seguidas: libera as linhas antes de tentar religar
+    for (uint8_t i = 0; i < device_count; i++) {
+        i2c_bus_t *bus = devices[i]->bus;
+        if (bus_seen_before(i, bus)) continue;
+        if (bus->consecutive_errors >= I2C_BUS_RECOVER_ERRORS) {
+            bus_recover(bus);
+        }
+    }
+
+    for (uint8_t i = 0; i < device_count; i++) {
+        bus_device_t *dev = devices[i];
+        if (dev->online || (int32_t)(now_us - dev->next_probe_us) < 0) continue;
+        bus_device_try_restore(dev, now_us);
+        // No máximo uma reinicialização por iteração (limita o bloqueio do loop)
+        break;
+    }
+}
+
+int bus_supervisor_format_health(char *buf, size_t size) {
+    int len = 0;
+    if (size == 0) return 0;
+    buf[0] = '\0';
+
+    len = health_append(buf, size, len, "\"buses\":{");
+    bool first = true;
+    for (uint8_t i = 0; i < device_count; i++) {
+        const i2c_bus_t *bus = devices[i]->bus;
+        if (bus_seen_before(i, bus)) continue;
+        len = health_append(buf, size, len,
+                            "%s\"%s\":{\"transactions\":%lu,\"errors\":%lu,\"timeouts\":%lu,\"recoveries\":%lu}",
+                            first ? "" : ",", bus->name, (unsigned long)bus->transactions,
+                            (unsigned long)bus->errors, (unsigned long)bus->timeouts,
+                            (unsigned long)bus->recoveries);
+        first = false;
+    }
+
+    len = health_append(buf, size, len, "},\"devices\":{");
+    for (uint8_t i = 0; i < device_count; i++) {
+        const bus_device_t *dev = devices[i];
+        len = health_append(buf, size, len,
+                            "%s\"%s\":{\"online\":%s,\"errors\":%lu,\"reinits\":%lu}",
+                            i ? "," : "", dev->name, dev->online ? "true" : "false",
+                            (unsigned long)dev->errors, (unsigned long)dev->reinits);
+    }
+    return health_append(buf, size, len, "}");
+}
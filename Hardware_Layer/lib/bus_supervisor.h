@@ -0,0 +1,61 @@
+#ifndef BUS_SUPERVISOR_H
+#define BUS_SUPERVISOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../config.h"
+#include "i2c_bus.h"
+#include "tca9548a.h"
+
+// =====================================================
+// Supervisor dos barramentos I2C
+//
+// Cada dispositivo registrado informa o resultado das suas operações
+// (bus_device_report). Após BUS_DEVICE_OFFLINE_ERRORS falhas seguidas o
+// dispositivo fica offline; bus_supervisor_poll() tenta, a cada
+// BUS_DEVICE_REPROBE_MS, detectá-lo de novo (probe) e reinicializá-lo
+// (reinit). Um barramento com I2C_BUS_RECOVER_ERRORS falhas seguidas passa
+// por bus-clear e os multiplexadores ligados a ele são reiniciados.
+//
+// O supervisor não decide o que fazer com um sensor offline: o chamador
+// consulta bus_device_online() (o reflexo de segurança continua tratando
+// sensor sem amostra como parada).
+// =====================================================
+
+typedef struct bus_device {
+    // Configuração (preenchida pelo chamador)
+    const char *name;           // Chave no status (ex.: "left", "imu")
+    i2c_bus_t *bus;
+    tca9548a_t *mux;            // NULL = ligado direto no barramento
+    bool (*probe)(void *ctx);   // true se o dispositivo responde
+    bool (*reinit)(void *ctx);  // Reconfigura após voltar; true se ficou pronto
+    void *ctx;
+
+    // Estado (mantido pelo supervisor)
+    bool online;
+    uint8_t consecutive_errors;
+    uint32_t errors;            // Operações com falha desde o boot
+    uint32_t reinits;           // Reinicializações bem-sucedidas
+    uint32_t next_probe_us;
+} bus_device_t;
+
+// Registra o dispositivo; online = resultado da inicialização no boot
+bool bus_supervisor_register(bus_device_t *dev, bool online);
+
+// Informa o resultado de uma operação; retorna se o dispositivo segue online
+bool bus_device_report(bus_device_t *dev, bool ok);
+
+static inline bool bus_device_online(const bus_device_t *dev) {
+    return dev->online;
+}
+
+// Recupera barramentos presos e tenta religar dispositivos offline
+// (chamar a cada iteração do loop; reinit pode bloquear algumas dezenas de ms)
+void bus_supervisor_poll(uint32_t now_us);
+
+// Escreve "buses":{...},"devices":{...} (sem chaves externas) para o status;
+// retorna o número de caracteres escritos
+int bus_supervisor_format_health(char *buf, size_t size);
+
+#endif // BUS_SUPERVISOR_H
@@ -0,0 +1,314 @@
+#include "color_calib.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "agv_log.h"
+#include "color_classifier.h"
+#include "fixed_point.h"
+#include "json_util.h"
+
+#define CALIB_MAGIC         0x4C414343u     // "CCAL"
+#define CALIB_VERSION       2               // 2: COLOR_CLASS_MAX 15 (muda o tamanho do registro)
+#define Q12_TO_MILLI(x)     ((long)(x) * 1000 / 4096)
+
+// Registro gravado no último setor da flash
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    color_class_t classes[COLOR_CLASS_MAX];
+    uint32_t crc;               // CRC-32 de tudo antes deste campo
+} color_calib_record_t;
+
+// A gravação é feita em páginas inteiras
+#define RECORD_BYTES ((sizeof(color_calib_record_t) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE)
+_Static_assert(RECORD_BYTES <= FLASH_SECTOR_SIZE, "Registro de calibração maior que um setor");
+
+typedef struct {
+    bool active;
+    char color[COLOR_NAME_MAX];
+    uint32_t start_us;
+    uint16_t count;
+    uint16_t rejected;          // Pouca luz
+    int32_t sum_r, sum_g;
+    int64_t sum_rr, sum_gg, sum_rg;
+} color_calib_sampling_t;
+
+static color_calib_sampling_t sampling;
+static color_class_t working[COLOR_CLASS_MAX];      // Conjunto em uso (cópia editável)
+static uint8_t working_count = 0;
+static const char *source = "default";   // "flash", "default" ou "runtime" (não gravado)
+
+// Trabalho adiado para color_calib_poll (fora do callback do MQTT)
+static bool reload_pending = false;
+static bool save_pending = false;
+static bool erase_pending = false;
+static uint32_t flash_refused = 0;      // save/reset recusados com o veículo fora de STOP
+
+static char report[COLOR_CALIB_REPORT_MAX];
+static bool report_pending = false;
+
+static uint8_t flash_page_buf[RECORD_BYTES] __attribute__((aligned(4)));
+
+// --- Funções Internas ---
+
+static uint32_t crc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void color_calib_report(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void color_calib_report(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(report, sizeof(report), fmt, args);
+    va_end(args);
+    report_pending = true;
+}
+
+// Registro válido na flash? (ponteiro direto pelo XIP)
+static const color_calib_record_t *color_calib_flash_record(void) {
+    const color_calib_record_t *rec =
+        (const color_calib_record_t *)(XIP_BASE + COLOR_CALIB_FLASH_OFFSET);
+    if (rec->magic != CALIB_MAGIC || rec->version != CALIB_VERSION ||
+        rec->count == 0 || rec->count > COLOR_CLASS_MAX) {
+        return NULL;
+    }
+    if (rec->crc != crc32((const uint8_t *)rec, offsetof(color_calib_record_t, crc))) {
+        return NULL;
+    }
+    for (uint16_t i = 0; i < rec->count; i++) {
+        if (memchr(rec->classes[i].name, '\0', COLOR_NAME_MAX) == NULL) return NULL;
+    }
+    return rec;
+}
+
+// Executado com o core1 parado e interrupções desligadas (flash_safe_execute)
+static void color_calib_flash_write(void *param) {
+    flash_range_erase(COLOR_CALIB_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    if (param != NULL) {
+        flash_range_program(COLOR_CALIB_FLASH_OFFSET, (const uint8_t *)param, RECORD_BYTES);
+    }
+}
+
+static int color_calib_flash_save(void) {
+    color_calib_record_t *rec = (color_calib_record_t *)flash_page_buf;
+    memset(flash_page_buf, 0xFF, sizeof(flash_page_buf));
+    memset(rec, 0, sizeof(*rec));
+    rec->magic = CALIB_MAGIC;
+    rec->version = CALIB_VERSION;
+    rec->count = working_count;
+    memcpy(rec->classes, working, working_count * sizeof(color_class_t));
+    rec->crc = crc32((const uint8_t *)rec, offsetof(color_calib_record_t, crc));
+    return flash_safe_execute(color_calib_flash_write, flash_page_buf, COLOR_CALIB_FLASH_TIMEOUT_MS);
+}
+
+// Fecha a coleta: centróide e covariância amostral da cromaticidade
+static void color_calib_finish(void) {
+    color_calib_sampling_t *s = &sampling;
+    s->active = false;
+    char color_json[COLOR_NAME_MAX * 6];    // Nome vindo do backend, escapado para o relatório
+    json_escape(s->color, color_json, sizeof(color_json));
+
+    if (s->count < COLOR_CALIB_SAMPLES / 2) {
+        color_calib_report("{\"cmd\":\"sample\",\"color\":\"%s\",\"ok\":false,\"error\":\"few_samples\","
+                           "\"samples\":%u,\"rejected\":%u}", color_json, s->count, s->rejected);
+        LOG_W(COLOR, "[COR] Calibracao falhou: %u leituras validas\n", s->count);
+        return;
+    }
+
+    int32_t n = s->count;
+    color_class_t c;
+    memset(&c, 0, sizeof(c));
+    memcpy(c.name, s->color, COLOR_NAME_MAX);
+    c.r = (int16_t)(s->sum_r / n);
+    c.g = (int16_t)(s->sum_g / n);
+    c.sxx = (int32_t)((s->sum_rr - (int64_t)s->sum_r * s->sum_r / n) / (n - 1));
+    c.syy = (int32_t)((s->sum_gg - (int64_t)s->sum_g * s->sum_g / n) / (n - 1));
+    c.sxy = (int32_t)((s->sum_rg - (int64_t)s->sum_r * s->sum_g / n) / (n - 1));
+
+    // Substitui a cor de mesmo nome ou acrescenta
+    uint8_t i = 0;
+    while (i < working_count && strcmp(working[i].name, c.name) != 0) i++;
+    if (i == COLOR_CLASS_MAX) {
+        color_calib_report("{\"cmd\":\"sample\",\"color\":\"%s\",\"ok\":false,\"error\":\"full\"}", color_json);
+        return;
+    }
+    if (i == working_count) working_count++;
+    working[i] = c;
+    reload_pending = true;
+
+    color_calib_report("{\"cmd\":\"sample\",\"color\":\"%s\",\"ok\":true,\"samples\":%u,\"rejected\":%u,"
+                       "\"r\":%ld,\"g\":%ld,\"sigma_r\":%ld,\"sigma_g\":%ld,\"classes\":%u}",
+                       color_json, s->count, s->rejected, Q12_TO_MILLI(c.r), Q12_TO_MILLI(c.g),
+                       Q12_TO_MILLI(isqrt32((uint32_t)(c.sxx > 0 ? c.sxx : 0))),
+                       Q12_TO_MILLI(isqrt32((uint32_t)(c.syy > 0 ? c.syy : 0))), working_count);
+    LOG_I(COLOR, "[COR] Cor %u calibrada: r=%ld g=%ld (x1000), %u leituras\n",
+          i, Q12_TO_MILLI(c.r), Q12_TO_MILLI(c.g), s->count);
+}
+
+// --- Funções Públicas (declaradas em color_calib.h) ---
+
+void color_calib_init(void) {
+    const color_calib_record_t *rec = color_calib_flash_record();
+    if (rec != NULL) {
+        working_count = (uint8_t)rec->count;
+        memcpy(working, rec->classes, working_count * sizeof(color_class_t));
+        source = "flash";
+    } else {
+        working_count = color_classifier_defaults(working);
+        source = "default";
+    }
+
+    uint32_t us = color_classifier_load(working, working_count);
+    LOG_I(COLOR, "[COR] %u cores (%s), tabela montada em %lu us\n",
+          working_count, color_calib_source(), us);
+}
+
+bool color_calib_command(const char *json) {
+    char cmd[12];
+    if (!json_get_string(json, "cmd", cmd, sizeof(cmd))) {
+        LOG_W(COLOR, "[COR] Comando de calibracao invalido\n");
+        return false;
+    }
+
+    if (strcmp(cmd, "abort") == 0) {
+        sampling.active = false;
+        color_calib_report("{\"cmd\":\"abort\",\"ok\":true}");
+        return true;
+    }
+    if (sampling.active) {
+        char cmd_json[sizeof(cmd) * 6];
+        json_escape(cmd, cmd_json, sizeof(cmd_json));
+        color_calib_report("{\"cmd\":\"%s\",\"ok\":false,\"error\":\"busy\"}", cmd_json);
+        return false;
+    }
+
+    if (strcmp(cmd, "sample") == 0) {
+        char color[COLOR_NAME_MAX];
+        if (!json_get_string(json, "color", color, sizeof(color)) || color[0] == '\0') {
+            color_calib_report("{\"cmd\":\"sample\",\"ok\":false,\"error\":\"color\"}");
+            return false;
+        }
+        memset(&sampling, 0, sizeof(sampling));
+        memcpy(sampling.color, color, sizeof(color));
+        sampling.start_us = time_us_32();
+        sampling.active = true;
+        LOG_I(COLOR, "[COR] Calibrando: %u leituras\n", COLOR_CALIB_SAMPLES);
+        return true;
+    }
+    if (strcmp(cmd, "save") == 0) {
+        save_pending = true;
+        return true;
+    }
+    if (strcmp(cmd, "reset") == 0) {
+        erase_pending = true;       // Cores de fábrica só junto com o apagamento
+        return true;
+    }
+
+    color_calib_report("{\"cmd\":\"unknown\",\"ok\":false}");
+    return false;
+}
+
+bool color_calib_sampling(void) {
+    return sampling.active;
+}
+
+void color_calib_add_sample(uint16_t r, uint16_t g, uint16_t b, uint16_t c, uint32_t now_us) {
+    int16_t rn, gn;
+    if (!sampling.active) return;
+    if (c < COLOR_MIN_CLEAR || !color_chroma(r, g, b, &rn, &gn)) {
+        sampling.rejected++;
+        return;
+    }
+    sampling.count++;
+    sampling.sum_r += rn;
+    sampling.sum_g += gn;
+    sampling.sum_rr += (int32_t)rn * rn;
+    sampling.sum_gg += (int32_t)gn * gn;
+    sampling.sum_rg += (int32_t)rn * gn;
+}
+
+bool color_calib_poll(uint32_t now_us, bool parked) {
+    bool reloaded = false;
+
+    if (sampling.active && (sampling.count >= COLOR_CALIB_SAMPLES ||
+                            now_us - sampling.start_us > COLOR_CALIB_TIMEOUT_MS * 1000u)) {
+        color_calib_finish();
+    }
+
+    // Apagar o setor deixa as interrupções desligadas e o core1 parado por
+    // dezenas de ms: o timer do reflexo de segurança congela junto. Só parado.
+    if ((save_pending || erase_pending) && !parked) {
+        color_calib_report("{\"cmd\":\"%s\",\"ok\":false,\"error\":\"not_stopped\"}",
+                           erase_pending ? "reset" : "save");
+        save_pending = false;
+        erase_pending = false;
+        flash_refused++;
+        LOG_W(COLOR, "[COR] Gravacao na flash recusada: veiculo fora de STOP\n");
+    }
+    if (erase_pending) {
+        working_count = color_classifier_defaults(working);
+        reload_pending = true;
+    }
+
+    // Remonta a tabela com o conjunto editado (dezenas de ms)
+    if (reload_pending) {
+        reload_pending = false;
+        uint32_t us = color_classifier_load(working, working_count);
+        source = "runtime";
+        reloaded = true;
+        LOG_I(COLOR, "[COR] Classificador recarregado: %u cores, %lu us\n", working_count, us);
+    }
+
+    if (erase_pending) {
+        erase_pending = false;
+        save_pending = false;
+        int rc = flash_safe_execute(color_calib_flash_write, NULL, COLOR_CALIB_FLASH_TIMEOUT_MS);
+        // Sem apagar, o registro antigo volta no próximo boot: continua "runtime"
+        if (rc == PICO_OK) source = "default";
+        color_calib_report("{\"cmd\":\"reset\",\"ok\":%s,\"classes\":%u}",
+                           rc == PICO_OK ? "true" : "false", working_count);
+        LOG_I(COLOR, "[COR] Cores de fabrica restauradas (flash: %d)\n", rc);
+    }
+
+    if (save_pending) {
+        save_pending = false;
+        int rc = color_calib_flash_save();
+        if (rc == PICO_OK) source = "flash";
+        color_calib_report("{\"cmd\":\"save\",\"ok\":%s,\"classes\":%u}",
+                           rc == PICO_OK ? "true" : "false", working_count);
+        if (rc == PICO_OK) {
+            LOG_I(COLOR, "[COR] Calibracao gravada na flash (%u cores)\n", working_count);
+        } else {
+            LOG_E(COLOR, "[COR] ERRO ao gravar calibracao na flash: %d\n", rc);
+        }
+    }
+
+    return reloaded;
+}
+
+bool color_calib_take_report(char *buf, size_t size) {
+    if (!report_pending) return false;
+    snprintf(buf, size, "%s", report);
+    report_pending = false;
+    return true;
+}
+
+uint32_t color_calib_flash_refused(void) {
+    return flash_refused;
+}
+
+const char *color_calib_source(void) {
+    return source;
+}
@@ -0,0 +1,60 @@
+#ifndef COLOR_CALIB_H
+#define COLOR_CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+
+#define COLOR_CALIB_REPORT_MAX  320     // Maior relatório (nome da cor escapado)
+
+// =====================================================
+// Calibração das cores em campo, gravada na flash
+//
+// Com o AGV parado sobre um marcador, o comando de calibração (MQTT
+// MQTT_TOPIC_COLOR_CALIB) coleta COLOR_CALIB_SAMPLES leituras, calcula o
+// centróide e a covariância da cromaticidade e substitui (ou acrescenta) a
+// cor no classificador na hora. "save" grava o conjunto no último setor da
+// flash (COLOR_CALIB_FLASH_OFFSET), lido de volta no boot; sem registro
+// válido, valem as cores de fábrica.
+//
+// Comandos (JSON):
+//   {"cmd":"sample","color":"Verde"}   coleta e atualiza a cor
+//   {"cmd":"save"}                     grava na flash
+//   {"cmd":"reset"}                    volta às cores de fábrica e apaga a flash
+//   {"cmd":"abort"}                    cancela uma coleta
+// Cada comando gera um relatório JSON (color_calib_take_report). "save" e
+// "reset" apagam um setor com as interrupções desligadas, o que congela o
+// reflexo de segurança: só são executados com o reflexo em STOP; fora dele,
+// o relatório traz "error":"not_stopped".
+// =====================================================
+
+// Carrega a calibração da flash (ou as cores de fábrica) no classificador
+void color_calib_init(void);
+
+// Trata um comando recebido por MQTT (JSON terminado em '\0'); o trabalho
+// pesado (gravação, remontagem da tabela) fica para color_calib_poll
+bool color_calib_command(const char *json);
+
+// Verdadeiro durante uma coleta
+bool color_calib_sampling(void);
+
+// Leitura bruta do sensor durante a coleta
+void color_calib_add_sample(uint16_t r, uint16_t g, uint16_t b, uint16_t c, uint32_t now_us);
+
+// Conclui coletas e executa gravação/remontagem pendentes (chamar no loop).
+// parked: reflexo de segurança em STOP; sem isso save/reset são recusados.
+// true quando o classificador foi recarregado (índices das cores mudaram)
+bool color_calib_poll(uint32_t now_us, bool parked);
+
+// Copia o próximo relatório pendente; false se não houver
+bool color_calib_take_report(char *buf, size_t size);
+
+// Comandos save/reset recusados desde o boot (veículo fora de STOP)
+uint32_t color_calib_flash_refused(void);
+
+// Origem das cores carregadas: "flash", "default" ou "runtime" (alterada e
+// ainda não gravada)
+const char *color_calib_source(void);
+
+#endif // COLOR_CALIB_H
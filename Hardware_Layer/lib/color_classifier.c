@@ -0,0 +1,242 @@
+#include "color_classifier.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "fixed_point.h"
+
+// Componentes normalizados em Q12 (4096 = 1.0): r/(r+g+b) * 4096
+#define COR_Q12_SHIFT 12
+#define COR_Q12(x) ((int16_t)((x) * (1 << COR_Q12_SHIFT) + 0.5))
+#define MILLI_Q12(x) ((int32_t)(x) * (1 << COR_Q12_SHIFT) / 1000)
+
+#define LUT_SIZE        (1u << COLOR_LUT_BITS)
+#define LUT_NONE        ((uint8_t)(COLOR_CLASS_MAX << 4))   // Célula longe de todas as cores
+
+// Recíprocos de 512..1023 em Q24 (2^24 / 512 = 32768 cabe em 16 bits)
+#define RECIP_BITS      10
+#define RECIP_SHIFT     24
+
+// Distância de Mahalanobis: coordenadas em desvios-padrão Q8, quadrado em Q16
+#define Z_SHIFT         8
+#define Z_MAX           (32 << Z_SHIFT)             // Satura em 32 desvios
+#define W_SHIFT         20                          // w = 2^20 / desvio (Q12)
+#define DELTA_MAX       8191
+#define MAX_DIST2       ((uint32_t)COLOR_MATCH_MAX_SIGMA * COLOR_MATCH_MAX_SIGMA << (2 * Z_SHIFT))
+
+// Desvio mínimo: ruído do sensor e limite para os produtos caberem em 32 bits
+#define SIGMA_MIN_Q12   MILLI_Q12(COLOR_SIGMA_MIN_MILLI)
+#define SIGMA_DEF_Q12   MILLI_Q12(COLOR_DEFAULT_SIGMA_MILLI)
+
+#if COLOR_LUT_BITS < 5 || COLOR_LUT_BITS > 8
+#error "COLOR_LUT_BITS deve estar entre 5 e 8"
+#endif
+#if COLOR_SIGMA_MIN_MILLI * 4096 / 1000 < 8
+#error "COLOR_SIGMA_MIN_MILLI abaixo de 2 (produtos estourariam 32 bits)"
+#endif
+
+// Cores de bancada. Os nomes são os nós do mapa (mapModel.js), em UTF-8 com
+// octal como em rfid_tag_table.h: "Lil\303\241s" = "Lilás".
+typedef struct {
+    const char *nome;
+    int16_t r_norm;
+    int16_t g_norm;
+} CorReferencia;
+
+static const CorReferencia cores_referencia[] = {
+    {"Vermelho",            COR_Q12(0.400), COR_Q12(0.300)},
+    {"Ciano",               COR_Q12(0.190), COR_Q12(0.420)},
+    {"Laranja",             COR_Q12(0.360), COR_Q12(0.340)},
+    {"Azul-acinzentado",    COR_Q12(0.250), COR_Q12(0.380)},
+    {"Lil\303\241s",          COR_Q12(0.300), COR_Q12(0.350)},
+    {"Amarelo",             COR_Q12(0.340), COR_Q12(0.410)},
+    {"Branco",              COR_Q12(0.290), COR_Q12(0.370)},
+    {"Verde",               COR_Q12(0.250), COR_Q12(0.450)},
+    {"Roxo",                COR_Q12(0.245), COR_Q12(0.355)},
+    {"Azul",                COR_Q12(0.210), COR_Q12(0.350)},
+    {"Azul-escuro",         COR_Q12(0.240), COR_Q12(0.380)}
+};
+
+#define NUM_CORES_PADRAO (sizeof(cores_referencia) / sizeof(cores_referencia[0]))
+
+_Static_assert(NUM_CORES_PADRAO <= COLOR_CLASS_MAX, "Cores demais para o índice de 4 bits da tabela");
+
+// Distância de uma cor já branqueada (Cholesky da covariância):
+// z1 = dr / l11, z2 = (dg - k * dr) / l22
+typedef struct {
+    int32_t r, g;       // Centróide (Q12)
+    int32_t w1;         // 2^20 / l11
+    int32_t k;          // sxy / sxx em Q12
+    int32_t w2;         // 2^20 / l22
+} color_model_t;
+
+static color_class_t classes[COLOR_CLASS_MAX];
+static color_model_t models[COLOR_CLASS_MAX];
+static uint8_t num_classes = 0;
+
+// Célula: índice da cor nos 4 bits altos, confiança nos 4 baixos
+static uint8_t lut[LUT_SIZE * LUT_SIZE];
+static uint16_t recip[1u << (RECIP_BITS - 1)];
+
+// --- Funções Internas ---
+
+static int32_t clamp32(int32_t v, int32_t lim) {
+    return v > lim ? lim : (v < -lim ? -lim : v);
+}
+
+// Covariância + ruído mínimo na diagonal -> fatores de Cholesky invertidos
+static void color_model_prepare(const color_class_t *c, color_model_t *m) {
+    int64_t sxx = (int64_t)c->sxx + SIGMA_MIN_Q12 * SIGMA_MIN_Q12;
+    int64_t syy = (int64_t)c->syy + SIGMA_MIN_Q12 * SIGMA_MIN_Q12;
+    int64_t sxy = c->sxy;
+
+    // Covariância fora do possível (|sxy| > sqrt(sxx * syy)) vira correlação máxima
+    int64_t schur = syy - sxy * sxy / sxx;
+    if (schur < (int64_t)SIGMA_MIN_Q12 * SIGMA_MIN_Q12) schur = (int64_t)SIGMA_MIN_Q12 * SIGMA_MIN_Q12;
+
+    uint32_t l11 = isqrt32((uint32_t)(sxx > INT32_MAX ? INT32_MAX : sxx));
+    uint32_t l22 = isqrt32((uint32_t)(schur > INT32_MAX ? INT32_MAX : schur));
+    m->r = c->r;
+    m->g = c->g;
+    m->w1 = (int32_t)((1u << W_SHIFT) / l11);
+    m->w2 = (int32_t)((1u << W_SHIFT) / l22);
+    m->k = clamp32((int32_t)((sxy << COR_Q12_SHIFT) / sxx), 1 << 17);
+}
+
+// Distância de Mahalanobis ao quadrado, em desvios² Q16
+static uint32_t color_model_dist2(const color_model_t *m, int32_t rn, int32_t gn) {
+    int32_t dr = clamp32(rn - m->r, DELTA_MAX);
+    int32_t dg = gn - m->g;
+    int32_t e2 = clamp32(dg - ((m->k * dr) >> COR_Q12_SHIFT), DELTA_MAX);
+    int32_t z1 = clamp32((dr * m->w1) >> (W_SHIFT - Z_SHIFT), Z_MAX);
+    int32_t z2 = clamp32((e2 * m->w2) >> (W_SHIFT - Z_SHIFT), Z_MAX);
+    return (uint32_t)(z1 * z1) + (uint32_t)(z2 * z2);
+}
+
+// Cor mais próxima do ponto (Q12) e confiança: margem para a segunda mais
+// próxima, reduzida conforme a distância se aproxima de COLOR_MATCH_MAX_SIGMA.
+// A COLOR_MATCH_MAX_SIGMA desvios ou mais de todas, a célula fica sem cor.
+static uint8_t classificar_celula(int32_t rn, int32_t gn) {
+    uint32_t d1 = UINT32_MAX, d2 = UINT32_MAX;
+    uint8_t melhor = 0;
+
+    for (uint8_t i = 0; i < num_classes; i++) {
+        uint32_t dist = color_model_dist2(&models[i], rn, gn);
+        if (dist < d1) {
+            d2 = d1;
+            d1 = dist;
+            melhor = i;
+        } else if (dist < d2) {
+            d2 = dist;
+        }
+    }
+
+    if (d1 >= MAX_DIST2) return LUT_NONE;
+
+    uint32_t conf = (d2 == UINT32_MAX || d2 == 0) ? COLOR_CONFIDENCE_MAX
+                                                  : COLOR_CONFIDENCE_MAX * (d2 - d1) / d2;
+    conf = conf * (MAX_DIST2 - d1) / MAX_DIST2;
+    return (uint8_t)(melhor << 4 | conf);
+}
+
+// Remonta a tabela a partir das cores carregadas
+static void color_classifier_build(void) {
+    for (uint32_t t = 0; t < count_of(recip); t++) {
+        uint32_t den = t + (1u << (RECIP_BITS - 1));
+        recip[t] = (uint16_t)(((1u << RECIP_SHIFT) + den / 2) / den);
+    }
+
+    for (uint8_t i = 0; i < num_classes; i++) {
+        color_model_prepare(&classes[i], &models[i]);
+    }
+
+    // Centro de cada célula em Q12
+    for (uint32_t ri = 0; ri < LUT_SIZE; ri++) {
+        int32_t rn = (int32_t)((2 * ri + 1) << COR_Q12_SHIFT) / (int32_t)(2 * LUT_SIZE);
+        for (uint32_t gi = 0; gi < LUT_SIZE; gi++) {
+            int32_t gn = (int32_t)((2 * gi + 1) << COR_Q12_SHIFT) / (int32_t)(2 * LUT_SIZE);
+            lut[ri * LUT_SIZE + gi] = classificar_celula(rn, gn);
+        }
+    }
+}
+
+// --- Funções Públicas (declaradas em color_classifier.h) ---
+
+uint32_t color_classifier_load(const color_class_t *src, uint8_t count) {
+    uint32_t start = time_us_32();
+    if (count > COLOR_CLASS_MAX) count = COLOR_CLASS_MAX;
+    if (src != classes) memcpy(classes, src, count * sizeof(color_class_t));
+    num_classes = count;
+    color_classifier_build();
+    return time_us_32() - start;
+}
+
+uint8_t color_classifier_defaults(color_class_t *out) {
+    // Dispersão isotrópica em (r, g, b): equivale à distância euclidiana da
+    // versão anterior (b = 1 - r - g)
+    int32_t var = SIGMA_DEF_Q12 * SIGMA_DEF_Q12;
+    for (uint8_t i = 0; i < NUM_CORES_PADRAO; i++) {
+        memset(&out[i], 0, sizeof(out[i]));
+        strncpy(out[i].name, cores_referencia[i].nome, COLOR_NAME_MAX - 1);
+        out[i].r = cores_referencia[i].r_norm;
+        out[i].g = cores_referencia[i].g_norm;
+        out[i].sxx = var * 2 / 3;
+        out[i].sxy = -var / 3;
+        out[i].syy = var * 2 / 3;
+    }
+    return NUM_CORES_PADRAO;
+}
+
+uint32_t color_classifier_load_defaults(void) {
+    uint8_t n = color_classifier_defaults(classes);
+    return color_classifier_load(classes, n);
+}
+
+bool color_chroma(uint16_t r, uint16_t g, uint16_t b, int16_t *rn, int16_t *gn) {
+    uint32_t total = (uint32_t)r + g + b;
+    if (total == 0) return false;
+    *rn = (int16_t)(((uint32_t)r << COR_Q12_SHIFT) / total);
+    *gn = (int16_t)(((uint32_t)g << COR_Q12_SHIFT) / total);
+    return true;
+}
+
+color_match_t color_classify(uint16_t r, uint16_t g, uint16_t b, uint16_t c) {
+    color_match_t none = { COLOR_CLASS_NONE, 0 };
+    if (c < COLOR_MIN_CLEAR || num_classes == 0) return none;
+
+    uint32_t total = (uint32_t)r + g + b;
+    if (total == 0) return none;
+
+    // Normaliza o total para 10 bits (512..1023) e multiplica pelo recíproco
+    int shift = (31 - __builtin_clz(total)) - (RECIP_BITS - 1);
+    uint32_t rs, gs, t;
+    if (shift >= 0) {
+        t = total >> shift;
+        rs = (uint32_t)r >> shift;
+        gs = (uint32_t)g >> shift;
+    } else {
+        t = total << -shift;
+        rs = (uint32_t)r << -shift;
+        gs = (uint32_t)g << -shift;
+    }
+    uint32_t inv = recip[t - (1u << (RECIP_BITS - 1))];
+    uint32_t ri = (rs * inv) >> (RECIP_SHIFT - COLOR_LUT_BITS);
+    uint32_t gi = (gs * inv) >> (RECIP_SHIFT - COLOR_LUT_BITS);
+    if (ri >= LUT_SIZE) ri = LUT_SIZE - 1;
+    if (gi >= LUT_SIZE) gi = LUT_SIZE - 1;
+
+    uint8_t cell = lut[ri * LUT_SIZE + gi];
+    if (cell == LUT_NONE) return none;
+    color_match_t m = { (uint8_t)(cell >> 4), (uint8_t)(cell & 0x0F) };
+    return m;
+}
+
+const char *color_class_name(uint8_t index) {
+    return index < num_classes ? classes[index].name : "---";
+}
+
+uint8_t color_class_count(void) {
+    return num_classes;
+}
+
+const color_class_t *color_class_get(uint8_t index) {
+    return index < num_classes ? &classes[index] : NULL;
+}
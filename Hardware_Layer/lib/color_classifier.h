@@ -0,0 +1,65 @@
+#ifndef COLOR_CLASSIFIER_H
+#define COLOR_CLASSIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+// =====================================================
+// Classificação de cor por tabela de cromaticidade
+//
+// A cromaticidade (r/total, g/total) é quantizada em COLOR_LUT_BITS bits por
+// eixo e indexa uma tabela em RAM com a cor mais próxima e a confiança de cada
+// célula. A tabela é montada por color_classifier_load() a partir das cores de
+// referência (no boot e a cada calibração); depois disso cada classificação é
+// uma normalização por recíproco tabelado, sem divisão, e uma leitura da
+// tabela: O(1), independente do número de cores.
+//
+// Cada cor é um centróide com covariância: a distância é de Mahalanobis, em
+// desvios-padrão da própria cor, então uma cor calibrada com pouca dispersão
+// ocupa uma região estreita e uma cor espalhada, uma região larga.
+// =====================================================
+
+#define COLOR_CLASS_NONE        0xFF    // Pouca luz ou célula sem cor próxima
+#define COLOR_CONFIDENCE_MAX    15
+#define COLOR_CLASS_MAX         15      // Índice de 4 bits na tabela (15 = célula sem cor)
+#define COLOR_NAME_MAX          24      // Nome com '\0' (UTF-8, igual ao mapModel.js)
+
+// Cor de referência: cromaticidade (r, g) em Q12 (4096 = 1.0)
+typedef struct {
+    char name[COLOR_NAME_MAX];
+    int16_t r;              // Centróide
+    int16_t g;
+    int32_t sxx;            // Covariância em Q12² (variância de r, covariância, variância de g)
+    int32_t sxy;
+    int32_t syy;
+} color_class_t;
+
+typedef struct {
+    uint8_t index;          // Cor de referência (COLOR_CLASS_NONE = nenhuma)
+    uint8_t confidence;     // 0..COLOR_CONFIDENCE_MAX
+} color_match_t;
+
+// Carrega as cores de referência (copiadas) e remonta a tabela; retorna a
+// duração em us (dezenas de ms: chamar fora de caminhos críticos)
+uint32_t color_classifier_load(const color_class_t *classes, uint8_t count);
+
+// Cores de referência de fábrica (bancada); retorna quantas
+uint8_t color_classifier_defaults(color_class_t *classes);
+
+// Carrega as cores de fábrica
+uint32_t color_classifier_load_defaults(void);
+
+// Cromaticidade de uma leitura em Q12 (com divisão: uso fora da classificação)
+bool color_chroma(uint16_t r, uint16_t g, uint16_t b, int16_t *rn, int16_t *gn);
+
+// Classifica uma leitura bruta do TCS34725
+color_match_t color_classify(uint16_t r, uint16_t g, uint16_t b, uint16_t c);
+
+// Nome da cor ("---" para COLOR_CLASS_NONE), número de cores de referência e
+// cor carregada (NULL fora da faixa)
+const char *color_class_name(uint8_t index);
+uint8_t color_class_count(void);
+const color_class_t *color_class_get(uint8_t index);
+
+#endif // COLOR_CLASSIFIER_H
@@ -0,0 +1,124 @@
+#include "color_events.h"
+#include <string.h>
+
+#define MAX_CLASSES 16      // Índice de 4 bits da tabela de cromaticidade
+
+#if (COLOR_EVENT_QUEUE_SIZE & (COLOR_EVENT_QUEUE_SIZE - 1)) != 0
+#error "COLOR_EVENT_QUEUE_SIZE deve ser potência de 2"
+#endif
+#if COLOR_STAY_VOTES < 1 || COLOR_STAY_VOTES > COLOR_ENTER_VOTES || COLOR_ENTER_VOTES > COLOR_VOTE_WINDOW
+#error "Esperado 1 <= COLOR_STAY_VOTES <= COLOR_ENTER_VOTES <= COLOR_VOTE_WINDOW"
+#endif
+
+// --- Funções Internas ---
+
+static void color_events_push(color_events_t *ev, color_event_type_t type, uint8_t color,
+                              uint32_t timestamp_ms, uint32_t dwell_ms, uint8_t confidence) {
+    color_event_t *e = &ev->queue[ev->queue_head & (COLOR_EVENT_QUEUE_SIZE - 1)];
+    e->type = type;
+    e->color = color;
+    e->timestamp_ms = timestamp_ms;
+    e->dwell_ms = dwell_ms;
+    e->confidence = confidence;
+
+    ev->events++;
+    ev->queue_head++;
+    if ((uint8_t)(ev->queue_head - ev->queue_tail) > COLOR_EVENT_QUEUE_SIZE) {
+        ev->queue_tail++;  // Descarta o evento mais antigo
+        ev->dropped++;
+    }
+}
+
+// Posição da i-ésima amostra da janela, da mais antiga (0) para a mais nova
+static uint8_t color_events_slot(const color_events_t *ev, uint8_t i) {
+    return (uint8_t)((ev->head + COLOR_VOTE_WINDOW - ev->count + i) % COLOR_VOTE_WINDOW);
+}
+
+// Instante da primeira (first = true) ou da última amostra da cor na janela;
+// false se a cor não está mais na janela
+static bool color_events_edge_ms(const color_events_t *ev, uint8_t color, bool first,
+                                 uint32_t *edge_ms) {
+    bool found = false;
+    for (uint8_t i = 0; i < ev->count; i++) {
+        uint8_t s = color_events_slot(ev, i);
+        if (ev->window[s] != color) continue;
+        *edge_ms = ev->time_ms[s];
+        found = true;
+        if (first) break;
+    }
+    return found;
+}
+
+static void color_events_exit(color_events_t *ev, uint32_t now_ms) {
+    uint32_t exit_ms;
+    if (!color_events_edge_ms(ev, ev->current, false, &exit_ms)) {
+        exit_ms = now_ms;   // A cor já saiu da janela
+    }
+    color_events_push(ev, COLOR_EVENT_EXIT, ev->current, exit_ms, exit_ms - ev->enter_ms, 0);
+    ev->current = COLOR_CLASS_NONE;
+}
+
+// --- Funções Públicas (declaradas em color_events.h) ---
+
+void color_events_init(color_events_t *ev) {
+    memset(ev, 0, sizeof(*ev));
+    ev->current = COLOR_CLASS_NONE;
+}
+
+void color_events_update(color_events_t *ev, color_match_t match, uint32_t now_ms) {
+    bool vote = match.index < MAX_CLASSES && match.confidence >= COLOR_MIN_CONFIDENCE;
+
+    ev->window[ev->head] = vote ? match.index : COLOR_CLASS_NONE;
+    ev->confidence[ev->head] = match.confidence;
+    ev->time_ms[ev->head] = now_ms;
+    ev->head = (uint8_t)((ev->head + 1) % COLOR_VOTE_WINDOW);
+    if (ev->count < COLOR_VOTE_WINDOW) ev->count++;
+
+    // Votos e confiança somada por cor
+    uint8_t votes[MAX_CLASSES] = {0};
+    uint16_t conf_sum[MAX_CLASSES] = {0};
+    for (uint8_t i = 0; i < ev->count; i++) {
+        uint8_t s = color_events_slot(ev, i);
+        if (ev->window[s] == COLOR_CLASS_NONE) continue;
+        votes[ev->window[s]]++;
+        conf_sum[ev->window[s]] += ev->confidence[s];
+    }
+    uint8_t winner = COLOR_CLASS_NONE;
+    for (uint8_t c = 0; c < MAX_CLASSES; c++) {
+        if (votes[c] && (winner == COLOR_CLASS_NONE || votes[c] > votes[winner])) winner = c;
+    }
+
+    // Saída: o marcador perdeu os votos ou outra cor venceu com folga
+    if (ev->current != COLOR_CLASS_NONE) {
+        uint8_t held = votes[ev->current];
+        // Sem vencedor (janela sem votos) não há substituição: winner não indexa votes
+        bool replaced = winner != COLOR_CLASS_NONE && winner != ev->current &&
+                        votes[winner] >= COLOR_ENTER_VOTES && votes[winner] > held;
+        if (held < COLOR_STAY_VOTES || replaced) color_events_exit(ev, now_ms);
+    }
+
+    // Entrada: maioria da janela com votos suficientes
+    if (ev->current == COLOR_CLASS_NONE && winner != COLOR_CLASS_NONE &&
+        votes[winner] >= COLOR_ENTER_VOTES) {
+        ev->current = winner;
+        color_events_edge_ms(ev, winner, true, &ev->enter_ms);     // Tem votos: está na janela
+        color_events_push(ev, COLOR_EVENT_ENTER, winner, ev->enter_ms, 0,
+                          (uint8_t)(conf_sum[winner] / votes[winner]));
+    }
+}
+
+bool color_events_peek(const color_events_t *ev, color_event_t *event) {
+    if (ev->queue_tail == ev->queue_head) return false;
+    *event = ev->queue[ev->queue_tail & (COLOR_EVENT_QUEUE_SIZE - 1)];
+    return true;
+}
+
+bool color_events_pop(color_events_t *ev, color_event_t *event) {
+    if (!color_events_peek(ev, event)) return false;
+    ev->queue_tail++;
+    return true;
+}
+
+const char *color_event_type_name(color_event_type_t type) {
+    return type == COLOR_EVENT_ENTER ? "enter" : "exit";
+}
@@ -0,0 +1,70 @@
+#ifndef COLOR_EVENTS_H
+#define COLOR_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+#include "color_classifier.h"
+
+// =====================================================
+// Detecção de entrada/saída de marcadores coloridos
+//
+// As leituras classificadas entram numa janela de COLOR_VOTE_WINDOW
+// amostras; leituras com confiança abaixo de COLOR_MIN_CONFIDENCE contam
+// como piso. A cor mais votada entra como marcador com COLOR_ENTER_VOTES
+// votos e só sai quando cai abaixo de COLOR_STAY_VOTES (histerese): um
+// reflexo isolado não gera evento e uma leitura ruim no meio do marcador não
+// o encerra. Os instantes de entrada e saída são os da primeira e da última
+// amostra da cor na janela, não o do voto que decidiu, então o tempo no
+// marcador (dwell) não carrega o atraso da votação.
+// =====================================================
+
+typedef enum {
+    COLOR_EVENT_ENTER = 0,
+    COLOR_EVENT_EXIT
+} color_event_type_t;
+
+typedef struct {
+    uint32_t timestamp_ms;  // Borda do marcador (primeira/última amostra da cor)
+    uint32_t dwell_ms;      // Saída: tempo sobre o marcador
+    uint8_t type;           // color_event_type_t
+    uint8_t color;          // Índice da cor (color_class_name)
+    uint8_t confidence;     // Entrada: confiança média dos votos da cor
+} color_event_t;
+
+typedef struct {
+    uint8_t window[COLOR_VOTE_WINDOW];      // Cor votada (COLOR_CLASS_NONE = piso)
+    uint8_t confidence[COLOR_VOTE_WINDOW];
+    uint32_t time_ms[COLOR_VOTE_WINDOW];
+    uint8_t head;           // Próxima posição a escrever
+    uint8_t count;          // Amostras na janela
+    uint8_t current;        // Marcador atual (COLOR_CLASS_NONE = fora)
+    uint32_t enter_ms;
+    // Fila de eventos (sobrescreve os mais antigos quando cheia)
+    color_event_t queue[COLOR_EVENT_QUEUE_SIZE];
+    uint8_t queue_head;
+    uint8_t queue_tail;
+    uint32_t events;        // Eventos gerados desde o boot
+    uint32_t dropped;       // Descartados com a fila cheia
+} color_events_t;
+
+void color_events_init(color_events_t *ev);
+
+// Adiciona uma leitura classificada; gera eventos na fila quando o marcador muda.
+// now_ms: to_ms_since_boot (não dá a volta como time_us_32 / 1000)
+void color_events_update(color_events_t *ev, color_match_t match, uint32_t now_ms);
+
+// Copia o próximo evento pendente sem retirá-lo; false se a fila estiver vazia
+bool color_events_peek(const color_events_t *ev, color_event_t *event);
+
+// Retira o próximo evento pendente (depois de publicado); false se a fila estiver vazia
+bool color_events_pop(color_events_t *ev, color_event_t *event);
+
+// Marcador atual (COLOR_CLASS_NONE = fora de marcador)
+static inline uint8_t color_events_current(const color_events_t *ev) {
+    return ev->current;
+}
+
+const char *color_event_type_name(color_event_type_t type);
+
+#endif // COLOR_EVENTS_H
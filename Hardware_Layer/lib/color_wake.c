@@ -0,0 +1,93 @@
+#include "color_wake.h"
+#include <string.h>
+
+#if COLOR_WAKE_PERSISTENCE > 15
+#error "COLOR_WAKE_PERSISTENCE é o código do registrador PERS (0..15)"
+#endif
+
+// --- Funções Internas ---
+
+// Meia largura da faixa do piso, com mínimo para pouca luz
+static int32_t color_wake_band(int32_t floor) {
+    int32_t band = floor * COLOR_WAKE_BAND_PCT / 100;
+    return band < COLOR_WAKE_BAND_MIN ? COLOR_WAKE_BAND_MIN : band;
+}
+
+static int32_t color_wake_abs(int32_t x) {
+    return x < 0 ? -x : x;
+}
+
+// --- Funções Públicas (declaradas em color_wake.h) ---
+
+void color_wake_init(color_wake_t *w, bool enabled) {
+    memset(w, 0, sizeof(*w));
+    w->enabled = enabled;
+    w->state = COLOR_WAKE_TRACKING;
+}
+
+color_wake_action_t color_wake_sample(color_wake_t *w, uint16_t c, bool hold) {
+    int32_t band = color_wake_band(w->floor);
+    bool inside = color_wake_abs((int32_t)c - w->floor) <= band;
+
+    if (w->state == COLOR_WAKE_ARMED) {
+        // Heartbeat fora da faixa: a borda passou sem INT
+        if (!inside || hold) {
+            w->state = COLOR_WAKE_ACTIVE;
+            w->quiet = 0;
+            w->missed++;
+            return COLOR_WAKE_KEEP;
+        }
+        // Deriva lenta do piso (luz ambiente): re-centra os limiares
+        w->floor += ((int32_t)c - w->floor) >> COLOR_WAKE_FLOOR_SHIFT;
+        return color_wake_abs(w->floor - w->armed_floor) > band / 2 ? COLOR_WAKE_ARM
+                                                                     : COLOR_WAKE_KEEP;
+    }
+
+    if (!inside) {
+        // Outro nível (marcador ou borda): recomeça a contagem nele
+        w->floor = c;
+        w->quiet = 0;
+        return COLOR_WAKE_KEEP;
+    }
+    w->floor += ((int32_t)c - w->floor) >> COLOR_WAKE_FLOOR_SHIFT;
+    if (hold) {
+        w->quiet = 0;
+        return COLOR_WAKE_KEEP;
+    }
+    if (w->quiet < COLOR_WAKE_QUIET_SAMPLES) w->quiet++;
+    return (w->enabled && w->quiet >= COLOR_WAKE_QUIET_SAMPLES) ? COLOR_WAKE_ARM : COLOR_WAKE_KEEP;
+}
+
+void color_wake_thresholds(const color_wake_t *w, uint16_t *low, uint16_t *high) {
+    int32_t band = color_wake_band(w->floor);
+    int32_t lo = w->floor - band;
+    int32_t hi = w->floor + band;
+    *low = (uint16_t)(lo < 0 ? 0 : lo);
+    *high = (uint16_t)(hi > 65535 ? 65535 : hi);
+}
+
+void color_wake_armed(color_wake_t *w) {
+    w->state = COLOR_WAKE_ARMED;
+    w->armed_floor = w->floor;
+    w->quiet = 0;
+}
+
+void color_wake_interrupt(color_wake_t *w) {
+    if (w->state != COLOR_WAKE_ARMED) return;
+    w->state = COLOR_WAKE_ACTIVE;
+    w->quiet = 0;
+    w->wakeups++;
+}
+
+void color_wake_restart(color_wake_t *w) {
+    w->state = COLOR_WAKE_TRACKING;
+    w->quiet = 0;
+}
+
+const char *color_wake_state_name(const color_wake_t *w) {
+    switch (w->state) {
+        case COLOR_WAKE_ARMED:  return "armed";
+        case COLOR_WAKE_ACTIVE: return "active";
+        default:                return "tracking";
+    }
+}
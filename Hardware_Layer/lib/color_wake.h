@@ -0,0 +1,72 @@
+#ifndef COLOR_WAKE_H
+#define COLOR_WAKE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+// =====================================================
+// Despertar da leitura de cor por limiar do canal clear
+//
+// No piso liso não há o que classificar: depois de COLOR_WAKE_QUIET_SAMPLES
+// leituras dentro da faixa do piso (±COLOR_WAKE_BAND_PCT do canal clear) e
+// fora de marcador, os limiares AILT/AIHT do TCS34725 são armados em volta do
+// piso e a leitura contínua para. O sensor avisa pelo pino INT quando a
+// refletância sai da faixa (borda de marcador); a interrupção acorda o loop
+// e a leitura volta a uma por ciclo do sensor até o marcador acabar e o piso
+// se firmar de novo.
+//
+// Com o sensor armado, uma leitura a cada COLOR_WAKE_HEARTBEAT_MS acompanha
+// a deriva do piso (re-centra os limiares) e cobre uma borda perdida. Uma
+// troca de exposição invalida o nível do piso: volta a aprender.
+// O módulo não faz I2C: decide, e main.c aplica no sensor.
+// =====================================================
+
+typedef enum {
+    COLOR_WAKE_TRACKING = 0,    // Leitura contínua, aprendendo o piso
+    COLOR_WAKE_ARMED,           // Piso: limiares armados, leitura só por INT ou heartbeat
+    COLOR_WAKE_ACTIVE           // Acordado pela borda: leitura contínua
+} color_wake_state_t;
+
+typedef enum {
+    COLOR_WAKE_KEEP = 0,
+    COLOR_WAKE_ARM              // Armar os limiares de color_wake_thresholds()
+} color_wake_action_t;
+
+typedef struct {
+    uint8_t state;              // color_wake_state_t
+    bool enabled;               // Pino INT ligado e conferido
+    int32_t floor;              // Canal clear do piso (média móvel)
+    int32_t armed_floor;        // Piso dos limiares armados
+    uint16_t quiet;             // Leituras seguidas no piso
+    uint32_t wakeups;           // Bordas que acordaram a leitura (INT)
+    uint32_t missed;            // Saídas da faixa vistas só no heartbeat
+} color_wake_t;
+
+// enabled = false: leitura sempre contínua (sem pino INT)
+void color_wake_init(color_wake_t *w, bool enabled);
+
+// Leitura contínua (a cada ciclo do sensor) ou só por INT/heartbeat
+static inline bool color_wake_full_rate(const color_wake_t *w) {
+    return w->state != COLOR_WAKE_ARMED;
+}
+
+// Cada leitura do canal clear; hold = sobre marcador (ou coletando
+// calibração): não armar
+color_wake_action_t color_wake_sample(color_wake_t *w, uint16_t c, bool hold);
+
+// Limiares em volta do piso atual
+void color_wake_thresholds(const color_wake_t *w, uint16_t *low, uint16_t *high);
+
+// Limiares gravados no sensor
+void color_wake_armed(color_wake_t *w);
+
+// Borda no pino INT
+void color_wake_interrupt(color_wake_t *w);
+
+// Exposição mudou ou sensor reinicializado: volta a aprender o piso
+void color_wake_restart(color_wake_t *w);
+
+const char *color_wake_state_name(const color_wake_t *w);
+
+#endif // COLOR_WAKE_H
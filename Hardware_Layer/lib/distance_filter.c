@@ -0,0 +1,131 @@
+#include "distance_filter.h"
+#include <string.h>
+
+// RangeStatus do VL53L0X (ver VL53L0X_GetRangeStatusString)
+#define RANGE_STATUS_VALID          0
+#define RANGE_STATUS_SIGMA_FAIL     1
+#define RANGE_STATUS_SIGNAL_FAIL    2
+#define RANGE_STATUS_MIN_RANGE_FAIL 3
+#define RANGE_STATUS_PHASE_FAIL     4
+
+// Limites de sinal convertidos de centésimos de MCPS para Q16.16
+#define MIN_SIGNAL_Q16  ((uint32_t)DIST_FILTER_MIN_SIGNAL_CMCPS * 65536 / 100)
+#define FULL_SIGNAL_Q16 ((uint32_t)DIST_FILTER_FULL_SIGNAL_CMCPS * 65536 / 100)
+
+#define Q4_SHIFT 4
+
+// --- Funções Internas ---
+
+static dist_sample_class_t distance_filter_classify(const VL53L0X_RangeSample_t *sample) {
+    switch (sample->RangeStatus) {
+        case RANGE_STATUS_VALID:
+            break;
+        case RANGE_STATUS_SIGNAL_FAIL:
+        case RANGE_STATUS_PHASE_FAIL:
+            return DIST_SAMPLE_NO_TARGET;
+        case RANGE_STATUS_MIN_RANGE_FAIL:
+            return DIST_SAMPLE_TOO_CLOSE;
+        case RANGE_STATUS_SIGMA_FAIL:
+        default:
+            return DIST_SAMPLE_REJECTED;
+    }
+
+    if (sample->RangeMilliMeter >= DIST_FILTER_NO_TARGET_MM) return DIST_SAMPLE_NO_TARGET;
+    if (sample->SignalRateMegaCps < MIN_SIGNAL_Q16) return DIST_SAMPLE_REJECTED;
+
+    // Luz ambiente muito acima do retorno: medição dominada por ruído
+    if (sample->AmbientRateMegaCps / DIST_FILTER_MAX_AMBIENT_RATIO > sample->SignalRateMegaCps) {
+        return DIST_SAMPLE_REJECTED;
+    }
+
+    return DIST_SAMPLE_VALID;
+}
+
+// Peso da amostra (Q8) proporcional à taxa de sinal, entre ALPHA_MIN e ALPHA_MAX
+static int32_t distance_filter_alpha(FixPoint1616_t signal_rate) {
+    uint32_t weight = signal_rate >= FULL_SIGNAL_Q16 ? 256 : (signal_rate * 256) / FULL_SIGNAL_Q16;
+    return DIST_FILTER_ALPHA_MIN_Q8 +
+           (int32_t)(((DIST_FILTER_ALPHA_MAX_Q8 - DIST_FILTER_ALPHA_MIN_Q8) * weight) >> 8);
+}
+
+static void distance_filter_set(dist_filter_t *filter, uint16_t mm) {
+    filter->estimate_q4 = (int32_t)mm << Q4_SHIFT;
+    filter->last_sample_mm = mm;
+    filter->initialized = true;
+}
+
+// --- Funções Públicas (declaradas em distance_filter.h) ---
+
+void distance_filter_init(dist_filter_t *filter) {
+    memset(filter, 0, sizeof(*filter));
+}
+
+dist_sample_class_t distance_filter_update(dist_filter_t *filter,
+                                           const VL53L0X_RangeSample_t *sample,
+                                           uint16_t offset_mm) {
+    dist_sample_class_t cls = distance_filter_classify(sample);
+
+    switch (cls) {
+        case DIST_SAMPLE_VALID: {
+            filter->stats.valid++;
+            filter->no_target_run = 0;
+
+            uint16_t mm = sample->RangeMilliMeter > offset_mm ? sample->RangeMilliMeter - offset_mm : 0;
+            int32_t diff_q4 = ((int32_t)mm << Q4_SHIFT) - filter->estimate_q4;
+            int32_t jump_q4 = (int32_t)DIST_FILTER_JUMP_MM << Q4_SHIFT;
+
+            if (!filter->initialized) {
+                distance_filter_set(filter, mm);
+            } else if (diff_q4 > jump_q4 || diff_q4 < -jump_q4) {
+                // Salto grande: só adota após duas amostras consistentes
+                int32_t delta = (int32_t)mm - filter->last_sample_mm;
+                if (delta < 0) delta = -delta;
+                if (delta <= DIST_FILTER_JUMP_MM / 2) {
+                    distance_filter_set(filter, mm);
+                }
+                filter->last_sample_mm = mm;
+            } else {
+                filter->estimate_q4 += (diff_q4 * distance_filter_alpha(sample->SignalRateMegaCps)) >> 8;
+                filter->last_sample_mm = mm;
+            }
+            break;
+        }
+
+        case DIST_SAMPLE_NO_TARGET:
+            filter->stats.no_target++;
+            filter->last_sample_mm = DIST_FILTER_NO_TARGET_MM;
+            if (filter->no_target_run < DIST_FILTER_NO_TARGET_CONFIRM) filter->no_target_run++;
+            if (filter->no_target_run >= DIST_FILTER_NO_TARGET_CONFIRM) {
+                distance_filter_set(filter, DIST_FILTER_NO_TARGET_MM);
+            }
+            break;
+
+        case DIST_SAMPLE_TOO_CLOSE:
+            // Obstáculo colado no sensor: vale imediatamente
+            filter->stats.too_close++;
+            filter->no_target_run = 0;
+            distance_filter_set(filter, 0);
+            break;
+
+        case DIST_SAMPLE_REJECTED:
+        default:
+            filter->stats.rejected++;
+            break;
+    }
+
+    return cls;
+}
+
+uint16_t distance_filter_value(const dist_filter_t *filter) {
+    int32_t mm = (filter->estimate_q4 + (1 << (Q4_SHIFT - 1))) >> Q4_SHIFT;
+    return mm < 0 ? 0 : (uint16_t)mm;
+}
+
+uint16_t distance_filter_last_sample(const dist_filter_t *filter) {
+    return filter->last_sample_mm;
+}
+
+void distance_filter_take_stats(dist_filter_t *filter, dist_filter_stats_t *stats) {
+    *stats = filter->stats;
+    memset(&filter->stats, 0, sizeof(filter->stats));
+}
@@ -0,0 +1,59 @@
+#ifndef DISTANCE_FILTER_H
+#define DISTANCE_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+#include "vl53l0x_rp2040.h"
+
+// =====================================================
+// Filtro de distância ponderado pela qualidade da medição
+//
+// Cada amostra do VL53L0X é classificada pelo RangeStatus, taxa de sinal
+// e luz ambiente. Amostras boas entram num filtro exponencial cujo peso
+// cresce com a taxa de sinal (sinal forte = menos ruído), então a leitura
+// fica estável sem precisar de uma janela de média grande. Amostras ruins
+// são descartadas e contabilizadas para as taxas de validade.
+// =====================================================
+
+typedef enum {
+    DIST_SAMPLE_VALID = 0,      // Aceita e incorporada ao filtro
+    DIST_SAMPLE_NO_TARGET,      // Nada no alcance (sinal/fase insuficientes)
+    DIST_SAMPLE_TOO_CLOSE,      // Alvo abaixo do alcance mínimo
+    DIST_SAMPLE_REJECTED        // Medição não confiável (sigma, ambiente, hardware)
+} dist_sample_class_t;
+
+// Contadores de qualidade desde a última coleta
+typedef struct {
+    uint16_t valid;
+    uint16_t no_target;
+    uint16_t too_close;
+    uint16_t rejected;
+} dist_filter_stats_t;
+
+typedef struct {
+    int32_t estimate_q4;        // Estimativa em mm * 16
+    bool initialized;
+    uint8_t no_target_run;      // Amostras "sem alvo" consecutivas
+    uint16_t last_sample_mm;    // Última amostra aceita (já com offset)
+    dist_filter_stats_t stats;
+} dist_filter_t;
+
+// Zera o estado do filtro
+void distance_filter_init(dist_filter_t *filter);
+
+// Classifica e incorpora uma amostra; offset_mm é descontado da distância
+dist_sample_class_t distance_filter_update(dist_filter_t *filter,
+                                           const VL53L0X_RangeSample_t *sample,
+                                           uint16_t offset_mm);
+
+// Estimativa filtrada atual (mm)
+uint16_t distance_filter_value(const dist_filter_t *filter);
+
+// Última amostra aceita (mm), sem filtragem
+uint16_t distance_filter_last_sample(const dist_filter_t *filter);
+
+// Copia os contadores e reinicia a janela
+void distance_filter_take_stats(dist_filter_t *filter, dist_filter_stats_t *stats);
+
+#endif // DISTANCE_FILTER_H
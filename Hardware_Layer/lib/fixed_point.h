@@ -0,0 +1,76 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Aritmética de ponto fixo para o RP2040 (Cortex-M0+ sem FPU)
+//
+// q16_t: Q16.16 com sinal (16 bits inteiros, 16 fracionários).
+// Resolução de 1/65536 e faixa de ±32767, suficiente para m/s², °/s e °C.
+// Todas as operações usam apenas inteiros; o compilador não gera chamadas
+// para a biblioteca de float por software.
+// =====================================================
+
+typedef int32_t q16_t;
+
+#define Q16_SHIFT           16
+#define Q16_ONE             ((q16_t)1 << Q16_SHIFT)
+
+// Constante em Q16.16 (avaliada em tempo de compilação; usar só com literais)
+#define Q16_CONST(x)        ((q16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q16_FROM_INT(x)     ((q16_t)(x) << Q16_SHIFT)
+
+// Multiplicação Q16 x Q16 com intermediário de 64 bits
+static inline q16_t q16_mul(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a * b) >> Q16_SHIFT);
+}
+
+static inline q16_t q16_abs(q16_t a) {
+    return a < 0 ? -a : a;
+}
+
+// Converte para centésimos arredondados (ex.: 9.81 -> 981)
+static inline int32_t q16_to_centi(q16_t a) {
+    // Deslocamento aritmético em vez de divisão de 64 bits (lenta no M0+)
+    return (int32_t)(((int64_t)a * 100 + (Q16_ONE / 2)) >> Q16_SHIFT);
+}
+
+// Verdadeiro se |value - last| > |last| * num / den (ex.: 3/20 = 15%)
+// Os operandos devem caber em 2^31 / max(num, den) para não estourar.
+static inline bool fixed_variation_exceeds(int32_t value, int32_t last,
+                                           int32_t num, int32_t den) {
+    int32_t diff = value - last;
+    if (diff < 0) diff = -diff;
+    if (last < 0) last = -last;
+    return diff * den > last * num;
+}
+
+// Raiz quadrada inteira (arredondada para baixo), bit a bit
+static inline uint32_t isqrt32(uint32_t x) {
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2) {
+        if (x >= r + bit) {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+// --- Saída em texto sem printf de float ---
+// Uso: printf("x=" FIXED_CENTI_FMT, FIXED_CENTI_ARGS(q16_to_centi(v)))
+
+#define FIXED_CENTI_FMT     "%s%lu.%02lu"
+#define FIXED_CENTI_ARGS(c) ((c) < 0 ? "-" : ""),                              \
+                            (unsigned long)(((c) < 0 ? -(c) : (c)) / 100),       \
+                            (unsigned long)(((c) < 0 ? -(c) : (c)) % 100)
+
+// Valores inteiros com uma casa decimal (ex.: milímetros -> centímetros)
+#define FIXED_DECI_FMT      "%lu.%lu"
+#define FIXED_DECI_ARGS(d)  (unsigned long)((d) / 10), (unsigned long)((d) % 10)
+
+#endif // FIXED_POINT_H
@@ -1,4 +1,5 @@
 #include "gy33.h"
+#include "agv_log.h"
 
 // --- Definições do Sensor GY-33 ---
 #define GY33_I2C_ADDR 0x29          // Endereço I2C padrão do sensor
@@ -6,103 +7,234 @@
 // --- Registos do Sensor GY-33 ---
 #define ENABLE_REG 0x80             // Habilita o sensor e controla modos de operação
 #define ATIME_REG 0x81              // Configura o tempo de integração do ADC
+#define WTIME_REG 0x83              // Tempo de espera entre leituras
+#define CONFIG_REG 0x8D             // WLONG: espera 12x mais longa
 #define CONTROL_REG 0x8F            // Controla o ganho do sensor
-#define CDATA_REG 0x94              // Registrador de dados de luz clara (Clear)
-#define RDATA_REG 0x96              // Registrador de dados do canal vermelho (Red)
-#define GDATA_REG 0x98              // Registrador de dados do canal verde (Green)
-#define BDATA_REG 0x9A              // Registrador de dados do canal azul (Blue)
+#define ID_REG 0x92                 // Identificação (0x44 = TCS34721/5, 0x4D = TCS34723/7)
+#define PERS_REG 0x8C               // Filtro de persistência da interrupção
+#define AILT_BURST_REG 0xA4         // AILTL com auto-incremento: AILTL, AILTH, AIHTL, AIHTH
+#define INT_CLEAR_CMD 0xE6          // Função especial: limpa a interrupção do canal clear
+// Comando com TYPE = auto-incremento (0xA0): lê CDATAL..BDATAH (0x14..0x1B)
+// numa só transferência. Com TYPE = 00 (0x94) o sensor repete o mesmo byte.
+#define RGBC_BURST_REG 0xB4
+#define RGBC_BURST_LEN 8            // C, R, G, B: 16 bits little-endian cada
+
+#define ENABLE_PON 0x01             // Oscilador ligado
+#define ENABLE_AEN 0x02             // ADC RGBC ligado
+#define ENABLE_WEN 0x08             // Espera entre leituras habilitada
+#define ENABLE_AIEN 0x10            // Interrupção do canal clear habilitada
+#define CONFIG_WLONG 0x02
+
+#define GY33_CYCLE_US 2400          // Um ciclo de ADC/espera (2,4 ms)
+#define GY33_WAIT_MAX_CYCLES 256
+#define GY33_WLONG_FACTOR 12
+
+#if GY33_INTEGRATION_CYCLES < 1 || GY33_INTEGRATION_CYCLES > 256 || GY33_AE_MIN_CYCLES < 1 || GY33_AE_MIN_CYCLES > GY33_INTEGRATION_CYCLES
+#error "GY33_INTEGRATION_CYCLES/GY33_AE_MIN_CYCLES fora de 1..256"
+#endif
+// Cada passo muda a exposição em até 4x: com faixa menor a regulagem oscila
+#if GY33_AE_HIGH_PCT < 4 * GY33_AE_LOW_PCT
+#error "GY33_AE_HIGH_PCT deve ser pelo menos 4x GY33_AE_LOW_PCT"
+#endif
+
+static const uint8_t gain_x[GY33_GAIN_COUNT] = { 1, 4, 16, 60 };
+
+static gy33_config_t config = {
+    .integration_cycles = GY33_INTEGRATION_CYCLES,
+    .gain = GY33_GAIN_DEFAULT,
+    .wait_ms = GY33_WAIT_MS,
+};
 
 // --- Funções Internas (privadas à biblioteca) ---
 
 // Escreve um valor em um registrador específico
-static void gy33_write_register(i2c_inst_t *i2c, uint8_t reg, uint8_t value) {
-    uint8_t buffer[2] = {reg, value};
-    // Timeout de 100ms
-    i2c_write_timeout_us(i2c, GY33_I2C_ADDR, buffer, 2, false, 100000);
+static bool gy33_write_register(i2c_bus_t *bus, uint8_t reg, uint8_t value) {
+    return i2c_bus_write_reg(bus, GY33_I2C_ADDR, reg, &value, 1);
 }
 
-// Lê um valor de 16 bits de um registrador específico
-static uint16_t gy33_read_register(i2c_inst_t *i2c, uint8_t reg) {
-    uint8_t buffer[2] = {0};
-    // Timeout de 100ms para escrita e leitura
-    int ret = i2c_write_timeout_us(i2c, GY33_I2C_ADDR, &reg, 1, true, 100000);
-    if (ret < 0) return 0; // Retorna 0 se falhar
+// Bits do ENABLE para a configuração em uso
+static uint8_t gy33_enable_bits(uint16_t wait_ms) {
+    return ENABLE_PON | ENABLE_AEN | (wait_ms ? ENABLE_WEN : 0) |
+           (config.int_enabled ? ENABLE_AIEN : 0);
+}
 
-    ret = i2c_read_timeout_us(i2c, GY33_I2C_ADDR, buffer, 2, false, 100000);
-    if (ret < 0) return 0; // Retorna 0 se falhar
+static uint16_t gy33_le16(const uint8_t *p) {
+    return (uint16_t)(p[1] << 8 | p[0]);
+}
 
-    return (buffer[1] << 8) | buffer[0];
+// Contagem máxima do canal clear: 1024 por ciclo, saturando em 65535
+static uint32_t gy33_full_scale(uint16_t cycles) {
+    uint32_t full = (uint32_t)cycles * 1024;
+    return full > 65535 ? 65535 : full;
 }
 
-// --- Funções Públicas (declaradas em gy33.h) ---
+// Ciclos de espera (WTIME) e WLONG para o tempo pedido, arredondando para cima
+static void gy33_wait_cycles(uint16_t wait_ms, uint16_t *cycles, bool *wlong) {
+    uint32_t us = (uint32_t)wait_ms * 1000;
+    uint32_t n = (us + GY33_CYCLE_US - 1) / GY33_CYCLE_US;
+    *wlong = n > GY33_WAIT_MAX_CYCLES;
+    if (*wlong) n = (n + GY33_WLONG_FACTOR - 1) / GY33_WLONG_FACTOR;
+    if (n > GY33_WAIT_MAX_CYCLES) n = GY33_WAIT_MAX_CYCLES;
+    *cycles = (uint16_t)n;
+}
 
-// Inicializa o sensor com configurações padrão
-void gy33_init(i2c_inst_t *i2c) {
-    gy33_write_register(i2c, ENABLE_REG, 0x03);    // Habilita sensor e ADC
-    gy33_write_register(i2c, ATIME_REG, 0xF5);      // Define tempo de integração (700ms)
-    gy33_write_register(i2c, CONTROL_REG, 0x00);    // Configura ganho 1x
-}
-
-// Lê os valores de cor do sensor
-void gy33_read_color(i2c_inst_t *i2c, uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c) {
-    *c = gy33_read_register(i2c, CDATA_REG);        // Luz clara (intensidade total)
-    *r = gy33_read_register(i2c, RDATA_REG);        // Componente vermelho
-    *g = gy33_read_register(i2c, GDATA_REG);        // Componente verde
-    *b = gy33_read_register(i2c, BDATA_REG);        // Componente azul
-}
-
-typedef struct {
-    const char *nome;
-    float r_norm;
-    float g_norm;
-    float b_norm;
-} CorReferencia;
-
-const CorReferencia cores_referencia[] = {
-    {"Vermelho",        0.400, 0.300, 0.300},
-    {"Ciano",           0.190, 0.420, 0.390},
-    {"Laranja",         0.360, 0.340, 0.290},
-    {"Azul-acizentado", 0.250, 0.380, 0.380},
-    {"Lilas",           0.300, 0.350, 0.360},
-    {"Amarelo",         0.340, 0.410, 0.250},
-    {"Branco",          0.290, 0.370, 0.340},
-    {"Verde",           0.250, 0.450, 0.300},
-    {"Roxo",            0.245, 0.355, 0.395},
-    {"Azul",            0.210, 0.350, 0.440},
-    {"Azul-escuro",     0.240, 0.380, 0.380}
-};
+static bool gy33_write_wait(i2c_bus_t *bus, uint16_t wait_ms) {
+    uint16_t cycles;
+    bool wlong;
+    gy33_wait_cycles(wait_ms, &cycles, &wlong);
+    return gy33_write_register(bus, WTIME_REG, (uint8_t)(256 - cycles)) &&
+           gy33_write_register(bus, CONFIG_REG, wlong ? CONFIG_WLONG : 0) &&
+           gy33_write_register(bus, ENABLE_REG, gy33_enable_bits(wait_ms));
+}
 
-float calcular_distancia(float r1, float g1, float b1, float r2, float g2, float b2) {
-    float dr = r1 - r2;
-    float dg = g1 - g2;
-    float db = b1 - b2;
-    return dr*dr + dg*dg + db*db;
+// Limiares (AILT/AIHT) e persistência da interrupção
+static bool gy33_write_interrupt(i2c_bus_t *bus) {
+    uint8_t thresholds[4] = {
+        (uint8_t)config.int_low, (uint8_t)(config.int_low >> 8),
+        (uint8_t)config.int_high, (uint8_t)(config.int_high >> 8),
+    };
+    return i2c_bus_write_reg(bus, GY33_I2C_ADDR, AILT_BURST_REG, thresholds, sizeof(thresholds)) &&
+           gy33_write_register(bus, PERS_REG, config.int_persistence);
 }
 
-const char* identificar_cor(uint16_t r, uint16_t g, uint16_t b, uint16_t c) {
-    if (c < 30) return "---";
+// Troca feita pela exposição automática
+static bool gy33_ae_apply(i2c_bus_t *bus, uint16_t cycles, gy33_gain_t gain) {
+    bool ok = (cycles == config.integration_cycles || gy33_set_integration(bus, cycles)) &&
+              (gain == config.gain || gy33_set_gain(bus, gain));
+    if (ok) {
+        config.ae_adjustments++;
+        LOG_D(COLOR, "[COR] Exposicao: %u ciclos, ganho %ux\n", cycles, gain_x[gain]);
+    }
+    return ok;
+}
 
-    float total = r + g + b;
-    if (total == 0) return "---";
+// --- Funções Públicas (declaradas em gy33.h) ---
 
-    float rn = r / total;
-    float gn = g / total;
-    float bn = b / total;
+// Inicializa o sensor com a configuração em uso (padrão no boot; após uma
+// falha no barramento, a última escolhida pela exposição automática e os
+// limiares de interrupção armados)
+bool gy33_init(i2c_bus_t *bus) {
+    return gy33_write_register(bus, ATIME_REG, (uint8_t)(256 - config.integration_cycles)) &&
+           gy33_write_register(bus, CONTROL_REG, (uint8_t)config.gain) &&
+           (!config.int_enabled || gy33_write_interrupt(bus)) &&
+           gy33_write_wait(bus, config.wait_ms) &&      // Habilita sensor e ADC por último
+           gy33_clear_interrupt(bus);
+}
 
-    int num_cores = sizeof(cores_referencia) / sizeof(cores_referencia[0]);
-    float menor_distancia = 999999.0;
-    int indice_melhor = 0;
+bool gy33_set_integration(i2c_bus_t *bus, uint16_t cycles) {
+    if (cycles < 1 || cycles > 256) return false;
+    if (!gy33_write_register(bus, ATIME_REG, (uint8_t)(256 - cycles))) return false;
+    config.integration_cycles = cycles;
+    return true;
+}
 
-    for (int i = 0; i < num_cores; i++) {
-        float dist = calcular_distancia(rn, gn, bn,
-                                        cores_referencia[i].r_norm,
-                                        cores_referencia[i].g_norm,
-                                        cores_referencia[i].b_norm);
-        if (dist < menor_distancia) {
-            menor_distancia = dist;
-            indice_melhor = i;
+bool gy33_set_gain(i2c_bus_t *bus, gy33_gain_t gain) {
+    if (gain >= GY33_GAIN_COUNT) return false;
+    if (!gy33_write_register(bus, CONTROL_REG, (uint8_t)gain)) return false;
+    config.gain = gain;
+    return true;
+}
+
+bool gy33_set_wait(i2c_bus_t *bus, uint16_t wait_ms) {
+    if (!gy33_write_wait(bus, wait_ms)) return false;
+    config.wait_ms = wait_ms;
+    return true;
+}
+
+bool gy33_auto_exposure(i2c_bus_t *bus, uint16_t c) {
+    uint32_t full = gy33_full_scale(config.integration_cycles);
+    uint16_t cycles = config.integration_cycles;
+
+    if (c >= full * GY33_AE_HIGH_PCT / 100) {
+        // Perto da saturação: reduz o ganho; no ganho mínimo, encurta a integração
+        if (config.gain > GY33_GAIN_1X) return gy33_ae_apply(bus, cycles, config.gain - 1);
+        if (cycles > GY33_AE_MIN_CYCLES) {
+            cycles /= 2;
+            if (cycles < GY33_AE_MIN_CYCLES) cycles = GY33_AE_MIN_CYCLES;
+            return gy33_ae_apply(bus, cycles, config.gain);
+        }
+    } else if (c < full * GY33_AE_LOW_PCT / 100) {
+        // Pouca luz: volta a integração ao alvo de taxa, depois aumenta o ganho.
+        // A integração nunca passa de GY33_INTEGRATION_CYCLES para manter a taxa.
+        if (cycles < GY33_INTEGRATION_CYCLES) {
+            cycles *= 2;
+            if (cycles > GY33_INTEGRATION_CYCLES) cycles = GY33_INTEGRATION_CYCLES;
+            return gy33_ae_apply(bus, cycles, config.gain);
         }
+        if (config.gain < GY33_GAIN_60X) return gy33_ae_apply(bus, cycles, config.gain + 1);
+    }
+    return false;
+}
+
+bool gy33_set_interrupt(i2c_bus_t *bus, uint16_t low, uint16_t high, uint8_t persistence) {
+    if (persistence > 15) return false;
+    bool was_enabled = config.int_enabled;
+    config.int_low = low;
+    config.int_high = high;
+    config.int_persistence = persistence;
+    config.int_enabled = true;
+    // Limiares antes do AIEN; a interrupção pendente (limiares antigos) é descartada
+    bool ok = gy33_write_interrupt(bus) &&
+              (was_enabled || gy33_write_register(bus, ENABLE_REG, gy33_enable_bits(config.wait_ms))) &&
+              gy33_clear_interrupt(bus);
+    if (!ok) config.int_enabled = was_enabled;
+    return ok;
+}
+
+bool gy33_disable_interrupt(i2c_bus_t *bus) {
+    config.int_enabled = false;
+    return gy33_write_register(bus, ENABLE_REG, gy33_enable_bits(config.wait_ms)) &&
+           gy33_clear_interrupt(bus);
+}
+
+bool gy33_clear_interrupt(i2c_bus_t *bus) {
+    uint8_t cmd = INT_CLEAR_CMD;    // Só o byte de comando, sem dados
+    return i2c_bus_write(bus, GY33_I2C_ADDR, &cmd, 1, false) == 1;
+}
+
+const gy33_config_t *gy33_get_config(void) {
+    return &config;
+}
+
+uint32_t gy33_integration_us(void) {
+    return (uint32_t)config.integration_cycles * GY33_CYCLE_US;
+}
+
+// Uma leitura completa: inicialização do ADC, integração e espera
+uint32_t gy33_cycle_us(void) {
+    uint32_t us = GY33_CYCLE_US + gy33_integration_us();
+    if (config.wait_ms) {
+        uint16_t cycles;
+        bool wlong;
+        gy33_wait_cycles(config.wait_ms, &cycles, &wlong);
+        us += (uint32_t)cycles * GY33_CYCLE_US * (wlong ? GY33_WLONG_FACTOR : 1);
     }
+    return us;
+}
 
-    return cores_referencia[indice_melhor].nome;
-}
\ No newline at end of file
+uint8_t gy33_gain_x(gy33_gain_t gain) {
+    return gain < GY33_GAIN_COUNT ? gain_x[gain] : 0;
+}
+
+// Verifica se o sensor responde; o valor do ID varia entre versões do TCS3472x
+bool gy33_probe(i2c_bus_t *bus) {
+    uint8_t id;
+    return i2c_bus_read_reg(bus, GY33_I2C_ADDR, ID_REG, &id, 1);
+}
+
+// Lê os valores de cor do sensor em uma única transação (índice + leitura com
+// repeated start, ~0,25 ms a 400 kHz): os quatro canais saem da mesma
+// integração, em vez de quatro leituras espaçadas que podiam cruzar o fim de um ciclo.
+bool gy33_read_color(i2c_bus_t *bus, uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c) {
+    uint8_t buffer[RGBC_BURST_LEN];
+    // Timeout da transferência vem do barramento (I2C_BUS_TIMEOUT_*)
+    if (!i2c_bus_read_reg(bus, GY33_I2C_ADDR, RGBC_BURST_REG, buffer, sizeof(buffer))) {
+        return false;
+    }
+
+    *c = gy33_le16(&buffer[0]);     // Luz clara (intensidade total)
+    *r = gy33_le16(&buffer[2]);     // Componente vermelho
+    *g = gy33_le16(&buffer[4]);     // Componente verde
+    *b = gy33_le16(&buffer[6]);     // Componente azul
+    return true;
+}
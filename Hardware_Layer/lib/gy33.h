@@ -2,15 +2,67 @@
 #define GY33_H
 
 #include "pico/stdlib.h"
-#include "hardware/i2c.h"
+#include "i2c_bus.h"
+#include "../config.h"
 
-//Inicializa o sensor de cor GY-33 (TCS34725).
-void gy33_init(i2c_inst_t *i2c);
+// Ganho analógico do TCS34725 (campo AGAIN do registrador CONTROL)
+typedef enum {
+    GY33_GAIN_1X = 0,
+    GY33_GAIN_4X,
+    GY33_GAIN_16X,
+    GY33_GAIN_60X,
+    GY33_GAIN_COUNT
+} gy33_gain_t;
 
-//Lê os valores de cor brutos do sensor.
-void gy33_read_color(i2c_inst_t *i2c, uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c);
+// Configuração de exposição em uso (restaurada por gy33_init após falhas)
+typedef struct {
+    uint16_t integration_cycles;    // Ciclos de 2,4 ms (ATIME = 256 - ciclos), 1..256
+    gy33_gain_t gain;
+    uint16_t wait_ms;               // Espera entre leituras (0 = desabilitada)
+    uint32_t ae_adjustments;        // Trocas feitas pela exposição automática
+    bool int_enabled;               // Interrupção do canal clear (AIEN)
+    uint16_t int_low;               // Limiares: INT quando clear < low ou > high
+    uint16_t int_high;
+    uint8_t int_persistence;        // Código do PERS (0..3 = 0..3 ciclos, 4 = 5, 5 = 10, ... 15 = 60)
+} gy33_config_t;
 
-//Analisa os valores RGB e retorna o nome da cor mais provável.
-const char* identificar_cor(uint16_t r, uint16_t g, uint16_t b, uint16_t c);
+//Inicializa o sensor de cor GY-33 (TCS34725); false se não responder.
+//O canal do multiplexador deve estar selecionado pelo chamador.
+bool gy33_init(i2c_bus_t *bus);
+
+//Verifica se o sensor responde (registrador ID).
+bool gy33_probe(i2c_bus_t *bus);
+
+//Tempo de integração em ciclos de 2,4 ms (1..256); false em falha.
+bool gy33_set_integration(i2c_bus_t *bus, uint16_t cycles);
+
+//Ganho analógico; false em falha.
+bool gy33_set_gain(i2c_bus_t *bus, gy33_gain_t gain);
+
+//Espera entre leituras em ms (0 desabilita; até 7372 ms com WLONG); false em falha.
+bool gy33_set_wait(i2c_bus_t *bus, uint16_t wait_ms);
+
+//Interrupção do canal clear: o pino INT (dreno aberto, ativo em 0) desce
+//quando o clear fica fora de [low, high] por "persistence" ciclos (código do
+//registrador PERS) e só volta com gy33_clear_interrupt(). Armar descarta a
+//interrupção pendente. false em falha.
+bool gy33_set_interrupt(i2c_bus_t *bus, uint16_t low, uint16_t high, uint8_t persistence);
+bool gy33_disable_interrupt(i2c_bus_t *bus);
+bool gy33_clear_interrupt(i2c_bus_t *bus);
+
+//Exposição automática: ajusta ganho e integração para manter o canal clear
+//entre GY33_AE_LOW_PCT e GY33_AE_HIGH_PCT do fundo de escala. Retorna true se
+//mudou a configuração (a leitura seguinte ainda mistura os valores antigos).
+bool gy33_auto_exposure(i2c_bus_t *bus, uint16_t c);
+
+//Configuração atual, tempo de integração e período de uma leitura completa (µs),
+//ganho como multiplicador.
+const gy33_config_t *gy33_get_config(void);
+uint32_t gy33_integration_us(void);
+uint32_t gy33_cycle_us(void);
+uint8_t gy33_gain_x(gy33_gain_t gain);
+
+//Lê os valores de cor brutos do sensor; false em falha (valores não alterados).
+bool gy33_read_color(i2c_bus_t *bus, uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c);
 
 #endif // GY33_H
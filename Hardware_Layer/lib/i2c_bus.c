@@ -0,0 +1,178 @@
+#include "i2c_bus.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "../config.h"
+
+// Maior escrita de registrador aceita por i2c_bus_write_reg (índice + dados)
+#define I2C_BUS_MAX_WRITE 64
+
+// Bus-clear: até 9 pulsos em SCL (um byte + ACK) a ~100 kHz
+#define I2C_BUS_CLEAR_PULSES    9
+#define I2C_BUS_CLEAR_HALF_US   5
+
+// --- Funções Internas ---
+
+// Timeout da transferência: fixo (endereço, clock stretching) + por byte
+static inline uint i2c_bus_timeout_us(size_t len) {
+    return I2C_BUS_TIMEOUT_BASE_US + (uint)len * I2C_BUS_TIMEOUT_PER_BYTE_US;
+}
+
+static int i2c_bus_hw_write(i2c_bus_t *bus, uint8_t addr, const uint8_t *src,
+                            size_t len, bool nostop) {
+    return i2c_write_timeout_us((i2c_inst_t *)bus->ctx, addr, src, len, nostop,
+                                i2c_bus_timeout_us(len));
+}
+
+static int i2c_bus_hw_read(i2c_bus_t *bus, uint8_t addr, uint8_t *dst,
+                           size_t len, bool nostop) {
+    return i2c_read_timeout_us((i2c_inst_t *)bus->ctx, addr, dst, len, nostop,
+                               i2c_bus_timeout_us(len));
+}
+
+// Linhas em dreno aberto pelo SIO: saída em 0 puxa, entrada solta (pull-up)
+static inline void i2c_bus_line(uint pin, bool release) {
+    gpio_set_dir(pin, release ? GPIO_IN : GPIO_OUT);
+}
+
+// Bus-clear (NXP UM10204, 3.1.16): o escravo que ficou no meio de um byte
+// solta SDA após no máximo 9 pulsos de clock; um STOP encerra a transação.
+bool i2c_bus_clear_lines(uint sda, uint scl) {
+    gpio_init(sda);
+    gpio_init(scl);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    gpio_put(sda, 0);
+    gpio_put(scl, 0);
+    i2c_bus_line(sda, true);
+    i2c_bus_line(scl, true);
+    sleep_us(I2C_BUS_CLEAR_HALF_US);
+
+    for (int i = 0; i < I2C_BUS_CLEAR_PULSES && !gpio_get(sda); i++) {
+        i2c_bus_line(scl, false);
+        sleep_us(I2C_BUS_CLEAR_HALF_US);
+        i2c_bus_line(scl, true);
+        sleep_us(I2C_BUS_CLEAR_HALF_US);
+    }
+
+    // STOP: SDA sobe com SCL em nível alto
+    i2c_bus_line(scl, false);
+    i2c_bus_line(sda, false);
+    sleep_us(I2C_BUS_CLEAR_HALF_US);
+    i2c_bus_line(scl, true);
+    sleep_us(I2C_BUS_CLEAR_HALF_US);
+    i2c_bus_line(sda, true);
+    sleep_us(I2C_BUS_CLEAR_HALF_US);
+
+    return gpio_get(sda) && gpio_get(scl);
+}
+
+static bool i2c_bus_hw_recover(i2c_bus_t *bus) {
+    i2c_inst_t *port = (i2c_inst_t *)bus->ctx;
+
+    i2c_deinit(port);
+    bool released = i2c_bus_clear_lines(bus->sda, bus->scl);
+
+    // Devolve os pinos ao periférico (reinicia a máquina de estados do I2C)
+    bus->baudrate = i2c_init(port, bus->baudrate);
+    gpio_set_function(bus->sda, GPIO_FUNC_I2C);
+    gpio_set_function(bus->scl, GPIO_FUNC_I2C);
+    return released;
+}
+
+static const i2c_bus_ops_t i2c_bus_hw_ops = {
+    .write = i2c_bus_hw_write,
+    .read = i2c_bus_hw_read,
+    .recover = i2c_bus_hw_recover,
+};
+
+// --- Funções Públicas (declaradas em i2c_bus.h) ---
+
+void i2c_bus_init_hw(i2c_bus_t *bus, const char *name, i2c_inst_t *port,
+                     uint sda, uint scl, uint32_t baudrate) {
+    bus->ops = &i2c_bus_hw_ops;
+    bus->ctx = port;
+    bus->name = name;
+    bus->sda = sda;
+    bus->scl = scl;
+    bus->transactions = 0;
+    bus->errors = 0;
+    bus->timeouts = 0;
+    bus->recoveries = 0;
+    bus->consecutive_errors = 0;
+
+    bus->baudrate = i2c_init(port, baudrate);
+    gpio_set_function(sda, GPIO_FUNC_I2C);
+    gpio_set_function(scl, GPIO_FUNC_I2C);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+}
+
+bool i2c_bus_recover(i2c_bus_t *bus) {
+    bus->recoveries++;
+    bus->consecutive_errors = 0;
+    return bus->ops->recover ? bus->ops->recover(bus) : false;
+}
+
+bool i2c_bus_read_reg(i2c_bus_t *bus, uint8_t addr, uint8_t reg, uint8_t *dst, size_t len) {
+    if (i2c_bus_write(bus, addr, &reg, 1, true) != 1) return false;
+    return i2c_bus_read(bus, addr, dst, len, false) == (int)len;
+}
+
+void i2c_bus_read_reg_group(i2c_bus_t *const buses[], const uint8_t addrs[], uint8_t reg,
+                            uint8_t *const dsts[], size_t len, bool ok[], size_t count) {
+    // Transporte paralelo: o do primeiro barramento que oferece read_reg_group
+    const i2c_bus_ops_t *group_ops = NULL;
+    for (size_t i = 0; i < count && group_ops == NULL; i++) {
+        if (buses[i]->ops->read_reg_group) group_ops = buses[i]->ops;
+    }
+
+    i2c_bus_t *group_buses[I2C_BUS_GROUP_MAX];
+    uint8_t group_addrs[I2C_BUS_GROUP_MAX];
+    uint8_t *group_dsts[I2C_BUS_GROUP_MAX];
+    int results[I2C_BUS_GROUP_MAX];
+    size_t group_index[I2C_BUS_GROUP_MAX];
+    size_t n = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (buses[i]->ops != group_ops || n >= I2C_BUS_GROUP_MAX) continue;
+
+        // Dois dispositivos no mesmo barramento não podem ser lidos juntos
+        bool repeated = false;
+        for (size_t j = 0; j < n; j++) {
+            if (group_buses[j] == buses[i]) repeated = true;
+        }
+        if (repeated) continue;
+
+        group_buses[n] = buses[i];
+        group_addrs[n] = addrs[i];
+        group_dsts[n] = dsts[i];
+        group_index[n++] = i;
+    }
+
+    if (n > 0) {
+        group_ops->read_reg_group(group_buses, group_addrs, reg, group_dsts, len, results, n);
+        for (size_t k = 0; k < n; k++) {
+            // Conta como read_reg (índice + leitura) para manter as estatísticas comparáveis
+            group_buses[k]->transactions += 2;
+            ok[group_index[k]] = i2c_bus_account(group_buses[k], results[k]) == (int)len;
+        }
+    }
+
+    // Restante (outros transportes, barramento repetido): um por vez
+    for (size_t i = 0, k = 0; i < count; i++) {
+        if (k < n && group_index[k] == i) {
+            k++;
+            continue;
+        }
+        ok[i] = i2c_bus_read_reg(buses[i], addrs[i], reg, dsts[i], len);
+    }
+}
+
+bool i2c_bus_write_reg(i2c_bus_t *bus, uint8_t addr, uint8_t reg, const uint8_t *src, size_t len) {
+    uint8_t buf[I2C_BUS_MAX_WRITE];
+    if (len + 1 > sizeof(buf)) return false;
+
+    buf[0] = reg;
+    memcpy(buf + 1, src, len);
+    return i2c_bus_write(bus, addr, buf, len + 1, false) == (int)(len + 1);
+}
@@ -0,0 +1,105 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "hardware/i2c.h"
+
+// =====================================================
+// Barramento I2C genérico
+//
+// Cada dispositivo guarda um ponteiro para o barramento em que está ligado
+// (I2C de hardware, PIO, ...). As transferências passam pela tabela de
+// operações do barramento, então drivers não dependem de i2c_inst_t nem de
+// variáveis globais. A inicialização do barramento (clock e GPIO) é feita
+// uma única vez, separada da inicialização dos dispositivos.
+//
+// Retorno das operações no padrão do SDK: número de bytes transferidos ou
+// código PICO_ERROR_* (< 0). Toda transferência tem timeout proporcional ao
+// tamanho (I2C_BUS_TIMEOUT_*): um escravo segurando SDA/SCL não trava o
+// firmware. Falhas são contadas por barramento; i2c_bus_recover() faz o
+// bus-clear (pulsos em SCL até o escravo soltar SDA + STOP).
+// =====================================================
+
+// Máximo de barramentos lidos ao mesmo tempo por i2c_bus_read_reg_group
+#define I2C_BUS_GROUP_MAX 4
+
+typedef struct i2c_bus i2c_bus_t;
+
+// Operações de transporte de um barramento
+typedef struct {
+    int (*write)(i2c_bus_t *bus, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+    int (*read)(i2c_bus_t *bus, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+    bool (*recover)(i2c_bus_t *bus);    // Bus-clear + reinicialização; true se SDA livre
+    // Opcional: a mesma leitura de registrador em vários barramentos deste
+    // transporte ao mesmo tempo (results[i] no padrão de read)
+    void (*read_reg_group)(i2c_bus_t *const buses[], const uint8_t addrs[], uint8_t reg,
+                           uint8_t *const dsts[], size_t len, int results[], size_t count);
+} i2c_bus_ops_t;
+
+struct i2c_bus {
+    const i2c_bus_ops_t *ops;
+    void *ctx;              // Instância do transporte (ex.: i2c_inst_t *)
+    const char *name;       // Nome para logs/status
+    uint sda;
+    uint scl;
+    uint32_t baudrate;      // Hz efetivos
+    uint32_t transactions;  // Transferências iniciadas (medição de tráfego)
+    uint32_t errors;        // Transferências com erro (NACK, timeout, ...)
+    uint32_t timeouts;      // Dessas, quantas por timeout (barramento preso)
+    uint32_t recoveries;    // Bus-clears executados
+    uint16_t consecutive_errors; // Erros seguidos (zera na primeira transferência boa)
+};
+
+// Configura um barramento de hardware (i2c_init + GPIO com pull-up)
+void i2c_bus_init_hw(i2c_bus_t *bus, const char *name, i2c_inst_t *port,
+                     uint sda, uint scl, uint32_t baudrate);
+
+// Contabiliza o resultado de uma transferência
+static inline int i2c_bus_account(i2c_bus_t *bus, int ret) {
+    if (ret < 0) {
+        bus->errors++;
+        if (ret == PICO_ERROR_TIMEOUT) bus->timeouts++;
+        if (bus->consecutive_errors < UINT16_MAX) bus->consecutive_errors++;
+    } else {
+        bus->consecutive_errors = 0;
+    }
+    return ret;
+}
+
+// Escreve len bytes; nostop = true mantém o barramento (repeated start)
+static inline int i2c_bus_write(i2c_bus_t *bus, uint8_t addr, const uint8_t *src,
+                                size_t len, bool nostop) {
+    bus->transactions++;
+    return i2c_bus_account(bus, bus->ops->write(bus, addr, src, len, nostop));
+}
+
+// Lê len bytes; nostop = true mantém o barramento (repeated start)
+static inline int i2c_bus_read(i2c_bus_t *bus, uint8_t addr, uint8_t *dst,
+                               size_t len, bool nostop) {
+    bus->transactions++;
+    return i2c_bus_account(bus, bus->ops->read(bus, addr, dst, len, nostop));
+}
+
+// Libera um barramento preso (escravo segurando SDA) e reinicializa o
+// transporte. Dispositivos perdem o estado da transação em andamento.
+bool i2c_bus_recover(i2c_bus_t *bus);
+
+// Bus-clear pelos GPIOs (usado no recover dos transportes); os pinos ficam
+// como SIO, o transporte os devolve ao periférico depois
+bool i2c_bus_clear_lines(uint sda, uint scl);
+
+// Escreve o índice do registrador e lê len bytes (repeated start)
+bool i2c_bus_read_reg(i2c_bus_t *bus, uint8_t addr, uint8_t reg, uint8_t *dst, size_t len);
+
+// Lê o mesmo registrador de vários dispositivos, um por barramento. Os
+// barramentos cujo transporte tem read_reg_group (PIO) são lidos em paralelo;
+// os demais, um após o outro. ok[i] = leitura i completa.
+void i2c_bus_read_reg_group(i2c_bus_t *const buses[], const uint8_t addrs[], uint8_t reg,
+                            uint8_t *const dsts[], size_t len, bool ok[], size_t count);
+
+// Escreve o índice do registrador seguido de len bytes em uma transação
+bool i2c_bus_write_reg(i2c_bus_t *bus, uint8_t addr, uint8_t reg, const uint8_t *src, size_t len);
+
+#endif // I2C_BUS_H
@@ -0,0 +1,62 @@
+#include "json_util.h"
+#include <stdio.h>
+#include <string.h>
+
+// --- Funções Públicas (declaradas em json_util.h) ---
+
+const char *json_find(const char *json, const char *key) {
+    size_t key_len = strlen(key);
+    for (const char *p = strchr(json, '"'); p; p = strchr(p + 1, '"')) {
+        if (strncmp(p + 1, key, key_len) != 0 || p[key_len + 1] != '"') continue;
+        const char *v = p + key_len + 2;
+        while (*v == ' ') v++;
+        if (*v != ':') continue;
+        v++;
+        while (*v == ' ') v++;
+        return v;
+    }
+    return NULL;
+}
+
+// Escapes simples (\" e \\) viram o próprio caractere
+bool json_get_string(const char *json, const char *key, char *out, size_t size) {
+    const char *v = json_find(json, key);
+    if (v == NULL || *v != '"') return false;
+    size_t n = 0;
+    for (v++; *v && *v != '"'; v++) {
+        if (*v == '\\' && v[1]) v++;
+        if (n + 1 < size) out[n++] = *v;
+    }
+    out[n] = '\0';
+    return *v == '"';
+}
+
+bool json_get_true(const char *json, const char *key) {
+    const char *v = json_find(json, key);
+    return v != NULL && strncmp(v, "true", 4) == 0;
+}
+
+size_t json_escape(const char *in, char *out, size_t size) {
+    if (size == 0) return 0;
+    size_t n = 0;
+    for (; *in; in++) {
+        unsigned char c = (unsigned char)*in;
+        char esc[7];
+        size_t esc_len;
+        if (c == '"' || c == '\\') {
+            esc[0] = '\\';
+            esc[1] = (char)c;
+            esc_len = 2;
+        } else if (c < 0x20) {
+            esc_len = (size_t)snprintf(esc, sizeof(esc), "\\u%04x", c);
+        } else {
+            esc[0] = (char)c;
+            esc_len = 1;
+        }
+        if (n + esc_len >= size) break;
+        memcpy(out + n, esc, esc_len);
+        n += esc_len;
+    }
+    out[n] = '\0';
+    return n;
+}
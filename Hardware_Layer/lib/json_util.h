@@ -0,0 +1,30 @@
+#ifndef JSON_UTIL_H
+#define JSON_UTIL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// =====================================================
+// Leitura mínima de JSON para as mensagens recebidas por MQTT
+//
+// Suficiente para os objetos planos que o backend envia (sem objetos ou
+// listas aninhados, sem \uXXXX: o texto vem em UTF-8 direto). Não aloca
+// memória e não modifica a mensagem. json_escape() faz o caminho inverso
+// para textos vindos do backend que voltam nas publicações.
+// =====================================================
+
+// Valor de "key" no objeto (ponteiro para o primeiro caractere do valor)
+const char *json_find(const char *json, const char *key);
+
+// Copia a string de "key"; false se a chave não existe ou não é string
+bool json_get_string(const char *json, const char *key, char *out, size_t size);
+
+// Verdadeiro se "key" existe e vale true
+bool json_get_true(const char *json, const char *key);
+
+// Copia in para out como conteúdo de string JSON (sem as aspas): escapa '"',
+// '\\' e caracteres de controle; UTF-8 passa direto. Trunca sem cortar um
+// escape no meio. Retorna o comprimento escrito.
+size_t json_escape(const char *in, char *out, size_t size);
+
+#endif // JSON_UTIL_H
@@ -63,7 +63,7 @@
 #define MEMP_NUM_TCPIP_MSG_INPKT 16    // Mensagens de entrada TCP/IP
 
 // Configurações MQTT específicas
-#define MQTT_OUTPUT_RINGBUF_SIZE 512   // Buffer de saída MQTT
+#define MQTT_OUTPUT_RINGBUF_SIZE 2560  // Buffer de saída MQTT (status de até STATUS_PAYLOAD_MAX = 2 KB + cabeçalho)
 #define MQTT_VAR_HEADER_BUFFER_LEN 128 // Buffer de cabeçalho MQTT
 #define MQTT_REQ_MAX_IN_FLIGHT 4       // Máximo de requisições MQTT simultâneas
 
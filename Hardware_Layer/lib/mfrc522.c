@@ -13,8 +13,22 @@ static int MFRC_Instance_Counter = 0;
  * Set up the data structures of an MFRC522 ADT object and return a pointer
  */
 MFRC522Ptr_t MFRC522_Init() {
+	return MFRC522_InitPins(cs_pin, RESET_PIN);
+}
+
+/**
+ * Same as MFRC522_Init() for a reader with its own chip select. Readers on
+ * the same bus may share the reset line: give the pin to the first one and
+ * -1 to the others (their PCD_Init() then only soft-resets the chip).
+ *
+ * @return NULL when all MFRC_MAX_INSTANCES objects are in use.
+ */
+MFRC522Ptr_t MFRC522_InitPins(uint csPin, int resetPin) {
 	// allocate instance struct array
 	static struct MFRC522_T mfrc_Instances[MFRC_MAX_INSTANCES];
+	if (MFRC_Instance_Counter >= MFRC_MAX_INSTANCES) {
+		return NULL;
+	}
 	//      static Chip_SSP_DATA_SETUP_T dataSetup_Instances[MFRC_MAX_INSTANCES];
 	//		struct MFRC522_T mfrc_struct;
 	//		Chip_SSP_DATA_SETUP_T data_setup;
@@ -26,7 +40,12 @@ MFRC522Ptr_t MFRC522_Init() {
 		mfrc_Instances[MFRC_Instance_Counter].Tx_Buf[i] = 0;
 	}
 
-	mfrc_Instances[MFRC_Instance_Counter]._chipSelectPin = cs_pin;
+	mfrc_Instances[MFRC_Instance_Counter]._chipSelectPin = csPin;
+	mfrc_Instances[MFRC_Instance_Counter].resetPin = resetPin;
+	mfrc_Instances[MFRC_Instance_Counter].irqPin = -1;
+	mfrc_Instances[MFRC_Instance_Counter].irqCallback = NULL;
+	mfrc_Instances[MFRC_Instance_Counter].dma = NULL;
+	mfrc_Instances[MFRC_Instance_Counter].armLast = NULL;
 
 	// update instance counter
 	MFRC_Instance_Counter++;
@@ -40,6 +59,27 @@ MFRC522Ptr_t MFRC522_Init() {
 * Basic interface functions for communicating with the MFRC522
 *******************************************************************************/
 
+/**
+ * One SPI transaction (CS low for the whole transfer). Goes through the DMA
+ * queue when one is attached (PCD_UseDma()), so it is ordered after any
+ * queued command set-up; rx may be NULL.
+ */
+static void PCD_Transfer(MFRC522Ptr_t mfrc, const uint8_t *tx, uint8_t *rx,
+						 size_t len) {
+	if (mfrc->dma) {
+		spi_dma_transfer(mfrc->dma, mfrc->_chipSelectPin, tx, rx, len);
+		return;
+	}
+
+	cs_select(mfrc->_chipSelectPin);
+	if (rx) {
+		spi_write_read_blocking(mfrc->spi, tx, rx, len);
+	} else {
+		spi_write_blocking(mfrc->spi, tx, len);
+	}
+	cs_deselect(mfrc->_chipSelectPin);
+}
+
 /**
  * Writes a uint8_t to the specified register in the MFRC522 chip.
  * The interface is described in the datasheet section 8.1.2.
@@ -49,14 +89,15 @@ void PCD_WriteRegister(MFRC522Ptr_t mfrc, uint8_t reg, uint8_t value) {
 	msg[0] = 0x00 | reg;
 	msg[1] = value;
 
-	cs_select(mfrc->_chipSelectPin);
-	spi_write_blocking(mfrc->spi, msg, 2);
-	cs_deselect(mfrc->_chipSelectPin);
+	PCD_Transfer(mfrc, msg, NULL, 2);
 }
 
 /**
  * Writes a number of uint8_ts to the specified register in the MFRC522 chip.
  * The interface is described in the datasheet section 8.1.2.
+ * The address byte is followed by all data bytes in a single CS-low burst
+ * (the MFRC522 keeps writing to the same register), so filling the FIFO is
+ * one SPI transaction regardless of count.
  */
 void PCD_WriteNRegister(
 	MFRC522Ptr_t mfrc,
@@ -64,17 +105,15 @@ void PCD_WriteNRegister(
 	uint8_t count, ///< The number of uint8_ts to write to the register
 	uint8_t *values ///< The values to write. uint8_t array.
 	) {
-	uint8_t msg[count + 1]; //Values and address
-	msg[0] = 0x00 | reg;
+	uint8_t tx[MFRC522_FIFO_BYTES + 1];
 
-	uint8_t i;
-	for(i = 0; i < count; i++) {
-		msg[i + 1] = values[i];
+	if (count > MFRC522_FIFO_BYTES) {
+		count = MFRC522_FIFO_BYTES;
 	}
+	tx[0] = 0x00 | reg;
+	memcpy(&tx[1], values, count);
 
-	cs_select(mfrc->_chipSelectPin);
-	spi_write_blocking(mfrc->spi, msg, count + 1);
-	cs_deselect(mfrc->_chipSelectPin);
+	PCD_Transfer(mfrc, tx, NULL, count + 1);
 }
 
 /**
@@ -85,19 +124,19 @@ uint8_t PCD_ReadRegister(
 	MFRC522Ptr_t mfrc, 
 	uint8_t reg ///< The register to read from. One of the PCD_Register enums
 	) {
-	uint8_t buf = 0;
-	const uint8_t msg = 0x80 | reg;
-	
-	cs_select(mfrc->_chipSelectPin);
-	spi_write_blocking(mfrc->spi, &msg, 1);
-	spi_read_blocking(mfrc->spi, 0, &buf, 1);
-	cs_deselect(mfrc->_chipSelectPin);
-	return buf;
+	const uint8_t msg[2] = {0x80 | reg, 0x00};
+	uint8_t buf[2];
+
+	PCD_Transfer(mfrc, msg, buf, 2);
+	return buf[1];
 }
 
 /**
  * Reads a number of uint8_ts from the specified register in the MFRC522 chip.
- * The interface is described in the datasheet section 8.1.2.
+ * The interface is described in the datasheet section 8.1.2.1: while CS stays
+ * low, every address byte clocked out on MOSI returns the value for the
+ * previous one on MISO. Sending the read address count times followed by
+ * 0x00 streams the whole FIFO in a single SPI transaction.
  */
 void PCD_ReadNRegister(
 	MFRC522Ptr_t mfrc,
@@ -106,25 +145,62 @@ void PCD_ReadNRegister(
 	uint8_t *values, ///< uint8_t array to store the values in.
 	uint8_t rxAlign ///< Only bit positions rxAlign..7 in values[0] are updated.
 	) {
-	uint8_t buf = 0;
-	const uint8_t msg = 0x80 | reg;
-	
-	cs_select(mfrc->_chipSelectPin);
+	uint8_t tx[MFRC522_FIFO_BYTES + 1];
+	uint8_t rx[MFRC522_FIFO_BYTES + 1];
+
+	if (count == 0) {
+		return;
+	}
+	if (count > MFRC522_FIFO_BYTES) {
+		count = MFRC522_FIFO_BYTES;
+	}
 
-	// uint8_t i;
-	// for(i = 0; i < count; i++) {
-	// 	uint8_t value = 0;
-	// 	spi_write_blocking(mfrc->spi, &msg, 1);
-	// 	spi_read_blocking(mfrc->spi, 0, &value, 1);
-	// 	values[i] = value;
-	// }
+	memset(tx, 0x80 | reg, count);
+	tx[count] = 0x00; // Last byte ends the stream without starting a new read
 
-	uint8_t i;
-	for(i = 0; i < count; i++) {
-		values[i] = PCD_ReadRegister(mfrc, msg);
+	PCD_Transfer(mfrc, tx, rx, count + 1);
+
+	// rx[0] is clocked in while the first address is sent (no data)
+	uint8_t first = 0;
+	if (rxAlign) {
+		// Keep the bits below rxAlign that belong to a previous partial byte
+		uint8_t mask = (uint8_t)(0xFF << rxAlign);
+		values[0] = (values[0] & ~mask) | (rx[1] & mask);
+		first = 1;
 	}
+	memcpy(&values[first], &rx[1 + first], count - first);
+}
 
-	cs_deselect(mfrc->_chipSelectPin);
+/**
+ * Reads several (possibly different) registers in one SPI transaction.
+ * Address streaming (datasheet section 8.1.2.1) accepts a different address
+ * in every byte, so e.g. status registers read together after a command
+ * cost one CS cycle instead of one each.
+ */
+void PCD_ReadRegisterList(
+	MFRC522Ptr_t mfrc,
+	const uint8_t *regs, ///< The registers to read. PCD_Register enums.
+	uint8_t count,       ///< Number of registers (at most MFRC522_FIFO_BYTES)
+	uint8_t *values      ///< Out: values[i] is the value of regs[i]
+	) {
+	uint8_t tx[MFRC522_FIFO_BYTES + 1];
+	uint8_t rx[MFRC522_FIFO_BYTES + 1];
+
+	if (count == 0) {
+		return;
+	}
+	if (count > MFRC522_FIFO_BYTES) {
+		count = MFRC522_FIFO_BYTES;
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		tx[i] = 0x80 | regs[i];
+	}
+	tx[count] = 0x00;
+
+	PCD_Transfer(mfrc, tx, rx, count + 1);
+
+	memcpy(values, &rx[1], count);
 }
 
 /**
@@ -169,8 +245,9 @@ PCD_CalculateCRC(MFRC522Ptr_t mfrc,
 	PCD_WriteRegister(mfrc, CommandReg, PCD_Idle); // Stop any active command.
 	PCD_WriteRegister(mfrc, DivIrqReg,
 					  0x04); // Clear the CRCIRq interrupt request bit
-	PCD_SetRegisterBitMask(mfrc, FIFOLevelReg,
-						   0x80); // FlushBuffer = 1, FIFO initialization
+	PCD_WriteRegister(mfrc, FIFOLevelReg,
+					  0x80); // FlushBuffer = 1, FIFO initialization (other
+							 // bits are read-only: no read-modify-write)
 	PCD_WriteNRegister(mfrc, FIFODataReg, length,
 					   data);						  // Write data to the FIFO
 	PCD_WriteRegister(mfrc, CommandReg, PCD_CalcCRC); // Start the calculation
@@ -198,8 +275,8 @@ PCD_CalculateCRC(MFRC522Ptr_t mfrc,
 		PCD_Idle); // Stop calculating CRC for new content in the FIFO.
 
 	// Transfer the result from the registers to the result buffer
-	result[0] = PCD_ReadRegister(mfrc, CRCResultRegL);
-	result[1] = PCD_ReadRegister(mfrc, CRCResultRegH);
+	static const uint8_t crcRegs[] = {CRCResultRegL, CRCResultRegH};
+	PCD_ReadRegisterList(mfrc, crcRegs, 2, result);
 	return STATUS_OK;
 } // End PCD_CalculateCRC()
 
@@ -212,25 +289,33 @@ PCD_CalculateCRC(MFRC522Ptr_t mfrc,
  */
 void PCD_Init(MFRC522Ptr_t mfrc, spi_inst_t *spi) {
 
-	mfrc->spi = spi0;
-	gpio_put(RESET_PIN, 0);
-    sleep_ms(1000);
-    gpio_put(RESET_PIN, 1);
-	sleep_ms(50);
+	mfrc->spi = spi;
+	if (mfrc->resetPin >= 0) {
+		gpio_put(mfrc->resetPin, 0);
+		sleep_ms(1000);
+		gpio_put(mfrc->resetPin, 1);
+		sleep_ms(50);
+	}
 
-    gpio_init(cs_pin);
-    gpio_set_dir(cs_pin, GPIO_OUT);
-    gpio_put(cs_pin, 1);
+    gpio_init(mfrc->_chipSelectPin);
+    gpio_set_dir(mfrc->_chipSelectPin, GPIO_OUT);
+    gpio_put(mfrc->_chipSelectPin, 1);
 
-    spi_init(spi0, 1000000);
+    spi_init(spi, 1000000);
 
-    spi_set_format(spi0, 8, 0, 0, SPI_MSB_FIRST);
+    spi_set_format(spi, 8, 0, 0, SPI_MSB_FIRST);
 
     gpio_set_function(sck_pin, GPIO_FUNC_SPI);
     gpio_set_function(mosi_pin, GPIO_FUNC_SPI);
     gpio_set_function(miso_pin, GPIO_FUNC_SPI);
 
-	PCD_WriteRegister(mfrc, CommandReg, PCD_SoftReset);
+	if (mfrc->resetPin >= 0) {
+		PCD_WriteRegister(mfrc, CommandReg, PCD_SoftReset);
+	} else {
+		// Reset line shared with (and already pulsed by) another reader: the
+		// chip may still be starting, so wait for the soft reset to finish
+		PCD_Reset(mfrc);
+	}
 
 	// When communicating with a PICC we need a timeout if something goes wrong.
 	// f_timer = 13.56 MHz / (2*TPreScaler+1) where TPreScaler =
@@ -262,6 +347,166 @@ void PCD_Init(MFRC522Ptr_t mfrc, spi_inst_t *spi) {
 						 // were disabled by the reset)
 } // End PCD_Init()
 
+// Instances with pin IRQ enabled, looked up by the GPIO interrupt handler
+static MFRC522Ptr_t irqInstances[MFRC_MAX_INSTANCES];
+
+/**
+ * Shared IO_IRQ_BANK0 handler: acknowledges the falling edges of the enabled
+ * IRQ pins and notifies their owners. Other GPIO handlers may share the bank.
+ */
+static void PCD_IrqHandler(void) {
+	for (uint8_t i = 0; i < MFRC_MAX_INSTANCES; i++) {
+		MFRC522Ptr_t mfrc = irqInstances[i];
+		if (mfrc == NULL ||
+			!(gpio_get_irq_event_mask(mfrc->irqPin) & GPIO_IRQ_EDGE_FALL)) {
+			continue;
+		}
+		gpio_acknowledge_irq(mfrc->irqPin, GPIO_IRQ_EDGE_FALL);
+		mfrc->irqEvents++;
+		if (mfrc->irqCallback) {
+			mfrc->irqCallback(mfrc, mfrc->irqContext);
+		}
+	}
+}
+
+/**
+ * Routes command completion (RxIRq, IdleIRq, TimerIRq) to pin IRQ.
+ * The pin is driven push-pull and active low (IRqInv). The wiring is checked
+ * first by forcing TimerIRq through ComIrqReg.Set1: if the pin does not follow,
+ * the instance keeps polling ComIrqReg over SPI.
+ * Call after PCD_Init(); a soft reset clears ComIEnReg/DivIEnReg.
+ *
+ * @return true if pin IRQ is in use.
+ */
+bool PCD_EnableIrq(
+	MFRC522Ptr_t mfrc,
+	uint irqPin,			  ///< GPIO connected to pin IRQ of the MFRC522
+	PCD_IrqCallback callback, ///< NULL or called on every IRQ edge
+	void *context			  ///< Passed to callback
+	) {
+	// IRQ pins of all instances (e.g. GP1 and GP22 with two readers)
+	static uint32_t handlerMask = 0;
+
+	gpio_init(irqPin);
+	gpio_set_dir(irqPin, GPIO_IN);
+	gpio_pull_up(irqPin);
+
+	PCD_WriteRegister(mfrc, DivIEnReg, 0x80); // IRQPushPull=1, DivIrq sources off
+	PCD_WriteRegister(mfrc, ComIEnReg, 0x81); // IRqInv=1 (active low), TimerIEn
+
+	// Wiring check: set TimerIRq by hand, expect the pin low, clear it again
+	PCD_WriteRegister(mfrc, ComIrqReg, 0x81); // Set1=1 => marked bits are set
+	sleep_us(10);
+	bool asserted = !gpio_get(irqPin);
+	PCD_WriteRegister(mfrc, ComIrqReg, 0x7F); // Clear all interrupt request bits
+	sleep_us(10);
+	bool released = gpio_get(irqPin);
+	if (!asserted || !released) {
+		PCD_WriteRegister(mfrc, ComIEnReg, 0x80); // Reset value, no sources
+		return false;
+	}
+
+	PCD_WriteRegister(mfrc, ComIEnReg, 0x80 | PCD_IRQ_SOURCES);
+
+	mfrc->irqCallback = callback;
+	mfrc->irqContext = context;
+	mfrc->irqEvents = 0;
+	mfrc->irqPin = (int)irqPin;
+	for (uint8_t i = 0; i < MFRC_MAX_INSTANCES; i++) {
+		if (irqInstances[i] == NULL || irqInstances[i] == mfrc) {
+			irqInstances[i] = mfrc;
+			break;
+		}
+	}
+
+	// A raw handler is only called for the pins in its mask: re-register it
+	// with this pin added (bank IRQ off meanwhile, edges stay latched)
+	uint32_t mask = handlerMask | (1u << irqPin);
+	if (mask != handlerMask) {
+		irq_set_enabled(IO_IRQ_BANK0, false);
+		if (handlerMask) {
+			gpio_remove_raw_irq_handler_masked(handlerMask, PCD_IrqHandler);
+		}
+		gpio_add_raw_irq_handler_masked(mask, PCD_IrqHandler);
+		handlerMask = mask;
+	}
+	gpio_set_irq_enabled(irqPin, GPIO_IRQ_EDGE_FALL, true);
+	irq_set_enabled(IO_IRQ_BANK0, true);
+	return true;
+} // End PCD_EnableIrq()
+
+/**
+ * Moves all SPI traffic of this instance to a DMA transport. Command set-up
+ * in PCD_CommunicateStart() is then queued instead of written by the CPU.
+ */
+void PCD_UseDma(MFRC522Ptr_t mfrc, spi_dma_t *dma) {
+	if (mfrc->dma) {
+		spi_dma_wait_idle(mfrc->dma);
+	}
+	mfrc->dma = dma;
+	mfrc->armLast = NULL;
+} // End PCD_UseDma()
+
+/**
+ * Checks the SPI link at the current clock: VersionReg must read back
+ * expected and a full FIFO of alternating patterns must survive a write and
+ * burst read (the longest transfers the driver makes).
+ */
+static bool PCD_CheckSpiLink(MFRC522Ptr_t mfrc, uint8_t version) {
+	uint8_t pattern[MFRC522_FIFO_BYTES];
+	uint8_t readBack[MFRC522_FIFO_BYTES];
+	bool ok = true;
+
+	for (uint8_t round = 0; round < 4 && ok; round++) {
+		for (uint8_t i = 0; i < MFRC522_FIFO_BYTES; i++) {
+			pattern[i] = (i & 1) ? (uint8_t)(0x55 ^ round ^ i) : (uint8_t)(0xAA ^ (i << 2));
+		}
+		PCD_WriteRegister(mfrc, FIFOLevelReg, 0x80);
+		PCD_WriteNRegister(mfrc, FIFODataReg, MFRC522_FIFO_BYTES, pattern);
+		ok = PCD_ReadRegister(mfrc, VersionReg) == version &&
+			 PCD_ReadRegister(mfrc, FIFOLevelReg) == MFRC522_FIFO_BYTES;
+		if (ok) {
+			PCD_ReadNRegister(mfrc, FIFODataReg, MFRC522_FIFO_BYTES, readBack, 0);
+			ok = memcmp(pattern, readBack, MFRC522_FIFO_BYTES) == 0;
+		}
+	}
+	PCD_WriteRegister(mfrc, FIFOLevelReg, 0x80);
+	return ok;
+}
+
+/**
+ * Raises the SPI clock to the fastest rate up to maxHz (the MFRC522 accepts
+ * up to 10 Mbit/s) at which the link still passes PCD_CheckSpiLink(). The
+ * rate is halved on every failure and never goes below the current clock.
+ * Call after PCD_Init(); PCD_Init() goes back to 1 MHz.
+ *
+ * @return The SPI clock in use, in Hz.
+ */
+uint32_t PCD_SetSpiClock(MFRC522Ptr_t mfrc, uint32_t maxHz) {
+	uint32_t current = spi_get_baudrate(mfrc->spi);
+	uint8_t version = PCD_ReadRegister(mfrc, VersionReg);
+
+	// No chip (or wrong wiring) even at the boot clock: nothing to validate
+	if (version == 0x00 || version == 0xFF) {
+		return current;
+	}
+
+	for (uint32_t hz = maxHz; hz > current; hz /= 2) {
+		if (mfrc->dma) {
+			spi_dma_wait_idle(mfrc->dma);
+		}
+		uint32_t actual = spi_set_baudrate(mfrc->spi, hz);
+		if (PCD_CheckSpiLink(mfrc, version)) {
+			return actual;
+		}
+	}
+
+	if (mfrc->dma) {
+		spi_dma_wait_idle(mfrc->dma);
+	}
+	return spi_set_baudrate(mfrc->spi, current);
+} // End PCD_SetSpiClock()
+
 /**
  * Performs a soft reset on the MFRC522 chip and waits for it to be ready again.
  */
@@ -276,8 +521,11 @@ void PCD_Reset(MFRC522Ptr_t mfrc) {
 	// start up time of the crystal + 37,74�s. Let us be generous: 50ms.
 	//SysTick_Init();
 	sleep_ms(50);
-	// Wait for the PowerDown bit in CommandReg to be cleared
-	while (PCD_ReadRegister(mfrc, CommandReg) & (1 << 4)) {
+	// Wait for the PowerDown bit in CommandReg to be cleared. Bounded: a
+	// reader that is not fitted reads 0xFF on a shared bus.
+	uint32_t start = time_us_32();
+	while ((PCD_ReadRegister(mfrc, CommandReg) & (1 << 4)) &&
+		   (time_us_32() - start) < 50000) {
 		// PCD still restarting - unlikely after waiting 50ms, but better safe
 		// than sorry.
 	}
@@ -461,79 +709,206 @@ StatusCode PCD_CommunicateWithPICC(
 	bool checkCRC ///< In: True => The last two uint8_ts of the response is
 				  ///assumed to be a CRC_A that must be validated.
 	) {
-	//		backData=NULL;
-	//		backLen=NULL;
-	//		validBits=NULL;
-	//		rxAlign=0;
-	//		checkCRC=false;
+	StatusCode status =
+		PCD_CommunicateStart(mfrc, command, waitIRq, sendData, sendLen,
+							 validBits ? *validBits : 0, rxAlign);
+	if (status != STATUS_OK) {
+		return status;
+	}
+
+	// With pin IRQ enabled the wait does not touch the SPI bus; otherwise
+	// every iteration reads ComIrqReg.
+	do {
+		status = PCD_CommunicatePoll(mfrc, backData, backLen, validBits,
+									 checkCRC);
+	} while (status == STATUS_BUSY);
+	return status;
+} // End PCD_CommunicateWithPICC()
+
+/**
+ * Queues one register write of the command set-up (see PCD_QueueCommand()).
+ */
+static void PCD_QueueWrite(MFRC522Ptr_t mfrc, uint8_t *index, uint8_t *offset,
+						   uint8_t reg, const uint8_t *values, uint8_t count) {
+	uint8_t *tx = &mfrc->armBuf[*offset];
+	spi_dma_xfer_t *xfer = &mfrc->armXfer[*index];
+
+	tx[0] = reg;
+	memcpy(&tx[1], values, count);
+	xfer->cs_pin = mfrc->_chipSelectPin;
+	xfer->tx = tx;
+	xfer->rx = NULL;
+	xfer->len = count + 1;
+	xfer->done_cb = NULL;
+	while (!spi_dma_submit(mfrc->dma, xfer)) {
+		tight_loop_contents(); // Queue shared with other devices is full
+	}
+
+	*offset += count + 1;
+	(*index)++;
+	mfrc->armLast = xfer;
+}
 
-	uint8_t n, _validBits;
-	unsigned int i;
+/**
+ * Same register writes as the polled PCD_CommunicateStart(), queued on the
+ * DMA transport as separate CS transactions: the CPU returns right away and
+ * the FIFO load runs in the background. PCD_CommunicatePoll() reports
+ * STATUS_BUSY until the last one went out.
+ */
+static void PCD_QueueCommand(MFRC522Ptr_t mfrc, uint8_t command,
+							 const uint8_t *sendData, uint8_t sendLen,
+							 uint8_t bitFraming) {
+	const uint8_t idle = PCD_Idle;
+	const uint8_t clearIrq = 0x7F;
+	const uint8_t flush = 0x80;
+	const uint8_t startSend = 0x80 | bitFraming;
+	uint8_t index = 0, offset = 0;
+
+	// armBuf/armXfer of the previous command may still be queued
+	if (mfrc->armLast) {
+		while (!mfrc->armLast->done) {
+			tight_loop_contents();
+		}
+	}
+	if (sendLen > MFRC522_FIFO_BYTES) {
+		sendLen = MFRC522_FIFO_BYTES;
+	}
 
+	PCD_QueueWrite(mfrc, &index, &offset, CommandReg, &idle, 1);
+	PCD_QueueWrite(mfrc, &index, &offset, ComIrqReg, &clearIrq, 1);
+	PCD_QueueWrite(mfrc, &index, &offset, FIFOLevelReg, &flush, 1);
+	if (sendLen) {
+		PCD_QueueWrite(mfrc, &index, &offset, FIFODataReg, sendData, sendLen);
+	}
+	PCD_QueueWrite(mfrc, &index, &offset, BitFramingReg, &bitFraming, 1);
+	PCD_QueueWrite(mfrc, &index, &offset, CommandReg, &command, 1);
+	if (command == PCD_Transceive) {
+		PCD_QueueWrite(mfrc, &index, &offset, BitFramingReg, &startSend, 1);
+	}
+}
+
+/**
+ * First half of PCD_CommunicateWithPICC(): loads the FIFO and starts the
+ * command, then returns. Collect the result with PCD_CommunicatePoll().
+ *
+ * @return STATUS_OK once the command is running.
+ */
+StatusCode PCD_CommunicateStart(
+	MFRC522Ptr_t mfrc,
+	uint8_t command,	///< The command to execute. One of the PCD_Command enums.
+	uint8_t waitIRq,	///< The bits in the ComIrqReg register that signals
+						///successful completion of the command.
+	uint8_t *sendData,  ///< Pointer to the data to transfer to the FIFO.
+	uint8_t sendLen,	///< Number of uint8_ts to transfer to the FIFO.
+	uint8_t txLastBits, ///< Number of valid bits in the last uint8_t sent.
+						///0 for 8 valid bits.
+	uint8_t rxAlign		///< Bit position in backData[0] for the first bit
+						///received.
+	) {
 	// Prepare values for BitFramingReg
-	uint8_t txLastBits = validBits ? *validBits : 0;
 	uint8_t bitFraming =
 		(rxAlign << 4) + txLastBits; // RxAlign = BitFramingReg[6..4].
 									 // TxLastBits = BitFramingReg[2..0]
 
+	mfrc->waitIRq = waitIRq;
+	mfrc->rxAlign = rxAlign;
+
+	if (mfrc->dma) {
+		PCD_QueueCommand(mfrc, command, sendData, sendLen, bitFraming);
+		mfrc->commandStart = time_us_32();
+		return STATUS_OK;
+	}
+
 	PCD_WriteRegister(mfrc, CommandReg, PCD_Idle); // Stop any active command.
 	PCD_WriteRegister(mfrc, ComIrqReg,
-					  0x7F); // Clear all seven interrupt request bits
-	PCD_SetRegisterBitMask(mfrc, FIFOLevelReg,
-						   0x80); // FlushBuffer = 1, FIFO initialization
+					  0x7F); // Clear all seven interrupt request bits (also
+							 // releases pin IRQ)
+	PCD_WriteRegister(mfrc, FIFOLevelReg,
+					  0x80); // FlushBuffer = 1, FIFO initialization (other
+							 // bits are read-only: no read-modify-write)
 	PCD_WriteNRegister(mfrc, FIFODataReg, sendLen,
 					   sendData); // Write sendData to the FIFO
 	PCD_WriteRegister(mfrc, BitFramingReg, bitFraming); // Bit adjustments
 	PCD_WriteRegister(mfrc, CommandReg, command);		// Execute the command
 	if (command == PCD_Transceive) {
-		PCD_SetRegisterBitMask(
-			mfrc, BitFramingReg,
-			0x80); // StartSend=1, transmission of data starts
+		PCD_WriteRegister(mfrc, BitFramingReg,
+						  0x80 | bitFraming); // StartSend=1, transmission of
+											  // data starts
 	}
+	mfrc->commandStart = time_us_32();
+	return STATUS_OK;
+} // End PCD_CommunicateStart()
 
-	// Wait for the command to complete.
-	// In PCD_Init() we set the TAuto flag in TModeReg. This means the timer
-	// automatically starts when the PCD stops transmitting.
-	// Each iteration of the do-while-loop takes 17.86�s.
-	i = 2000;
-	while (1) {
-		n = PCD_ReadRegister(mfrc, ComIrqReg); // ComIrqReg[7..0] bits are: Set1
-											   // TxIRq RxIRq IdleIRq HiAlertIRq
-											   // LoAlertIRq ErrIRq TimerIRq
-		if (n & waitIRq) { // One of the interrupts that signal success has been
-						   // set.
-			break;
-		}
-		if (n & 0x01) { // Timer interrupt - nothing received in 25ms
-			return STATUS_TIMEOUT;
-		}
-		if (--i == 0) { // The emergency break. If all other conditions fail we
-						// will eventually terminate on this one after 35.7ms.
-						// Communication with the MFRC522 might be down.
+/**
+ * Second half of PCD_CommunicateWithPICC(): checks whether the command armed
+ * by PCD_CommunicateStart() completed and transfers data back from the FIFO.
+ * In PCD_Init() we set the TAuto flag in TModeReg, so the timer starts when
+ * the PCD stops transmitting and ends the command after 25 ms without an
+ * answer. With pin IRQ enabled, ComIrqReg is only read once the pin is low.
+ *
+ * @return STATUS_BUSY while the command runs, STATUS_OK on success,
+ *STATUS_??? otherwise.
+ */
+StatusCode PCD_CommunicatePoll(
+	MFRC522Ptr_t mfrc,
+	uint8_t *backData,  ///< NULL or pointer to buffer if data should be read
+						///back after executing the command.
+	uint8_t *backLen,   ///< In: Max number of uint8_ts to write to *backData.
+						///Out: The number of uint8_ts returned.
+	uint8_t *validBits, ///< Out: The number of valid bits in the last
+						///uint8_t. 0 for 8 valid bits.
+	bool checkCRC ///< In: True => The last two uint8_ts of the response is
+				  ///assumed to be a CRC_A that must be validated.
+	) {
+	uint8_t n, _validBits = 0;
+
+	// Command set-up still in the DMA queue
+	if (mfrc->armLast && !mfrc->armLast->done) {
+		return STATUS_BUSY;
+	}
+	mfrc->armLast = NULL;
+
+	// The emergency break. If all other conditions fail we will eventually
+	// terminate on this one. Communication with the MFRC522 might be down.
+	bool expired =
+		(time_us_32() - mfrc->commandStart) >= PCD_COMMAND_TIMEOUT_US;
+	if (mfrc->irqPin >= 0 && gpio_get(mfrc->irqPin) && !expired) {
+		return STATUS_BUSY; // No interrupt request pending
+	}
+
+	n = PCD_ReadRegister(mfrc, ComIrqReg); // ComIrqReg[7..0] bits are: Set1
+										   // TxIRq RxIRq IdleIRq HiAlertIRq
+										   // LoAlertIRq ErrIRq TimerIRq
+	if (!(n & mfrc->waitIRq)) { // None of the interrupts that signal success
+		if (n & 0x01) {			// Timer interrupt - nothing received in 25ms
 			return STATUS_TIMEOUT;
 		}
+		return expired ? STATUS_TIMEOUT : STATUS_BUSY;
 	}
 
+	// ErrorReg, FIFOLevelReg and ControlReg in one burst
+	static const uint8_t statusRegs[] = {ErrorReg, FIFOLevelReg, ControlReg};
+	uint8_t status[3];
+	PCD_ReadRegisterList(mfrc, statusRegs, 3, status);
+
 	// Stop now if any errors except collisions were detected.
-	uint8_t errorRegValue =
-		PCD_ReadRegister(mfrc, ErrorReg); // ErrorReg[7..0] bits are: WrErr
-										  // TempErr reserved BufferOvfl CollErr
-										  // CRCErr ParityErr ProtocolErr
-	if (errorRegValue & 0x13) {			  // BufferOvfl ParityErr ProtocolErr
+	uint8_t errorRegValue = status[0]; // ErrorReg[7..0] bits are: WrErr
+									   // TempErr reserved BufferOvfl CollErr
+									   // CRCErr ParityErr ProtocolErr
+	if (errorRegValue & 0x13) {		   // BufferOvfl ParityErr ProtocolErr
 		return STATUS_ERROR;
 	}
 
 	// If the caller wants data back, get it from the MFRC522.
 	if (backData && backLen) {
-		n = PCD_ReadRegister(mfrc,
-							 FIFOLevelReg); // Number of uint8_ts in the FIFO
+		n = status[1]; // Number of uint8_ts in the FIFO
 		if (n > *backLen) {
 			return STATUS_NO_ROOM;
 		}
 		*backLen = n; // Number of uint8_ts returned
 		PCD_ReadNRegister(mfrc, FIFODataReg, n, backData,
-						  rxAlign); // Get received data from FIFO
-		_validBits = PCD_ReadRegister(mfrc, ControlReg) &
+						  mfrc->rxAlign); // Get received data from FIFO
+		_validBits = status[2] &
 					 0x07; // RxLastBits[2:0] indicates the number of valid bits
 						   // in the last received uint8_t. If this value is
 						   // 000b, the whole uint8_t is valid.
@@ -573,7 +948,7 @@ StatusCode PCD_CommunicateWithPICC(
 	}
 
 	return STATUS_OK;
-} // End PCD_CommunicateWithPICC()
+} // End PCD_CommunicatePoll()
 
 /**
  * Transmits a REQuest command, Type A. Invites PICCs in state IDLE to go to
@@ -650,6 +1025,55 @@ StatusCode PICC_REQA_or_WUPA(
 	return STATUS_OK;
 } // End PICC_REQA_or_WUPA()
 
+/**
+ * Starts REQA or WUPA and returns without waiting for the answer, so the
+ * caller can keep working during the up to 25 ms the chip timer waits for a
+ * card. Collect the ATQA with PICC_REQA_or_WUPA_Poll().
+ *
+ * @return STATUS_OK once the command is running.
+ */
+StatusCode PICC_REQA_or_WUPA_Start(
+	MFRC522Ptr_t mfrc,
+	uint8_t command ///< The command to send - PICC_CMD_REQA or PICC_CMD_WUPA
+	) {
+	PCD_ClearRegisterBitMask(mfrc, CollReg, 0x80); // ValuesAfterColl=1 => Bits
+												   // received after collision
+												   // are cleared.
+	// Short frame format: 7 bits of the only uint8_t
+	return PCD_CommunicateStart(mfrc, PCD_Transceive, 0x30, &command, 1, 7, 0);
+} // End PICC_REQA_or_WUPA_Start()
+
+/**
+ * Completes the REQA/WUPA started by PICC_REQA_or_WUPA_Start().
+ *
+ * @return STATUS_BUSY while waiting, STATUS_OK on success, STATUS_???
+ *otherwise.
+ */
+StatusCode PICC_REQA_or_WUPA_Poll(
+	MFRC522Ptr_t mfrc,
+	uint8_t *
+		bufferATQA,		///< The buffer to store the ATQA (Answer to request) in
+	uint8_t *bufferSize ///< Buffer size, at least two uint8_ts. Also number of
+						///uint8_ts returned if STATUS_OK.
+	) {
+	uint8_t validBits = 0;
+	StatusCode status;
+
+	if (bufferATQA == NULL ||
+		*bufferSize < 2) { // The ATQA response is 2 uint8_ts long.
+		return STATUS_NO_ROOM;
+	}
+	status = PCD_CommunicatePoll(mfrc, bufferATQA, bufferSize, &validBits,
+								 false);
+	if (status != STATUS_OK) {
+		return status;
+	}
+	if (*bufferSize != 2 || validBits != 0) { // ATQA must be exactly 16 bits.
+		return STATUS_ERROR;
+	}
+	return STATUS_OK;
+} // End PICC_REQA_or_WUPA_Poll()
+
 /**
  * Transmits SELECT/ANTICOLLISION commands to select a single PICC.
  * Before calling this function the PICCs must be placed in the READY(*) state
@@ -1496,6 +1920,8 @@ const char *GetStatusCodeName(StatusCode code ///< One of theStatusCode enums.
 		return "Invalid argument.";
 	case STATUS_CRC_WRONG:
 		return "The CRC_A does not match.";
+	case STATUS_BUSY:
+		return "Command still running.";
 	case STATUS_MIFARE_NACK:
 		return "A MIFARE PICC responded with NAK.";
 	default:
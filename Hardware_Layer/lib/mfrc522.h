@@ -22,6 +22,7 @@
 #include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
+#include "spi_dma.h"
 
 // Incluir configurações do projeto
 #include "../config.h"
@@ -42,6 +43,15 @@
 // GPIO pin assignments for MFRC522 (agora vindo do config.h)
 #define RESET_PIN PIN_RST
 
+// Emergency break for a command that never completes (the chip timer set in
+// PCD_Init() normally ends it after 25 ms). Same 35.7 ms as the former 2000
+// ComIrqReg reads.
+#define PCD_COMMAND_TIMEOUT_US 36000
+
+// ComIEnReg sources routed to pin IRQ: RxIEn, IdleIEn and TimerIEn, the bits
+// that end PCD_Transceive, PCD_MFAuthent and the timeout
+#define PCD_IRQ_SOURCES 0x31
+
 static const uint cs_pin = PIN_CS;
 static const uint sck_pin = PIN_SCK;
 static const uint mosi_pin = PIN_MOSI;
@@ -49,6 +59,7 @@ static const uint miso_pin = PIN_MISO;
 
 // Size of the MFRC522 FIFO buffer
 static const uint8_t FIFO_SIZE = 64;
+#define MFRC522_FIFO_BYTES 64   // Same value, usable as an array size
 
 // Self-test expected output bytes (MFRC522 firmware verification)
 static const uint8_t SELF_TEST_BYTES[] = {
@@ -238,6 +249,7 @@ typedef enum _StatusCode {
 	STATUS_INTERNAL_ERROR,   // Internal error in the code (should not happen)
 	STATUS_INVALID,          // Invalid argument
 	STATUS_CRC_WRONG,        // The CRC_A does not match
+	STATUS_BUSY,             // Command still running (asynchronous API)
 	STATUS_MIFARE_NACK = 0xff  // A MIFARE PICC responded with NAK
 } StatusCode;
 
@@ -269,13 +281,29 @@ struct MFRC522_T {
 	Uid uid;                    // Used by PICC_ReadCardSerial()
 	spi_inst_t *spi;            // Select SPI0 or SPI1
 	uint _chipSelectPin;        // Chip select pin
+	int resetPin;               // Hard reset pin (-1 = shared, pulsed by another reader)
 	uint8_t Tx_Buf[BUFFER_SIZE]; // Transmit buffer
 	uint8_t Rx_Buf[BUFFER_SIZE]; // Receive buffer
+	int irqPin;                 // Pin IRQ (-1 = completion polled over SPI)
+	void (*irqCallback)(struct MFRC522_T *mfrc, void *context); // IRQ edge (interrupt context)
+	void *irqContext;
+	volatile uint32_t irqEvents; // IRQ edges seen
+	uint8_t waitIRq;            // Completion bits of the armed command
+	uint8_t rxAlign;            // rxAlign of the armed command
+	uint32_t commandStart;      // time_us_32() when the command was armed
+	spi_dma_t *dma;             // DMA transport (NULL = SPI by the CPU)
+	uint8_t armBuf[12 + MFRC522_FIFO_BYTES + 1]; // Queued command set-up
+	spi_dma_xfer_t armXfer[7];
+	spi_dma_xfer_t *armLast;    // Last queued set-up write (NULL = none)
 };
 
 // Pointer to a MFRC522 ADT object
 typedef struct MFRC522_T *MFRC522Ptr_t;
 
+// Called on the falling edge of pin IRQ, in interrupt context: only signal
+// the main loop, the result is collected with PCD_CommunicatePoll()
+typedef void (*PCD_IrqCallback)(MFRC522Ptr_t mfrc, void *context);
+
 /*******************************************************************************
  * Initialization Function
  ******************************************************************************/
@@ -286,6 +314,13 @@ typedef struct MFRC522_T *MFRC522Ptr_t;
  */
 MFRC522Ptr_t MFRC522_Init(void);
 
+/**
+ * @brief Sets up a MFRC522 ADT object for a reader on its own chip select
+ * (several readers sharing one SPI bus)
+ * @return Pointer to an initialized ADT object, NULL when none is left
+ */
+MFRC522Ptr_t MFRC522_InitPins(uint csPin, int resetPin);
+
 /*******************************************************************************
  * Basic Interface Functions for Communicating with the MFRC522
  ******************************************************************************/
@@ -296,7 +331,7 @@ MFRC522Ptr_t MFRC522_Init(void);
 void PCD_WriteRegister(MFRC522Ptr_t mfrc, uint8_t reg, uint8_t value);
 
 /**
- * @brief Writes multiple bytes to the specified register
+ * @brief Writes multiple bytes to the specified register (one SPI burst)
  */
 void PCD_WriteNRegister(MFRC522Ptr_t mfrc, uint8_t reg, uint8_t count, uint8_t *values);
 
@@ -306,10 +341,16 @@ void PCD_WriteNRegister(MFRC522Ptr_t mfrc, uint8_t reg, uint8_t count, uint8_t *
 uint8_t PCD_ReadRegister(MFRC522Ptr_t mfrc, uint8_t reg);
 
 /**
- * @brief Reads multiple bytes from the specified register
+ * @brief Reads multiple bytes from the specified register (one SPI burst,
+ * address streaming; at most MFRC522_FIFO_BYTES)
  */
 void PCD_ReadNRegister(MFRC522Ptr_t mfrc, uint8_t reg, uint8_t count, uint8_t *values, uint8_t rxAlign);
 
+/**
+ * @brief Reads a list of (possibly different) registers in one SPI burst
+ */
+void PCD_ReadRegisterList(MFRC522Ptr_t mfrc, const uint8_t *regs, uint8_t count, uint8_t *values);
+
 /**
  * @brief Sets the bits given in mask in the register
  */
@@ -349,6 +390,24 @@ static inline void cs_deselect(const uint cs) {
  */
 void PCD_Init(MFRC522Ptr_t mfrc, spi_inst_t *spi);
 
+/**
+ * @brief Routes command completion to pin IRQ (falling edge)
+ * @return false if the pin does not follow the chip (not wired); completion
+ * is then polled over SPI
+ */
+bool PCD_EnableIrq(MFRC522Ptr_t mfrc, uint irqPin, PCD_IrqCallback callback, void *context);
+
+/**
+ * @brief Sends all SPI traffic of the instance through a DMA transport
+ */
+void PCD_UseDma(MFRC522Ptr_t mfrc, spi_dma_t *dma);
+
+/**
+ * @brief Raises the SPI clock as far as maxHz while the link stays reliable
+ * @return The SPI clock in use, in Hz
+ */
+uint32_t PCD_SetSpiClock(MFRC522Ptr_t mfrc, uint32_t maxHz);
+
 /**
  * @brief Performs a soft reset on the MFRC522 chip
  */
@@ -399,6 +458,21 @@ StatusCode PCD_CommunicateWithPICC(MFRC522Ptr_t mfrc, uint8_t command, uint8_t w
                                     uint8_t *backLen, uint8_t *validBits, uint8_t rxAlign,
                                     bool checkCRC);
 
+/**
+ * @brief Loads the FIFO and starts a command without waiting for it
+ */
+StatusCode PCD_CommunicateStart(MFRC522Ptr_t mfrc, uint8_t command, uint8_t waitIRq,
+                                uint8_t *sendData, uint8_t sendLen, uint8_t txLastBits,
+                                uint8_t rxAlign);
+
+/**
+ * @brief Result of the command armed by PCD_CommunicateStart()
+ * @return STATUS_BUSY while it runs; with pin IRQ enabled this costs no SPI
+ * transfer until the chip raises the interrupt
+ */
+StatusCode PCD_CommunicatePoll(MFRC522Ptr_t mfrc, uint8_t *backData, uint8_t *backLen,
+                               uint8_t *validBits, bool checkCRC);
+
 /**
  * @brief Transmits a REQuest command, Type A
  */
@@ -415,6 +489,17 @@ StatusCode PICC_WakeupA(MFRC522Ptr_t mfrc, uint8_t *bufferATQA, uint8_t *bufferS
 StatusCode PICC_REQA_or_WUPA(MFRC522Ptr_t mfrc, uint8_t command, uint8_t *bufferATQA,
                               uint8_t *bufferSize);
 
+/**
+ * @brief Starts REQA or WUPA without waiting for the answer
+ */
+StatusCode PICC_REQA_or_WUPA_Start(MFRC522Ptr_t mfrc, uint8_t command);
+
+/**
+ * @brief ATQA of the REQA/WUPA started by PICC_REQA_or_WUPA_Start()
+ * @return STATUS_BUSY while waiting for the card or the chip timeout
+ */
+StatusCode PICC_REQA_or_WUPA_Poll(MFRC522Ptr_t mfrc, uint8_t *bufferATQA, uint8_t *bufferSize);
+
 /**
  * @brief Transmits SELECT/ANTICOLLISION commands to select a single PICC
  */
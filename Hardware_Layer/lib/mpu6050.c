@@ -1,9 +1,9 @@
 #include "mpu6050.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
+#include "agv_log.h"
 
-//Endereço I2C padrão do MPU6050
-static const uint8_t MPU6050_ADDR = 0x68;
+//Endereço I2C do MPU6050 (MPU6050_ADDR) vem de config.h
 
 //Registradores do MPU6050
 static const uint8_t REG_WHO_AM_I = 0x75;
@@ -20,88 +20,115 @@ static const uint8_t REG_PWR_MGMT_2 = 0x6C;
 //Fatores de sensibilidade (configuração padrão)
 //Aceleração: ±2g -> 16384 LSB/g
 //Giroscópio: ±250°/s -> 131 LSB/°/s
-static const float ACCEL_SENSITIVITY = 16384.0;
-static const float GYRO_SENSITIVITY = 131.0;
-static const float GRAVITY_MS2 = 9.81; //Aceleração da gravidade
+//
+//Conversão direta LSB -> Q16.16 com multiplicação inteira + deslocamento:
+//  valor_q16 = (raw * ESCALA) >> SHIFT
+//O produto cabe em 32 bits para qualquer raw de 16 bits.
+//Aceleração: 9.81 / 16384 * 65536 = 39.24   -> 39.24 * 256 = 10045 (>> 8)
+//Giroscópio: 65536 / 131         = 500.27  -> 500.27 * 64 = 32018 (>> 6)
+//Temperatura: 65536 / 340        = 192.75  -> 192.75 * 64 = 12336 (>> 6)
+#define ACCEL_SCALE_Q16     10045
+#define ACCEL_SCALE_SHIFT   8
+#define GYRO_SCALE_Q16      32018
+#define GYRO_SCALE_SHIFT    6
+#define TEMP_SCALE_Q16      12336
+#define TEMP_SCALE_SHIFT    6
+#define TEMP_OFFSET_Q16     Q16_CONST(36.53) //Offset do datasheet (°C)
+
+static inline q16_t mpu6050_scale(int16_t raw, int32_t scale, uint8_t shift) {
+    return ((int32_t)raw * scale) >> shift;
+}
+
+//Barramento em que o sensor está ligado
+static i2c_bus_t *i2c_bus;
+
+//Escreve um valor em um registrador; false se o sensor não confirmar
+static bool mpu6050_write_reg(uint8_t reg, uint8_t value) {
+    return i2c_bus_write_reg(i2c_bus, MPU6050_ADDR, reg, &value, 1);
+}
 
-//Ponteiro para instância I2C
-static i2c_inst_t *i2c_port;
+//Lê WHO_AM_I; false se o sensor não responder ou o valor for inesperado
+static bool mpu6050_who_am_i(uint8_t *who_am_i) {
+    if (!i2c_bus_read_reg(i2c_bus, MPU6050_ADDR, REG_WHO_AM_I, who_am_i, 1)) return false;
+    return *who_am_i == 0x68 || (*who_am_i >= 0x70 && *who_am_i <= 0x72);
+}
 
 //Reseta o MPU6050 e remove do modo de suspensão
 //Função interna chamada por mpu6050_init
-static void mpu6050_reset() {
-    uint8_t buf[2];
-    uint8_t who_am_i;
+static bool mpu6050_reset() {
+    uint8_t who_am_i = 0;
 
     //1. Verifica WHO_AM_I (deve retornar 0x68 ou 0x70-0x72)
-    buf[0] = REG_WHO_AM_I;
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 1, true);
-    i2c_read_blocking(i2c_port, MPU6050_ADDR, &who_am_i, 1, false);
-    printf("[MPU6050] WHO_AM_I = 0x%02X (esperado: 0x68)\n", who_am_i);
+    bool found = mpu6050_who_am_i(&who_am_i);
+    LOG_I(IMU, "[MPU6050] WHO_AM_I = 0x%02X (esperado: 0x68)\n", who_am_i);
+    if (!found) return false;
 
     //2. Reset completo do dispositivo
-    buf[0] = REG_PWR_MGMT_1;
-    buf[1] = 0x80; // Bit RESET
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 2, false);
+    if (!mpu6050_write_reg(REG_PWR_MGMT_1, 0x80)) return false; // Bit RESET
     sleep_ms(200); // Aguarda reset completo
 
     //3. Sai do modo sleep e seleciona clock
-    buf[0] = REG_PWR_MGMT_1;
-    buf[1] = 0x01; // Clock = PLL com referência do giroscópio X
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 2, false);
+    bool ok = mpu6050_write_reg(REG_PWR_MGMT_1, 0x01); // Clock = PLL com referência do giroscópio X
     sleep_ms(100);
 
     //4. CRÍTICO: Habilita TODOS os eixos (acelerômetro + giroscópio)
-    buf[0] = REG_PWR_MGMT_2;
-    buf[1] = 0x00; // Todos os eixos ativos
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 2, false);
+    ok = ok && mpu6050_write_reg(REG_PWR_MGMT_2, 0x00); // Todos os eixos ativos
     sleep_ms(50);
 
     //5. Configura Sample Rate Divider (1kHz / (1+0) = 1kHz)
-    buf[0] = REG_SMPLRT_DIV;
-    buf[1] = 0x00;
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 2, false);
-    sleep_ms(10);
+    ok = ok && mpu6050_write_reg(REG_SMPLRT_DIV, 0x00);
 
     //6. Configura filtro passa-baixa (DLPF = 6, bandwidth 5Hz)
-    buf[0] = REG_CONFIG;
-    buf[1] = 0x06;
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 2, false);
-    sleep_ms(10);
+    ok = ok && mpu6050_write_reg(REG_CONFIG, 0x06);
 
     //7. Configura giroscópio para ±250°/s (FS_SEL=0)
-    buf[0] = REG_GYRO_CONFIG;
-    buf[1] = 0x00;
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 2, false);
-    sleep_ms(10);
+    ok = ok && mpu6050_write_reg(REG_GYRO_CONFIG, 0x00);
 
     //8. Configura acelerômetro para ±2g (AFS_SEL=0)
-    buf[0] = REG_ACCEL_CONFIG;
-    buf[1] = 0x00;
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, buf, 2, false);
+    ok = ok && mpu6050_write_reg(REG_ACCEL_CONFIG, 0x00);
     sleep_ms(10);
 
-    printf("[MPU6050] Configuracao completa!\n");
+    if (ok) LOG_I(IMU, "[MPU6050] Configuracao completa!\n");
+    return ok;
 }
 
 //Inicializa o MPU6050
-//Parâmetro: i2c - Instância I2C a ser utilizada
-void mpu6050_init(i2c_inst_t *i2c) {
-    i2c_port = i2c;
-    mpu6050_reset();
-    printf("MPU6050 inicializado com sucesso.\n");
+//Parâmetro: bus - Barramento I2C em que o sensor está ligado
+bool mpu6050_init(i2c_bus_t *bus) {
+    i2c_bus = bus;
+    bool ok = mpu6050_reset();
+    if (ok) {
+        LOG_I(IMU, "MPU6050 inicializado com sucesso.\n");
+    } else {
+        LOG_W(IMU, "[MPU6050] Sensor nao respondeu na inicializacao\n");
+    }
+    return ok;
+}
+
+//Verifica se o sensor responde no barramento
+bool mpu6050_probe(void) {
+    uint8_t who_am_i;
+    return i2c_bus != NULL && mpu6050_who_am_i(&who_am_i);
 }
 
 //Lê e converte dados do sensor
 //Parâmetro: data - Ponteiro para estrutura de dados de saída
-void mpu6050_read_data(mpu6050_data_t *data) {
+//Em falha a estrutura não é alterada
+bool mpu6050_read_data(mpu6050_data_t *data) {
     uint8_t buffer[14];
-    
-    //Inicia leitura sequencial a partir do registrador de aceleração
-    uint8_t start_reg = REG_ACCEL_XOUT_H;
-    i2c_write_blocking(i2c_port, MPU6050_ADDR, &start_reg, 1, true); //Mantém controle do barramento
-    i2c_read_blocking(i2c_port, MPU6050_ADDR, buffer, 14, false);
 
+    //Leitura sequencial a partir do registrador de aceleração (repeated start)
+    if (!i2c_bus_read_reg(i2c_bus, MPU6050_ADDR, REG_ACCEL_XOUT_H, buffer, sizeof(buffer))) {
+        return false;
+    }
+
+    mpu6050_convert_raw(buffer, data);
+    return true;
+}
+
+//Converte o bloco de 14 bytes lido a partir de ACCEL_XOUT_H
+//Parâmetros: buffer - bytes brutos; data - estrutura de saída (Q16.16)
+void mpu6050_convert_raw(const uint8_t *buffer, mpu6050_data_t *data) {
     //Combina bytes high e low para formar valores brutos (int16_t)
     int16_t raw_ax = (buffer[0] << 8) | buffer[1];
     int16_t raw_ay = (buffer[2] << 8) | buffer[3];
@@ -112,20 +139,20 @@ void mpu6050_read_data(mpu6050_data_t *data) {
     int16_t raw_gz = (buffer[12] << 8) | buffer[13];
 
     //Debug: mostra valores brutos
-    printf("RAW -> AX:%d AY:%d AZ:%d TEMP:%d GX:%d GY:%d GZ:%d\n",
-           raw_ax, raw_ay, raw_az, raw_temp, raw_gx, raw_gy, raw_gz);
+    LOG_D(IMU, "RAW -> AX:%d AY:%d AZ:%d TEMP:%d GX:%d GY:%d GZ:%d\n",
+          raw_ax, raw_ay, raw_az, raw_temp, raw_gx, raw_gy, raw_gz);
 
-    //Conversão para unidades físicas
-    //Aceleração: LSB -> g -> m/s²
-    data->accel_x = (raw_ax / ACCEL_SENSITIVITY) * GRAVITY_MS2;
-    data->accel_y = (raw_ay / ACCEL_SENSITIVITY) * GRAVITY_MS2;
-    data->accel_z = (raw_az / ACCEL_SENSITIVITY) * GRAVITY_MS2;
+    //Conversão para unidades físicas (Q16.16)
+    //Aceleração: LSB -> m/s²
+    data->accel_x = mpu6050_scale(raw_ax, ACCEL_SCALE_Q16, ACCEL_SCALE_SHIFT);
+    data->accel_y = mpu6050_scale(raw_ay, ACCEL_SCALE_Q16, ACCEL_SCALE_SHIFT);
+    data->accel_z = mpu6050_scale(raw_az, ACCEL_SCALE_Q16, ACCEL_SCALE_SHIFT);
 
     //Giroscópio: LSB -> °/s
-    data->gyro_x = raw_gx / GYRO_SENSITIVITY;
-    data->gyro_y = raw_gy / GYRO_SENSITIVITY;
-    data->gyro_z = raw_gz / GYRO_SENSITIVITY;
+    data->gyro_x = mpu6050_scale(raw_gx, GYRO_SCALE_Q16, GYRO_SCALE_SHIFT);
+    data->gyro_y = mpu6050_scale(raw_gy, GYRO_SCALE_Q16, GYRO_SCALE_SHIFT);
+    data->gyro_z = mpu6050_scale(raw_gz, GYRO_SCALE_Q16, GYRO_SCALE_SHIFT);
 
-    //Temperatura: fórmula correta do datasheet MPU6050
-    data->temp_c = (raw_temp / 340.0) + 36.53;
+    //Temperatura: raw / 340 + 36.53 (datasheet MPU6050)
+    data->temp_c = mpu6050_scale(raw_temp, TEMP_SCALE_Q16, TEMP_SCALE_SHIFT) + TEMP_OFFSET_Q16;
 }
\ No newline at end of file
@@ -1,22 +1,30 @@
 #ifndef MPU6050_H
 #define MPU6050_H
-#include "hardware/i2c.h"
+#include <stdbool.h>
+#include "i2c_bus.h"
+#include "fixed_point.h"
 
-//Estrutura para armazenar dados convertidos do sensor
+//Estrutura para armazenar dados convertidos do sensor (Q16.16, ver fixed_point.h)
 typedef struct {
-    float accel_x; //Aceleração no eixo X (m/s²)
-    float accel_y; //Aceleração no eixo Y (m/s²)
-    float accel_z; //Aceleração no eixo Z (m/s²)
-    float gyro_x;  //Velocidade angular no eixo X (°/s)
-    float gyro_y;  //Velocidade angular no eixo Y (°/s)
-    float gyro_z;  //Velocidade angular no eixo Z (°/s)
-    float temp_c;  //Temperatura (°C)
+    q16_t accel_x; //Aceleração no eixo X (m/s²)
+    q16_t accel_y; //Aceleração no eixo Y (m/s²)
+    q16_t accel_z; //Aceleração no eixo Z (m/s²)
+    q16_t gyro_x;  //Velocidade angular no eixo X (°/s)
+    q16_t gyro_y;  //Velocidade angular no eixo Y (°/s)
+    q16_t gyro_z;  //Velocidade angular no eixo Z (°/s)
+    q16_t temp_c;  //Temperatura (°C)
 } mpu6050_data_t;
 
 //Inicializa o sensor MPU6050
-void mpu6050_init(i2c_inst_t *i2c); //Configura registradores e ativa o dispositivo
+bool mpu6050_init(i2c_bus_t *bus); //Configura registradores e ativa o dispositivo; false se não responder
+
+//Verifica se o sensor responde (WHO_AM_I)
+bool mpu6050_probe(void);
 
 //Lê e converte dados do sensor
-void mpu6050_read_data(mpu6050_data_t *data); //Preenche a estrutura com dados calibrados
+bool mpu6050_read_data(mpu6050_data_t *data); //Preenche a estrutura com dados calibrados; false em falha
+
+//Converte 14 bytes brutos (ACCEL_XOUT_H..GYRO_ZOUT_L) para unidades físicas
+void mpu6050_convert_raw(const uint8_t *buffer, mpu6050_data_t *data); //Apenas inteiros
 
 #endif //MPU6050_H
\ No newline at end of file
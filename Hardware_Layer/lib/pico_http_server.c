@@ -1,4 +1,5 @@
 #include "pico_http_server.h"
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -11,50 +12,190 @@ static int handler_count = 0;
 static const char *homepage_content = NULL;
 static http_content_type_t response_content_type = HTTP_CONTENT_TYPE_HTML;
 
-// Estrutura para gerenciar o estado da conexão
-struct http_state
+#define HTTP_HEADER_MAX 160
+#define HTTP_POLL_INTERVAL 2 // Ciclos do timer lento do TCP (~0,5 s cada)
+
+// Estado de uma conexão: cabeçalho montado aqui, corpo apontando para a
+// homepage (persistente) ou para a cópia da resposta do handler
+typedef struct
+{
+    struct tcp_pcb *pcb; // NULL = slot livre
+    const char *body;
+    size_t body_len;
+    size_t total;  // Cabeçalho + corpo
+    size_t queued; // Entregues ao tcp_write
+    size_t acked;  // Confirmados pelo cliente
+    uint16_t header_len;
+    uint8_t idle_polls;
+    char header[HTTP_HEADER_MAX];
+    char body_buf[HTTP_SERVER_BODY_MAX];
+} http_conn_t;
+
+// Pool fixo de conexões: sem malloc por requisição
+static http_conn_t conns[HTTP_SERVER_MAX_CONNECTIONS];
+static http_server_stats_t stats;
+
+// Requisição recebida (só durante o callback de recepção)
+static char request[HTTP_SERVER_REQUEST_MAX];
+
+static const char http_503[] =
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Retry-After: 1\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+
+static http_conn_t *http_conn_alloc(struct tcp_pcb *pcb)
 {
-    char response[16384]; // Tamanho do buffer de resposta
-    size_t len;
-    size_t sent;
-};
+    for (int i = 0; i < HTTP_SERVER_MAX_CONNECTIONS; i++)
+    {
+        if (conns[i].pcb == NULL)
+        {
+            memset(&conns[i], 0, offsetof(http_conn_t, header));
+            conns[i].pcb = pcb;
+            stats.active++;
+            if (stats.active > stats.high_water)
+            {
+                stats.high_water = stats.active;
+            }
+            return &conns[i];
+        }
+    }
+    return NULL;
+}
 
-// Callback para enviar dados após a escrita
-static err_t http_sent_callback(void *arg, struct tcp_pcb *tpcb, u16_t len)
+static void http_conn_free(http_conn_t *conn)
 {
-    struct http_state *hs = (struct http_state *)arg;
-    hs->sent += len;
-    if (hs->sent >= hs->len)
+    if (conn->pcb != NULL)
     {
-        tcp_close(tpcb);
-        free(hs);
+        conn->pcb = NULL;
+        stats.active--;
+    }
+}
+
+// Desliga os callbacks e fecha; se o lwIP não tiver memória para o FIN,
+// aborta (retorna ERR_ABRT, que deve ser repassado ao lwIP pelo callback)
+static err_t http_conn_close(http_conn_t *conn)
+{
+    struct tcp_pcb *pcb = conn->pcb;
+    err_t err = ERR_OK;
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK)
+    {
+        tcp_abort(pcb);
+        err = ERR_ABRT;
+    }
+    http_conn_free(conn);
+    return err;
+}
+
+// Entrega ao TCP o quanto couber no buffer de envio; o restante segue nos
+// callbacks de envio/poll
+static void http_conn_send(http_conn_t *conn)
+{
+    while (conn->queued < conn->total)
+    {
+        u16_t space = tcp_sndbuf(conn->pcb);
+        if (space == 0)
+        {
+            break;
+        }
+
+        const char *data;
+        size_t len;
+        if (conn->queued < conn->header_len)
+        {
+            data = conn->header + conn->queued;
+            len = conn->header_len - conn->queued;
+        }
+        else
+        {
+            data = conn->body + (conn->queued - conn->header_len);
+            len = conn->total - conn->queued;
+        }
+        if (len > space)
+        {
+            len = space;
+        }
+
+        u8_t flags = TCP_WRITE_FLAG_COPY;
+        if (conn->queued + len < conn->total)
+        {
+            flags |= TCP_WRITE_FLAG_MORE;
+        }
+        if (tcp_write(conn->pcb, data, (u16_t)len, flags) != ERR_OK)
+        {
+            break; // Sem memória: tenta de novo no próximo callback
+        }
+        conn->queued += len;
+    }
+    tcp_output(conn->pcb);
+}
+
+// Monta cabeçalho e corpo da resposta
+static void http_conn_respond(http_conn_t *conn, const char *status, const char *content_type,
+                              const char *body, size_t body_len)
+{
+    int n;
+    if (content_type != NULL)
+    {
+        n = snprintf(conn->header, sizeof(conn->header),
+                     "HTTP/1.1 %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %u\r\n"
+                     "Connection: close\r\n\r\n",
+                     status, content_type, (unsigned)body_len);
+    }
+    else
+    {
+        n = snprintf(conn->header, sizeof(conn->header),
+                     "HTTP/1.1 %s\r\n"
+                     "Content-Length: %u\r\n"
+                     "Connection: close\r\n\r\n",
+                     status, (unsigned)body_len);
+    }
+    conn->header_len = (uint16_t)n;
+    conn->body = body;
+    conn->body_len = body_len;
+    conn->total = conn->header_len + body_len;
+}
+
+static const char *http_content_type_str(http_content_type_t type)
+{
+    switch (type)
+    {
+    case HTTP_CONTENT_TYPE_JSON:
+        return "application/json";
+    case HTTP_CONTENT_TYPE_PLAIN:
+        return "text/plain";
+    case HTTP_CONTENT_TYPE_HTML:
+    default:
+        return "text/html";
     }
-    return ERR_OK;
 }
 
 // Roteador de requisições
-static void handle_request(struct http_state *hs, const char *req_line)
+static void handle_request(http_conn_t *conn, const char *req_line)
 {
-    char *path_end = strchr(req_line, ' ');
+    const char *path_end = strchr(req_line, ' ');
     if (path_end == NULL)
     {
-        hs->len = snprintf(hs->response, sizeof(hs->response), "HTTP/1.1 400 Bad Request\r\n\r\n");
+        http_conn_respond(conn, "400 Bad Request", NULL, NULL, 0);
         return;
     }
     size_t path_len = path_end - req_line;
     char path[path_len + 1];
-    strncpy(path, req_line, path_len);
+    memcpy(path, req_line, path_len);
     path[path_len] = '\0';
 
     if ((strcmp(path, "/") == 0) && homepage_content)
     {
-        hs->len = snprintf(hs->response, sizeof(hs->response),
-                           "HTTP/1.1 200 OK\r\n"
-                           "Content-Type: text/html\r\n"
-                           "Content-Length: %d\r\n"
-                           "Connection: close\r\n\r\n%s",
-                           (int)strlen(homepage_content), homepage_content);
-
+        // A homepage é persistente: enviada direto, sem cópia
+        http_conn_respond(conn, "200 OK", "text/html", homepage_content, strlen(homepage_content));
         return;
     }
 
@@ -64,69 +205,137 @@ static void handle_request(struct http_state *hs, const char *req_line)
         if (strstr(path, handlers[i].path) && handlers[i].handler)
         {
             const char *content = handlers[i].handler(req_line);
-            const char *content_type_str;
-            switch (response_content_type)
+            size_t len = content ? strlen(content) : 0;
+            if (content == NULL || len > sizeof(conn->body_buf))
             {
-            case HTTP_CONTENT_TYPE_JSON:
-                content_type_str = "application/json";
-                break;
-            case HTTP_CONTENT_TYPE_PLAIN:
-                content_type_str = "text/plain";
-                break;
-            case HTTP_CONTENT_TYPE_HTML:
-            default:
-                content_type_str = "text/html";
-                break;
+                http_conn_respond(conn, "500 Internal Server Error", NULL, NULL, 0);
+                return;
             }
-            hs->len = snprintf(hs->response, sizeof(hs->response),
-                               "HTTP/1.1 200 OK\r\n"
-                               "Content-Type: %s\r\n"
-                               "Content-Length: %d\r\n"
-                               "Connection: close\r\n\r\n%s",
-                               content_type_str, (int)strlen(content), content);
+            // Cópia: o handler pode reusar o buffer na próxima requisição
+            memcpy(conn->body_buf, content, len);
+            http_conn_respond(conn, "200 OK", http_content_type_str(response_content_type),
+                              conn->body_buf, len);
             return;
         }
     }
 
     // Chegará até aqui se nenhum handler for encontrado
-    hs->len = snprintf(hs->response, sizeof(hs->response), "HTTP/1.1 404 Not Found\r\n\r\n");
+    http_conn_respond(conn, "404 Not Found", NULL, NULL, 0);
+}
+
+// Callback de confirmação de envio: continua a resposta ou fecha
+static err_t http_sent_callback(void *arg, struct tcp_pcb *tpcb, u16_t len)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+    conn->acked += len;
+    conn->idle_polls = 0;
+    if (conn->acked >= conn->total)
+    {
+        return http_conn_close(conn);
+    }
+    http_conn_send(conn);
+    return ERR_OK;
 }
 
 // Callback principal de recepção de dados
 static err_t http_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
 {
+    http_conn_t *conn = (http_conn_t *)arg;
+
     if (!p)
     {
-        tcp_close(tpcb);
+        // Cliente fechou
+        return http_conn_close(conn);
+    }
+    tcp_recved(tpcb, p->tot_len);
+
+    // Só a primeira parte da requisição é tratada (linha de requisição)
+    if (conn->total > 0)
+    {
+        pbuf_free(p);
         return ERR_OK;
     }
 
-    struct http_state *hs = (struct http_state *)malloc(sizeof(struct http_state));
-    hs->sent = 0;
+    u16_t n = pbuf_copy_partial(p, request, sizeof(request) - 1, 0);
+    request[n] = '\0';
+    pbuf_free(p);
 
-    char *req = (char *)p->payload;
-    if (strstr(req, "GET ") == req)
+    if (strncmp(request, "GET ", 4) == 0)
     {
-        req += 4; // Avança o ponteiro após "GET "
-        handle_request(hs, req);
+        handle_request(conn, request + 4); // Avança o ponteiro após "GET "
     }
     else
     {
-        hs->len = snprintf(hs->response, sizeof(hs->response), "HTTP/1.1 405 Method Not Allowed\r\n\r\n");
+        http_conn_respond(conn, "405 Method Not Allowed", NULL, NULL, 0);
     }
 
-    tcp_arg(tpcb, hs);
-    tcp_sent(tpcb, http_sent_callback);
-    tcp_write(tpcb, hs->response, hs->len, TCP_WRITE_FLAG_COPY);
-    tcp_output(tpcb);
-    pbuf_free(p);
+    conn->idle_polls = 0;
+    http_conn_send(conn);
     return ERR_OK;
 }
 
+// Conexão parada (cliente que não envia nem confirma): fecha por timeout;
+// também retoma um envio que ficou sem buffer
+static err_t http_poll_callback(void *arg, struct tcp_pcb *tpcb)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+    if (conn == NULL)
+    {
+        return ERR_OK;
+    }
+    if (++conn->idle_polls > HTTP_SERVER_IDLE_POLLS)
+    {
+        stats.timeouts++;
+        return http_conn_close(conn);
+    }
+    if (conn->queued < conn->total)
+    {
+        http_conn_send(conn);
+    }
+    return ERR_OK;
+}
+
+// Erro fatal na conexão: o lwIP já liberou o pcb, só libera o slot
+static void http_err_callback(void *arg, err_t err)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+    stats.errors++;
+    if (conn != NULL)
+    {
+        conn->pcb = NULL;
+        stats.active--;
+    }
+}
+
 // Callback de nova conexão
 static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err)
 {
+    if (err != ERR_OK || newpcb == NULL)
+    {
+        return ERR_VAL;
+    }
+
+    http_conn_t *conn = http_conn_alloc(newpcb);
+    if (conn == NULL)
+    {
+        // Pool cheio: 503 (estático, sem cópia) e fecha após o envio
+        stats.rejected++;
+        tcp_write(newpcb, http_503, sizeof(http_503) - 1, 0);
+        tcp_output(newpcb);
+        if (tcp_close(newpcb) != ERR_OK)
+        {
+            tcp_abort(newpcb);
+            return ERR_ABRT;
+        }
+        return ERR_OK;
+    }
+
+    stats.accepted++;
+    tcp_arg(newpcb, conn);
     tcp_recv(newpcb, http_recv_callback);
+    tcp_sent(newpcb, http_sent_callback);
+    tcp_err(newpcb, http_err_callback);
+    tcp_poll(newpcb, http_poll_callback, HTTP_POLL_INTERVAL);
     return ERR_OK;
 }
 
@@ -176,6 +385,11 @@ void http_server_set_content_type(http_content_type_t type)
     response_content_type = type;
 }
 
+const http_server_stats_t *http_server_get_stats(void)
+{
+    return &stats;
+}
+
 void http_server_parse_float_param(const char *req, const char *param, float *value)
 {
     char *found = strstr(req, param);
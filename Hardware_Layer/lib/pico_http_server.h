@@ -6,6 +6,31 @@
 #include "lwip/err.h"
 #include "lwip/tcp.h"
 
+// Pool fixo de conexões (podem ser redefinidos antes de incluir este header)
+#ifndef HTTP_SERVER_MAX_CONNECTIONS
+#define HTTP_SERVER_MAX_CONNECTIONS 4 // Conexões simultâneas; as demais recebem 503
+#endif
+#ifndef HTTP_SERVER_BODY_MAX
+#define HTTP_SERVER_BODY_MAX 2048 // Maior resposta de handler (acima: 500)
+#endif
+#ifndef HTTP_SERVER_REQUEST_MAX
+#define HTTP_SERVER_REQUEST_MAX 256 // Início da requisição repassado aos handlers
+#endif
+#ifndef HTTP_SERVER_IDLE_POLLS
+#define HTTP_SERVER_IDLE_POLLS 10 // Polls (~1 s cada) sem tráfego antes de fechar
+#endif
+
+// Estatísticas do pool de conexões
+typedef struct
+{
+    uint16_t active;     // Conexões abertas agora
+    uint16_t high_water; // Máximo de conexões abertas ao mesmo tempo
+    uint32_t accepted;
+    uint32_t rejected;   // Recusadas com 503 (pool cheio)
+    uint32_t timeouts;   // Fechadas por inatividade
+    uint32_t errors;     // Encerradas por erro do TCP (reset, falta de memória)
+} http_server_stats_t;
+
 // Enumeração para o tipo de conteúdo da resposta HTTP
 typedef enum
 {
@@ -62,6 +87,17 @@ void http_server_register_handler(http_request_handler_t handler);
  */
 void http_server_set_content_type(http_content_type_t type);
 
+/**
+ * @brief Retorna as estatísticas do pool de conexões.
+ *
+ * Cada conexão ocupa um slot fixo (sem malloc) até a resposta ser confirmada,
+ * o cliente fechar, um erro do TCP ou HTTP_SERVER_IDLE_POLLS sem tráfego. Com
+ * todos os slots ocupados, novas conexões recebem 503 e são fechadas.
+ *
+ * @return Ponteiro para as estatísticas (atualizadas pelos callbacks do lwIP).
+ */
+const http_server_stats_t *http_server_get_stats(void);
+
 /**
  * @brief Extrai um valor float de um parâmetro em uma string de requisição HTTP GET.
  *
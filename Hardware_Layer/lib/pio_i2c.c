@@ -0,0 +1,443 @@
+#include "pio_i2c.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "i2c.pio.h"
+#include "../config.h"
+
+// Campos da palavra enviada ao TX FIFO (ver lib/i2c.pio)
+#define PIO_I2C_ICOUNT_LSB  10
+#define PIO_I2C_FINAL_LSB   9
+#define PIO_I2C_DATA_LSB    1
+#define PIO_I2C_NAK_LSB     0
+
+// Ciclos da state machine por bit (soma dos atrasos do bitloop)
+#define PIO_I2C_CYCLES_PER_BIT  32
+
+// Maior transferência: START, endereço, índice, repeated start, endereço, leitura, STOP
+#define PIO_I2C_MAX_SEGS    7
+
+// Programa já carregado em cada bloco PIO (compartilhado pelas state machines)
+static bool program_loaded[NUM_PIOS];
+static uint program_offset[NUM_PIOS];
+
+// Condições do barramento montadas com a tabela set_scl_sda
+static const uint8_t seq_start[] = {I2C_SC1_SD0, I2C_SC0_SD0};
+static const uint8_t seq_stop[] = {I2C_SC0_SD0, I2C_SC1_SD0, I2C_SC1_SD1};
+static const uint8_t seq_repstart[] = {I2C_SC0_SD1, I2C_SC1_SD1, I2C_SC1_SD0, I2C_SC0_SD0};
+
+typedef enum {
+    PIO_I2C_SEG_START,
+    PIO_I2C_SEG_REPSTART,
+    PIO_I2C_SEG_STOP,
+    PIO_I2C_SEG_ADDR,       // Endereço + R/W
+    PIO_I2C_SEG_WRITE,
+    PIO_I2C_SEG_READ,
+} pio_i2c_seg_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t addr_rw;        // PIO_I2C_SEG_ADDR: (addr << 1) | R/W
+    uint16_t len;           // PIO_I2C_SEG_WRITE / PIO_I2C_SEG_READ
+} pio_i2c_seg_t;
+
+// Uma transferência completa em uma state machine, alimentada aos poucos
+typedef struct {
+    pio_i2c_t *port;
+    pio_i2c_seg_t segs[PIO_I2C_MAX_SEGS];
+    uint8_t nsegs;
+    uint8_t seg;            // Segmento sendo enviado
+    uint16_t pos;           // Palavra dentro do segmento
+    const uint8_t *src;     // Bytes do segmento de escrita
+    uint8_t *dst;           // Destino do segmento de leitura
+    uint16_t rx_skip;       // Bytes no RX FIFO antes da leitura (endereço/escritas)
+    uint16_t rx_total;      // Cada byte no barramento gera um byte no RX FIFO
+    uint16_t rx_count;
+    uint16_t len;           // Bytes de dados (retorno em caso de sucesso)
+    bool nostop;
+    bool done;
+    int result;
+} pio_i2c_job_t;
+
+// --- Funções Internas ---
+
+static inline uint32_t pio_i2c_stall_mask(const pio_i2c_t *port) {
+    return 1u << (PIO_FDEBUG_TXSTALL_LSB + port->sm);
+}
+
+// Escrita de 16 bits: a palavra fica inteira no OSR (autopull com limiar 16)
+static inline void pio_i2c_put16(pio_i2c_t *port, uint16_t word) {
+    *(io_rw_16 *)&port->pio->txf[port->sm] = word;
+}
+
+static uint pio_i2c_seg_words(const pio_i2c_seg_t *seg) {
+    switch (seg->type) {
+        // Cabeçalho + instruções
+        case PIO_I2C_SEG_START:    return sizeof(seq_start) + 1;
+        case PIO_I2C_SEG_REPSTART: return sizeof(seq_repstart) + 1;
+        case PIO_I2C_SEG_STOP:     return sizeof(seq_stop) + 1;
+        case PIO_I2C_SEG_ADDR:     return 1;
+        default:                   return seg->len;
+    }
+}
+
+// Palavra de uma condição: cabeçalho com a contagem e depois as instruções
+static uint16_t pio_i2c_seq_word(const uint8_t *seq, uint len, uint pos) {
+    if (pos == 0) return (uint16_t)((len - 1) << PIO_I2C_ICOUNT_LSB);
+    return set_scl_sda_program_instructions[seq[pos - 1]];
+}
+
+static uint16_t pio_i2c_job_word(const pio_i2c_job_t *job) {
+    const pio_i2c_seg_t *seg = &job->segs[job->seg];
+    bool last = (job->pos + 1u == seg->len);
+
+    switch (seg->type) {
+        case PIO_I2C_SEG_START:
+            return pio_i2c_seq_word(seq_start, sizeof(seq_start), job->pos);
+        case PIO_I2C_SEG_REPSTART:
+            return pio_i2c_seq_word(seq_repstart, sizeof(seq_repstart), job->pos);
+        case PIO_I2C_SEG_STOP:
+            return pio_i2c_seq_word(seq_stop, sizeof(seq_stop), job->pos);
+        case PIO_I2C_SEG_ADDR:
+            // NAK no endereço = dispositivo ausente (erro)
+            return (uint16_t)((seg->addr_rw << PIO_I2C_DATA_LSB) | (1u << PIO_I2C_NAK_LSB));
+        case PIO_I2C_SEG_WRITE:
+            // SDA solto no ACK; NAK no último byte é ignorado
+            return (uint16_t)((job->src[job->pos] << PIO_I2C_DATA_LSB) | (1u << PIO_I2C_NAK_LSB) |
+                              (last ? (1u << PIO_I2C_FINAL_LSB) : 0));
+        default:
+            // Leitura: SDA solto nos dados; ACK em todos os bytes menos o último
+            return (uint16_t)((0xFFu << PIO_I2C_DATA_LSB) |
+                              (last ? (1u << PIO_I2C_FINAL_LSB) | (1u << PIO_I2C_NAK_LSB) : 0));
+    }
+}
+
+static void pio_i2c_job_add(pio_i2c_job_t *job, pio_i2c_seg_type_t type, uint8_t addr_rw, uint16_t len) {
+    pio_i2c_seg_t *seg = &job->segs[job->nsegs++];
+    seg->type = type;
+    seg->addr_rw = addr_rw;
+    seg->len = len;
+
+    if (type == PIO_I2C_SEG_READ) job->rx_skip = job->rx_total;
+    if (type == PIO_I2C_SEG_ADDR) job->rx_total++;
+    if (type == PIO_I2C_SEG_WRITE || type == PIO_I2C_SEG_READ) job->rx_total += len;
+}
+
+// Início da transferência: START, ou repeated start depois de um nostop
+static void pio_i2c_job_begin(pio_i2c_job_t *job, pio_i2c_t *port) {
+    job->port = port;
+    job->nsegs = 0;
+    job->seg = 0;
+    job->pos = 0;
+    job->src = NULL;
+    job->dst = NULL;
+    job->rx_skip = 0;
+    job->rx_total = 0;
+    job->rx_count = 0;
+    job->len = 0;
+    job->nostop = false;
+    job->done = false;
+    job->result = PICO_ERROR_GENERIC;
+    pio_i2c_job_add(job, port->in_transaction ? PIO_I2C_SEG_REPSTART : PIO_I2C_SEG_START, 0, 0);
+}
+
+static void pio_i2c_job_write(pio_i2c_job_t *job, uint8_t addr, const uint8_t *src, size_t len) {
+    pio_i2c_job_add(job, PIO_I2C_SEG_ADDR, (uint8_t)(addr << 1), 0);
+    pio_i2c_job_add(job, PIO_I2C_SEG_WRITE, 0, (uint16_t)len);
+    job->src = src;
+    job->len = (uint16_t)len;
+}
+
+static void pio_i2c_job_read(pio_i2c_job_t *job, uint8_t addr, uint8_t *dst, size_t len) {
+    pio_i2c_job_add(job, PIO_I2C_SEG_ADDR, (uint8_t)((addr << 1) | 1u), 0);
+    pio_i2c_job_add(job, PIO_I2C_SEG_READ, 0, (uint16_t)len);
+    job->dst = dst;
+    job->len = (uint16_t)len;
+}
+
+static void pio_i2c_job_end(pio_i2c_job_t *job, bool nostop) {
+    job->nostop = nostop;
+    if (!nostop) pio_i2c_job_add(job, PIO_I2C_SEG_STOP, 0, 0);
+}
+
+// Reinicia a state machine do zero com as linhas soltas (timeout)
+static void pio_i2c_sm_reset(pio_i2c_t *port) {
+    PIO pio = port->pio;
+    uint sm = port->sm;
+
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(port->offset + i2c_offset_entry_point));
+    pio_interrupt_clear(pio, sm);
+    // OE invertido: pindir 1 = linha solta
+    uint32_t both_pins = (1u << port->sda) | (1u << (port->sda + 1));
+    pio_sm_set_pindirs_with_mask(pio, sm, both_pins, both_pins);
+    pio_sm_set_enabled(pio, sm, true);
+    port->in_transaction = false;
+}
+
+// Espera a state machine esvaziar o TX FIFO (com limite de tempo)
+static bool pio_i2c_wait_idle(pio_i2c_t *port, uint32_t timeout_us) {
+    uint32_t start = time_us_32();
+    port->pio->fdebug = pio_i2c_stall_mask(port);
+    while (!(port->pio->fdebug & pio_i2c_stall_mask(port))) {
+        if (pio_interrupt_get(port->pio, port->sm) || time_us_32() - start > timeout_us) return false;
+        tight_loop_contents();
+    }
+    return true;
+}
+
+// NAK: descarta o resto da transferência e encerra com STOP
+static void pio_i2c_abort(pio_i2c_t *port) {
+    PIO pio = port->pio;
+    uint sm = port->sm;
+
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(port->offset + i2c_offset_entry_point));
+    pio_interrupt_clear(pio, sm);
+
+    pio_i2c_put16(port, (uint16_t)((sizeof(seq_stop) - 1) << PIO_I2C_ICOUNT_LSB));
+    for (uint i = 0; i < sizeof(seq_stop); i++) {
+        pio_i2c_put16(port, set_scl_sda_program_instructions[seq_stop[i]]);
+    }
+    port->in_transaction = false;
+    if (!pio_i2c_wait_idle(port, I2C_BUS_TIMEOUT_BASE_US)) pio_i2c_sm_reset(port);
+}
+
+// Um passo sem bloquear: envia o que couber no TX FIFO e recolhe o RX FIFO.
+// Retorna true quando a transferência terminou (com ou sem erro).
+static bool pio_i2c_job_step(pio_i2c_job_t *job) {
+    pio_i2c_t *port = job->port;
+    PIO pio = port->pio;
+    uint sm = port->sm;
+
+    if (pio_interrupt_get(pio, sm)) {
+        pio_i2c_abort(port);
+        job->result = PICO_ERROR_GENERIC;
+        return true;
+    }
+
+    while (job->seg < job->nsegs && !pio_sm_is_tx_fifo_full(pio, sm)) {
+        pio_i2c_put16(port, pio_i2c_job_word(job));
+        if (++job->pos >= pio_i2c_seg_words(&job->segs[job->seg])) {
+            job->seg++;
+            job->pos = 0;
+            // Última palavra enviada: a partir daqui o "TX parado" indica o fim
+            if (job->seg == job->nsegs) pio->fdebug = pio_i2c_stall_mask(port);
+        }
+    }
+
+    while (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+        uint8_t byte = (uint8_t)pio_sm_get(pio, sm);
+        if (job->rx_count >= job->rx_skip && job->rx_count < job->rx_skip + job->len && job->dst) {
+            job->dst[job->rx_count - job->rx_skip] = byte;
+        }
+        job->rx_count++;
+    }
+
+    if (job->seg < job->nsegs || job->rx_count < job->rx_total) return false;
+    if (!(pio->fdebug & pio_i2c_stall_mask(port))) return false;
+
+    port->in_transaction = job->nostop;
+    job->result = job->len;
+    return true;
+}
+
+// Executa as transferências (uma por state machine) até todas terminarem.
+// As state machines trabalham ao mesmo tempo; o processador só alimenta os FIFOs.
+static void pio_i2c_run(pio_i2c_job_t jobs[], size_t count) {
+    uint32_t max_bytes = 0;
+    size_t pending = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (jobs[i].port->pio == NULL) {
+            jobs[i].done = true;
+            continue;
+        }
+        if (jobs[i].rx_total > max_bytes) max_bytes = jobs[i].rx_total;
+        pending++;
+    }
+
+    uint32_t timeout_us = I2C_BUS_TIMEOUT_BASE_US + max_bytes * I2C_BUS_TIMEOUT_PER_BYTE_US;
+    uint32_t start = time_us_32();
+
+    while (pending > 0) {
+        for (size_t i = 0; i < count; i++) {
+            if (jobs[i].done) continue;
+            if (pio_i2c_job_step(&jobs[i])) {
+                jobs[i].done = true;
+                pending--;
+            }
+        }
+
+        if (pending > 0 && time_us_32() - start > timeout_us) {
+            // Escravo segurando SCL (clock stretching sem fim) ou linha presa
+            for (size_t i = 0; i < count; i++) {
+                if (jobs[i].done) continue;
+                pio_i2c_sm_reset(jobs[i].port);
+                jobs[i].result = PICO_ERROR_TIMEOUT;
+                jobs[i].done = true;
+            }
+            pending = 0;
+        }
+    }
+}
+
+static int pio_i2c_write(i2c_bus_t *bus, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    pio_i2c_job_t job;
+
+    pio_i2c_job_begin(&job, (pio_i2c_t *)bus->ctx);
+    pio_i2c_job_write(&job, addr, src, len);
+    pio_i2c_job_end(&job, nostop);
+    pio_i2c_run(&job, 1);
+    return job.result;
+}
+
+static int pio_i2c_read(i2c_bus_t *bus, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    pio_i2c_job_t job;
+
+    pio_i2c_job_begin(&job, (pio_i2c_t *)bus->ctx);
+    pio_i2c_job_read(&job, addr, dst, len);
+    pio_i2c_job_end(&job, nostop);
+    pio_i2c_run(&job, 1);
+    return job.result;
+}
+
+// Índice + leitura com repeated start em cada barramento, todos no mesmo laço
+static void pio_i2c_read_reg_group(i2c_bus_t *const buses[], const uint8_t addrs[], uint8_t reg,
+                                   uint8_t *const dsts[], size_t len, int results[], size_t count) {
+    pio_i2c_job_t jobs[I2C_BUS_GROUP_MAX];
+
+    for (size_t i = 0; i < count; i++) {
+        pio_i2c_job_t *job = &jobs[i];
+        pio_i2c_job_begin(job, (pio_i2c_t *)buses[i]->ctx);
+        pio_i2c_job_write(job, addrs[i], &reg, 1);
+        pio_i2c_job_add(job, PIO_I2C_SEG_REPSTART, 0, 0);
+        pio_i2c_job_read(job, addrs[i], dsts[i], len);
+        pio_i2c_job_end(job, false);
+    }
+
+    pio_i2c_run(jobs, count);
+
+    for (size_t i = 0; i < count; i++) {
+        results[i] = jobs[i].result;
+    }
+}
+
+// Divisor de clock em 16.8 para PIO_I2C_CYCLES_PER_BIT ciclos por bit (sem float)
+static uint32_t pio_i2c_clkdiv_q8(uint32_t baudrate) {
+    uint64_t div = ((uint64_t)clock_get_hz(clk_sys) << 8) / ((uint64_t)PIO_I2C_CYCLES_PER_BIT * baudrate);
+    return div < (1u << 8) ? (1u << 8) : (uint32_t)div;
+}
+
+// Configura a state machine e os pinos (OE invertido: pindir 1 = solto)
+static void pio_i2c_sm_init(pio_i2c_t *port, uint sda, uint scl, uint32_t div_q8) {
+    PIO pio = port->pio;
+    uint sm = port->sm;
+    pio_sm_config c = i2c_program_get_default_config(port->offset);
+
+    sm_config_set_out_pins(&c, sda, 1);
+    sm_config_set_set_pins(&c, sda, 1);
+    sm_config_set_in_pins(&c, sda);
+    sm_config_set_sideset_pins(&c, scl);
+    sm_config_set_jmp_pin(&c, sda);
+    sm_config_set_out_shift(&c, false, true, 16);
+    sm_config_set_in_shift(&c, false, true, 8);
+    sm_config_set_clkdiv_int_frac(&c, (uint16_t)(div_q8 >> 8), (uint8_t)(div_q8 & 0xFF));
+
+    // Liga os pinos sem glitch: soltos (pull-up) até a state machine assumir
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    uint32_t both_pins = (1u << sda) | (1u << scl);
+    pio_sm_set_pins_with_mask(pio, sm, both_pins, both_pins);
+    pio_sm_set_pindirs_with_mask(pio, sm, both_pins, both_pins);
+    pio_gpio_init(pio, sda);
+    gpio_set_oeover(sda, GPIO_OVERRIDE_INVERT);
+    pio_gpio_init(pio, scl);
+    gpio_set_oeover(scl, GPIO_OVERRIDE_INVERT);
+    pio_sm_set_pins_with_mask(pio, sm, 0, both_pins);
+
+    // A IRQ da state machine é só flag de erro (sem interrupção no sistema)
+    pio_set_irq0_source_enabled(pio, (enum pio_interrupt_source)((uint)pis_interrupt0 + sm), false);
+    pio_set_irq1_source_enabled(pio, (enum pio_interrupt_source)((uint)pis_interrupt0 + sm), false);
+    pio_interrupt_clear(pio, sm);
+
+    pio_sm_init(pio, sm, port->offset + i2c_offset_entry_point, &c);
+    pio_sm_set_enabled(pio, sm, true);
+    port->in_transaction = false;
+}
+
+// State machine livre, de preferência num bloco que já tem o programa
+static bool pio_i2c_claim(pio_i2c_t *port) {
+    for (uint i = 0; i < NUM_PIOS; i++) {
+        if (!program_loaded[i]) continue;
+        PIO pio = pio_get_instance(i);
+        int sm = pio_claim_unused_sm(pio, false);
+        if (sm < 0) continue;
+
+        port->pio = pio;
+        port->sm = (uint)sm;
+        port->offset = program_offset[i];
+        return true;
+    }
+
+    PIO pio;
+    uint sm, offset;
+    if (!pio_claim_free_sm_and_add_program(&i2c_program, &pio, &sm, &offset)) return false;
+
+    program_loaded[pio_get_index(pio)] = true;
+    program_offset[pio_get_index(pio)] = offset;
+    port->pio = pio;
+    port->sm = sm;
+    port->offset = offset;
+    return true;
+}
+
+static bool pio_i2c_recover(i2c_bus_t *bus) {
+    pio_i2c_t *port = (pio_i2c_t *)bus->ctx;
+    if (port->pio == NULL) return false;
+
+    pio_sm_set_enabled(port->pio, port->sm, false);
+    bool released = i2c_bus_clear_lines(bus->sda, bus->scl);
+
+    // gpio_init desfez a função PIO e a inversão do OE: configura tudo de novo
+    pio_i2c_sm_init(port, bus->sda, bus->scl, pio_i2c_clkdiv_q8(bus->baudrate));
+    return released;
+}
+
+static const i2c_bus_ops_t pio_i2c_ops = {
+    .write = pio_i2c_write,
+    .read = pio_i2c_read,
+    .recover = pio_i2c_recover,
+    .read_reg_group = pio_i2c_read_reg_group,
+};
+
+// --- Funções Públicas (declaradas em pio_i2c.h) ---
+
+bool i2c_bus_init_pio(i2c_bus_t *bus, const char *name, pio_i2c_t *port,
+                      uint sda, uint scl, uint32_t baudrate) {
+    bus->ops = &pio_i2c_ops;
+    bus->ctx = port;
+    bus->name = name;
+    bus->sda = sda;
+    bus->scl = scl;
+    bus->transactions = 0;
+    bus->errors = 0;
+    bus->timeouts = 0;
+    bus->recoveries = 0;
+    bus->consecutive_errors = 0;
+
+    port->pio = NULL;
+    port->sda = sda;
+    port->in_transaction = false;
+    // O programa lê SCL como "pino de entrada 1" (SDA + 1)
+    if (scl != sda + 1 || !pio_i2c_claim(port)) {
+        bus->baudrate = 0;
+        return false;
+    }
+
+    uint32_t div_q8 = pio_i2c_clkdiv_q8(baudrate);
+    bus->baudrate = (uint32_t)(((uint64_t)clock_get_hz(clk_sys) << 8) / ((uint64_t)PIO_I2C_CYCLES_PER_BIT * div_q8));
+    pio_i2c_sm_init(port, sda, scl, div_q8);
+    return true;
+}
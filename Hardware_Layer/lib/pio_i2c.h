@@ -0,0 +1,37 @@
+#ifndef PIO_I2C_H
+#define PIO_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/pio.h"
+#include "i2c_bus.h"
+
+// =====================================================
+// Barramento I2C em PIO
+//
+// Mestre I2C numa state machine (lib/i2c.pio) exposto pela mesma interface
+// i2c_bus_t dos controladores de hardware: os drivers funcionam sem mudança
+// em qualquer barramento. Permite ligar dispositivos de mesmo endereço
+// (VL53L0X em 0x29) em barramentos separados, sem multiplexador.
+//
+// Cada barramento ocupa uma state machine; o programa é carregado uma vez
+// por bloco PIO e compartilhado. SCL deve ser SDA + 1. Transferências
+// isoladas bloqueiam como no hardware; i2c_bus_read_reg_group() alimenta
+// várias state machines no mesmo laço, e as leituras em barramentos PIO
+// diferentes correm ao mesmo tempo.
+// =====================================================
+
+typedef struct {
+    PIO pio;                // NULL = sem state machine (transferências falham)
+    uint sm;
+    uint offset;            // Endereço do programa no bloco PIO
+    uint sda;               // SCL = SDA + 1
+    bool in_transaction;    // Última transferência sem STOP: a próxima usa repeated start
+} pio_i2c_t;
+
+// Configura o barramento (state machine, GPIO com pull-up, clock). Retorna
+// false se não houver state machine ou memória de instruções livre.
+bool i2c_bus_init_pio(i2c_bus_t *bus, const char *name, pio_i2c_t *port,
+                      uint sda, uint scl, uint32_t baudrate);
+
+#endif // PIO_I2C_H
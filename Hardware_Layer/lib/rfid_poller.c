@@ -0,0 +1,310 @@
+#include "rfid_poller.h"
+#include <stdio.h>
+#include <string.h>
+#include "agv_log.h"
+
+#define RFID_WAIT_IRQ       0x30    // RxIRq | IdleIRq (fim do Transceive)
+#define RFID_MAX_CASCADE    3
+
+// Recarga do timer do MFRC522 (passos de 25 us, ver PCD_Init): 25 ms para os
+// comandos em geral; 1 ms para o HLTA, cuja resposta normal é o silêncio
+// (a tag tem ~1 ms para um NAK, ISO/IEC 14443-3)
+#define RFID_TIMER_DEFAULT  0x03E8
+#define RFID_TIMER_HALT     0x0028
+
+static const uint8_t sel_commands[RFID_MAX_CASCADE] = {
+    PICC_CMD_SEL_CL1, PICC_CMD_SEL_CL2, PICC_CMD_SEL_CL3
+};
+
+// --- Funções Internas ---
+
+// Verdadeiro se now_us já chegou em at_us (contadores de 32 bits dão a volta)
+static bool rfid_time_reached(uint32_t now_us, uint32_t at_us) {
+    return (int32_t)(now_us - at_us) >= 0;
+}
+
+static void rfid_poller_set_timer(rfid_poller_t *p, uint16_t reload) {
+    PCD_WriteRegister(p->mfrc, TReloadRegH, (uint8_t)(reload >> 8));
+    PCD_WriteRegister(p->mfrc, TReloadRegL, (uint8_t)reload);
+}
+
+static bool rfid_poller_uid_in(const Uid *list, uint8_t count, const Uid *uid) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (list[i].size == uid->size && memcmp(list[i].uidByte, uid->uidByte, uid->size) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fim do ciclo: o conjunto lido vira o inventário e o próximo é agendado
+static void rfid_poller_schedule(rfid_poller_t *p, uint32_t now_us) {
+    // Custo medido do ciclo: cada tag a mais soma SELECT, HLTA e um REQA
+    uint32_t cycle = now_us - p->cycle_us;
+    p->stats.cycle_last_us = cycle;
+    p->stats.cycle_last_tags = p->cycle_count;
+    if (cycle > p->stats.cycle_max_us) p->stats.cycle_max_us = cycle;
+
+    memcpy(p->inventory, p->cycle_uids, p->cycle_count * sizeof(Uid));
+    p->inventory_count = p->cycle_count;
+    p->next_poll_us = now_us + rfid_poller_interval_ms(p, now_us) * 1000u;
+    p->state = RFID_POLL_IDLE;
+}
+
+static void rfid_poller_fail(rfid_poller_t *p, uint32_t now_us, StatusCode status) {
+    p->stats.errors++;
+    LOG_D(RFID, "[RFID] Leitura interrompida no estado %d: %s\n", p->state,
+          GetStatusCodeName(status));
+    rfid_poller_schedule(p, now_us);
+}
+
+static void rfid_poller_start_request(rfid_poller_t *p, uint32_t now_us, uint8_t command) {
+    p->stats.requests++;
+    if (PICC_REQA_or_WUPA_Start(p->mfrc, command) == STATUS_OK) {
+        p->state = RFID_POLL_REQA;
+    } else {
+        rfid_poller_schedule(p, now_us);
+    }
+}
+
+// ANTICOLLISION do nível atual: SEL + NVB 0x20 (nenhum bit do UID conhecido)
+static void rfid_poller_start_anticoll(rfid_poller_t *p) {
+    p->frame[0] = sel_commands[p->cascade];
+    p->frame[1] = 0x20;
+    PCD_CommunicateStart(p->mfrc, PCD_Transceive, RFID_WAIT_IRQ, p->frame, 2, 0, 0);
+    p->state = RFID_POLL_ANTICOLL;
+}
+
+// HLTA: a tag fica em HALT e só volta a responder ao WUPA do próximo ciclo
+static void rfid_poller_start_halt(rfid_poller_t *p) {
+    rfid_poller_set_timer(p, RFID_TIMER_HALT);
+    p->frame[0] = PICC_CMD_HLTA;
+    p->frame[1] = 0x00;
+    rfid_crc_a(p->frame, 2, &p->frame[2]);
+    PCD_CommunicateStart(p->mfrc, PCD_Transceive, RFID_WAIT_IRQ, p->frame, 4, 0, 0);
+    p->state = RFID_POLL_HALT;
+}
+
+static bool rfid_poller_complete(rfid_poller_t *p, uint32_t now_us) {
+    p->stats.reads++;
+    if (p->cycle_count < RFID_INVENTORY_MAX) p->cycle_uids[p->cycle_count++] = p->uid;
+
+    if (!rfid_poller_uid_in(p->inventory, p->inventory_count, &p->uid)) {
+        // Tag nova no campo. Tags costumam vir em sequência no percurso:
+        // mantém a taxa alta
+        p->entry_us = p->prev_cycle_us;
+        p->pending_publish = true;
+        rfid_poller_expect_tag(p, now_us, RFID_EXPECT_WINDOW_MS);
+    }
+    rfid_poller_start_halt(p);
+    return true;
+}
+
+// Mais de uma tag respondeu: resolve a colisão com o PICC_Select bloqueante
+// (raro; a tag mais forte é selecionada)
+static bool rfid_poller_resolve_collision(rfid_poller_t *p, uint32_t now_us) {
+    p->stats.collisions++;
+    if (PICC_Select(p->mfrc, &p->uid, 0) != STATUS_OK) {
+        rfid_poller_fail(p, now_us, STATUS_COLLISION);
+        return false;
+    }
+    return rfid_poller_complete(p, now_us);
+}
+
+static bool rfid_poller_step_reqa(rfid_poller_t *p, uint32_t now_us) {
+    uint8_t atqa[2];
+    uint8_t atqa_size = sizeof(atqa);
+    StatusCode status = PICC_REQA_or_WUPA_Poll(p->mfrc, atqa, &atqa_size);
+    if (status == STATUS_BUSY) return false;
+
+    if (status != STATUS_OK && status != STATUS_COLLISION) {
+        // Nenhuma tag acordada no campo: ciclo completo
+        rfid_poller_schedule(p, now_us);
+        return false;
+    }
+
+    p->cascade = 0;
+    p->uid.size = 0;
+    rfid_poller_start_anticoll(p);
+    return false;
+}
+
+static bool rfid_poller_step_anticoll(rfid_poller_t *p, uint32_t now_us) {
+    uint8_t len = 5;
+    uint8_t valid_bits = 0;
+    StatusCode status = PCD_CommunicatePoll(p->mfrc, &p->frame[2], &len, &valid_bits, false);
+    if (status == STATUS_BUSY) return false;
+    if (status == STATUS_COLLISION) return rfid_poller_resolve_collision(p, now_us);
+    if (status != STATUS_OK) {
+        rfid_poller_fail(p, now_us, status);
+        return false;
+    }
+
+    const uint8_t *cl = &p->frame[2];
+    if (len != 5 || valid_bits != 0 || (cl[0] ^ cl[1] ^ cl[2] ^ cl[3]) != cl[4]) {
+        rfid_poller_fail(p, now_us, STATUS_ERROR);
+        return false;
+    }
+
+    // SELECT: SEL, NVB 0x70 (40 bits), UID CLn, BCC, CRC_A
+    p->frame[1] = 0x70;
+    rfid_crc_a(p->frame, 7, &p->frame[7]);
+    PCD_CommunicateStart(p->mfrc, PCD_Transceive, RFID_WAIT_IRQ, p->frame, 9, 0, 0);
+    p->state = RFID_POLL_SELECT;
+    return false;
+}
+
+static bool rfid_poller_step_select(rfid_poller_t *p, uint32_t now_us) {
+    uint8_t sak[3];
+    uint8_t len = sizeof(sak);
+    uint8_t valid_bits = 0;
+    uint8_t crc[2];
+    StatusCode status = PCD_CommunicatePoll(p->mfrc, sak, &len, &valid_bits, false);
+    if (status == STATUS_BUSY) return false;
+    if (status != STATUS_OK) {
+        rfid_poller_fail(p, now_us, status);
+        return false;
+    }
+
+    rfid_crc_a(sak, 1, crc);
+    if (len != 3 || valid_bits != 0 || sak[1] != crc[0] || sak[2] != crc[1]) {
+        rfid_poller_fail(p, now_us, STATUS_CRC_WRONG);
+        return false;
+    }
+
+    // SAK com o bit de cascata: CLn começa com CT (0x88) e o UID continua
+    const uint8_t *cl = &p->frame[2];
+    if ((sak[0] & 0x04) && p->cascade + 1 < RFID_MAX_CASCADE) {
+        memcpy(&p->uid.uidByte[p->uid.size], &cl[1], 3);
+        p->uid.size += 3;
+        p->cascade++;
+        rfid_poller_start_anticoll(p);
+        return false;
+    }
+
+    memcpy(&p->uid.uidByte[p->uid.size], cl, 4);
+    p->uid.size += 4;
+    p->uid.sak = sak[0];
+    return rfid_poller_complete(p, now_us);
+}
+
+static void rfid_poller_step_halt(rfid_poller_t *p, uint32_t now_us) {
+    StatusCode status = PCD_CommunicatePoll(p->mfrc, NULL, NULL, NULL, false);
+    if (status == STATUS_BUSY) return;
+    rfid_poller_set_timer(p, RFID_TIMER_DEFAULT);
+    // Qualquer resposta ao HLTA é NAK; o timeout é o caso normal
+    if (status != STATUS_TIMEOUT) p->stats.errors++;
+
+    // Próxima tag do ciclo: as já paradas não respondem ao REQA
+    if (p->cycle_count < RFID_INVENTORY_MAX) {
+        rfid_poller_start_request(p, now_us, PICC_CMD_REQA);
+    } else {
+        rfid_poller_schedule(p, now_us);
+    }
+}
+
+// Um passo da máquina de estados
+static bool rfid_poller_advance(rfid_poller_t *poller, uint32_t now_us) {
+    switch (poller->state) {
+    case RFID_POLL_IDLE:
+        if (!rfid_time_reached(now_us, poller->next_poll_us)) return false;
+        poller->prev_cycle_us = poller->cycle_us;
+        poller->cycle_us = now_us;
+        poller->cycle_count = 0;
+        poller->stats.cycles++;
+        // WUPA acorda as tags paradas no ciclo anterior
+        rfid_poller_start_request(poller, now_us, PICC_CMD_WUPA);
+        return false;
+    case RFID_POLL_REQA:
+        return rfid_poller_step_reqa(poller, now_us);
+    case RFID_POLL_ANTICOLL:
+        return rfid_poller_step_anticoll(poller, now_us);
+    case RFID_POLL_SELECT:
+        return rfid_poller_step_select(poller, now_us);
+    case RFID_POLL_HALT:
+        rfid_poller_step_halt(poller, now_us);
+        return false;
+    }
+    return false;
+}
+
+// --- Funções Públicas (declaradas em rfid_poller.h) ---
+
+void rfid_poller_init(rfid_poller_t *poller, MFRC522Ptr_t mfrc, uint32_t now_us) {
+    memset(poller, 0, sizeof(*poller));
+    poller->mfrc = mfrc;
+    poller->state = RFID_POLL_IDLE;
+    poller->next_poll_us = now_us;
+    poller->fast_until_us = now_us;
+    poller->cycle_us = now_us;
+}
+
+bool rfid_poller_step(rfid_poller_t *poller, uint32_t now_us) {
+    rfid_poll_state_t before = poller->state;
+    bool read = rfid_poller_advance(poller, now_us);
+    // Sem leitura e no mesmo estado: comando no RF ou ciclo ainda não devido
+    poller->waiting = !read && poller->state == before;
+    return read;
+}
+
+uint32_t rfid_poller_next_us(const rfid_poller_t *poller, uint32_t now_us) {
+    return poller->state == RFID_POLL_IDLE ? poller->next_poll_us : now_us + RFID_BUSY_POLL_US;
+}
+
+void rfid_poller_expect_tag(rfid_poller_t *poller, uint32_t now_us, uint32_t window_ms) {
+    uint32_t until = now_us + window_ms * 1000u;
+    if (rfid_time_reached(until, poller->fast_until_us)) poller->fast_until_us = until;
+    // Antecipa o próximo ciclo se ele estava agendado na taxa baixa
+    uint32_t fast_next = now_us + RFID_POLL_FAST_MS * 1000u;
+    if (poller->state == RFID_POLL_IDLE && rfid_time_reached(poller->next_poll_us, fast_next)) {
+        poller->next_poll_us = fast_next;
+    }
+}
+
+uint32_t rfid_poller_interval_ms(const rfid_poller_t *poller, uint32_t now_us) {
+    return rfid_time_reached(now_us, poller->fast_until_us) ? RFID_POLL_SLOW_MS : RFID_POLL_FAST_MS;
+}
+
+void rfid_poller_published(rfid_poller_t *poller, uint32_t now_us) {
+    if (!poller->pending_publish) return;
+    poller->pending_publish = false;
+
+    uint32_t latency = now_us - poller->entry_us;
+    rfid_poller_stats_t *st = &poller->stats;
+    st->latency_last_us = latency;
+    if (latency > st->latency_max_us) st->latency_max_us = latency;
+    st->latency_sum_ms += latency / 1000u;
+    st->latency_count++;
+    LOG_D(RFID, "[RFID] Entrada no campo -> publicacao: <= %lu us\n", latency);
+}
+
+void rfid_crc_a(const uint8_t *data, uint8_t len, uint8_t out[2]) {
+    uint16_t crc = 0x6363;
+    for (uint8_t i = 0; i < len; i++) {
+        uint8_t b = data[i] ^ (uint8_t)crc;
+        b ^= (uint8_t)(b << 4);
+        crc = (crc >> 8) ^ ((uint16_t)b << 8) ^ ((uint16_t)b << 3) ^ (b >> 4);
+    }
+    out[0] = (uint8_t)crc;
+    out[1] = (uint8_t)(crc >> 8);
+}
+
+int rfid_poller_format_stats(const rfid_poller_t *poller, char *buf, size_t size, uint32_t now_us) {
+    const rfid_poller_stats_t *st = &poller->stats;
+    int n = snprintf(buf, size,
+                     "{\"cycles\":%lu,\"requests\":%lu,\"reads\":%lu,"
+                     "\"errors\":%lu,\"collisions\":%lu,\"in_field\":%u,\"interval_ms\":%lu,"
+                     "\"cycle_us\":{\"last\":%lu,\"tags\":%u,\"max\":%lu},"
+                     "\"latency_ms\":{\"last\":%lu,\"avg\":%lu,\"max\":%lu}}",
+                     (unsigned long)st->cycles, (unsigned long)st->requests, (unsigned long)st->reads,
+                     (unsigned long)st->errors, (unsigned long)st->collisions,
+                     (unsigned)poller->inventory_count,
+                     (unsigned long)rfid_poller_interval_ms(poller, now_us),
+                     (unsigned long)st->cycle_last_us, (unsigned)st->cycle_last_tags,
+                     (unsigned long)st->cycle_max_us,
+                     (unsigned long)(st->latency_last_us / 1000u),
+                     (unsigned long)(st->latency_count ? st->latency_sum_ms / st->latency_count : 0),
+                     (unsigned long)(st->latency_max_us / 1000u));
+    if (n < 0) return 0;
+    return ((size_t)n < size) ? n : (int)size - 1;
+}
@@ -0,0 +1,108 @@
+#ifndef RFID_POLLER_H
+#define RFID_POLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+#include "mfrc522.h"
+
+// =====================================================
+// Leitura de tags RFID sem bloquear o loop
+//
+// Máquina de estados REQA -> ANTICOLLISION -> SELECT (até 3 níveis de
+// cascata) -> HLTA. Cada chamada de rfid_poller_step() avança no máximo um
+// passo: dispara um comando no MFRC522 ou recolhe a resposta do anterior
+// (PCD_CommunicateStart/Poll, conclusão pelo pino IRQ quando ligado). O
+// CRC_A dos quadros é calculado no processador, sem ida e volta ao
+// coprocessador do leitor. O loop chama step até o leitor ficar esperando
+// (poller->waiting) e dorme até rfid_poller_next_us().
+//
+// Inventário: cada ciclo começa com WUPA, que acorda também as tags paradas
+// no ciclo anterior. Cada tag que responde é selecionada e recebe HLTA; em
+// seguida sai um novo REQA, ao qual as tags já paradas não respondem. O ciclo
+// termina no REQA sem resposta (ou em RFID_INVENTORY_MAX tags) e o conjunto
+// fica em poller->inventory. Tags lado a lado (ponto de junção e item) são
+// todas lidas a cada ciclo; quem evita republicar é o tag_cache.
+//
+// Taxa adaptativa: ciclo a cada RFID_POLL_FAST_MS perto de uma tag esperada
+// (janela aberta por rfid_poller_expect_tag() e por toda tag que entra no
+// campo) e a cada RFID_POLL_SLOW_MS no resto do percurso.
+// =====================================================
+
+typedef enum {
+    RFID_POLL_IDLE = 0,         // Esperando o próximo ciclo
+    RFID_POLL_REQA,             // WUPA/REQA enviado, esperando ATQA (timeout = fim do ciclo)
+    RFID_POLL_ANTICOLL,         // ANTICOLLISION do nível atual, esperando UID + BCC
+    RFID_POLL_SELECT,           // SELECT do nível atual, esperando SAK
+    RFID_POLL_HALT              // HLTA enviado (sem resposta = tag parada)
+} rfid_poll_state_t;
+
+typedef struct {
+    uint32_t cycles;            // Ciclos de inventário
+    uint32_t requests;          // WUPAs/REQAs enviados
+    uint32_t reads;             // UIDs completos (uma tag parada no campo conta a cada ciclo)
+    uint32_t errors;            // BCC/CRC/quadro inválido, colisão não resolvida
+    uint32_t collisions;        // Mais de uma tag: resolvido pelo PICC_Select bloqueante
+    uint32_t cycle_last_us;     // Duração do último ciclo (WUPA -> REQA sem resposta)
+    uint32_t cycle_max_us;
+    uint8_t cycle_last_tags;    // Tags lidas no último ciclo
+    uint32_t latency_last_us;   // Entrada no campo -> publicação
+    uint32_t latency_max_us;
+    uint32_t latency_sum_ms;
+    uint32_t latency_count;
+} rfid_poller_stats_t;
+
+typedef struct {
+    MFRC522Ptr_t mfrc;
+    rfid_poll_state_t state;
+    uint8_t cascade;            // Nível de cascata atual (0..2)
+    uint8_t frame[9];           // SEL, NVB, UID CLn, BCC, CRC_A
+    Uid uid;                    // UID lido (válido depois que step retorna true)
+    Uid cycle_uids[RFID_INVENTORY_MAX]; // Tags do ciclo em andamento
+    uint8_t cycle_count;
+    Uid inventory[RFID_INVENTORY_MAX];  // Tags do último ciclo completo
+    uint8_t inventory_count;
+    uint32_t next_poll_us;
+    uint32_t fast_until_us;     // Taxa alta até este instante
+    uint32_t cycle_us;          // Início do ciclo atual
+    uint32_t prev_cycle_us;     // Início do ciclo anterior: uma tag nova entrou depois dele
+    uint32_t entry_us;          // Estimativa da entrada no campo da tag lida
+    bool pending_publish;       // Tag nova no campo ainda sem rfid_poller_published()
+    bool waiting;               // Último step não avançou: resposta no RF ou próximo ciclo
+    rfid_poller_stats_t stats;
+} rfid_poller_t;
+
+// Zera o estado; o primeiro ciclo começa na primeira chamada de step
+void rfid_poller_init(rfid_poller_t *poller, MFRC522Ptr_t mfrc, uint32_t now_us);
+
+// Avança no máximo um passo. Retorna true a cada UID completo lido (em
+// poller->uid), inclusive de tags que continuam no campo desde o ciclo
+// anterior; o HLTA da tag e o REQA seguinte vêm nas próximas chamadas.
+bool rfid_poller_step(rfid_poller_t *poller, uint32_t now_us);
+
+// Próximo instante em que step pode avançar: início do próximo ciclo ou,
+// com um comando no RF, a próxima consulta (RFID_BUSY_POLL_US)
+uint32_t rfid_poller_next_us(const rfid_poller_t *poller, uint32_t now_us);
+
+// Tag esperada nos próximos window_ms (ex.: veículo chegando num ponto da
+// rota): ciclos na taxa alta durante a janela
+void rfid_poller_expect_tag(rfid_poller_t *poller, uint32_t now_us, uint32_t window_ms);
+
+// Intervalo atual entre ciclos (ms)
+uint32_t rfid_poller_interval_ms(const rfid_poller_t *poller, uint32_t now_us);
+
+// Registra a publicação do último UID lido (latência entrada -> publicação).
+// Só conta para tags que não estavam no inventário anterior; a entrada é
+// estimada pelo início daquele ciclo, então a latência é um limite superior
+// (erro de até um intervalo de consulta).
+void rfid_poller_published(rfid_poller_t *poller, uint32_t now_us);
+
+// CRC_A (ISO/IEC 14443-3, valor inicial 0x6363), byte menos significativo
+// primeiro em out
+void rfid_crc_a(const uint8_t *data, uint8_t len, uint8_t out[2]);
+
+// Estatísticas do leitor em JSON ({...}); retorna o comprimento escrito
+int rfid_poller_format_stats(const rfid_poller_t *poller, char *buf, size_t size, uint32_t now_us);
+
+#endif // RFID_POLLER_H
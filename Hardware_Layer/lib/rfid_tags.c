@@ -0,0 +1,163 @@
+#include "rfid_tags.h"
+#include <string.h>
+#include "agv_log.h"
+#include "json_util.h"
+#include "rfid_tag_table.h"    // Gerado por tools/gen_rfid_table.py
+
+// Alterações recebidas por MQTT depois do build
+typedef struct {
+    uint8_t uid[RFID_TAG_UID_MAX];
+    uint8_t size;               // 0 = entrada livre
+    bool deleted;               // Tag removida no backend
+    char name[RFID_TAG_NAME_MAX];
+    char node[RFID_TAG_NODE_NAME_MAX];  // "" = sem nó
+} rfid_tag_overlay_t;
+
+static rfid_tag_overlay_t overlay[RFID_TAG_OVERLAY_SIZE];
+
+// --- Funções Internas ---
+
+// Mesma ordem do gerador: tamanho do UID, depois bytes
+static int rfid_tag_compare(const uint8_t *uid, uint8_t size, const rfid_tag_entry_t *e) {
+    if (size != e->size) return (int)size - (int)e->size;
+    return memcmp(uid, e->uid, size);
+}
+
+static rfid_tag_overlay_t *rfid_tags_overlay_find(const uint8_t *uid, uint8_t size) {
+    for (uint8_t i = 0; i < RFID_TAG_OVERLAY_SIZE; i++) {
+        if (overlay[i].size == size && memcmp(overlay[i].uid, uid, size) == 0) {
+            return &overlay[i];
+        }
+    }
+    return NULL;
+}
+
+// Busca binária na tabela gerada
+static const rfid_tag_entry_t *rfid_tags_table_find(const uint8_t *uid, uint8_t size) {
+    int lo = 0, hi = RFID_TAG_TABLE_COUNT - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = rfid_tag_compare(uid, size, &RFID_TAG_TABLE[mid]);
+        if (cmp == 0) return &RFID_TAG_TABLE[mid];
+        if (cmp < 0) hi = mid - 1; else lo = mid + 1;
+    }
+    return NULL;
+}
+
+// A atualização não muda nada em relação à tabela gerada (o backend reenvia
+// todo o cadastro retido a cada conexão). Textos comparados até o tamanho
+// que a sobreposição guardaria.
+static bool rfid_tags_same_as_table(const rfid_tag_entry_t *e, bool deleted,
+                                    const char *name, const char *node) {
+    if (deleted) return e == NULL;
+    if (e == NULL) return false;
+    if (strncmp(name, &RFID_TAG_NAMES[e->name], RFID_TAG_NAME_MAX - 1) != 0) return false;
+    if (e->node == RFID_TAG_NO_NODE) return node[0] == '\0';
+    return strncmp(node, RFID_TAG_NODES[e->node], RFID_TAG_NODE_NAME_MAX - 1) == 0;
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static bool hex_to_uid(const char *hex, uint8_t *uid, uint8_t *size) {
+    // UIDs ISO/IEC 14443-3: 4, 7 ou 10 bytes
+    size_t len = strlen(hex);
+    if (len != 8 && len != 14 && len != 20) return false;
+    for (size_t i = 0; i < len / 2; i++) {
+        int hi = hex_nibble(hex[i * 2]);
+        int lo = hex_nibble(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) return false;
+        uid[i] = (uint8_t)(hi << 4 | lo);
+    }
+    *size = (uint8_t)(len / 2);
+    return true;
+}
+
+// --- Funções Públicas (declaradas em rfid_tags.h) ---
+
+bool rfid_tags_lookup(const uint8_t *uid, uint8_t size, rfid_tag_info_t *info) {
+    const rfid_tag_overlay_t *o = rfid_tags_overlay_find(uid, size);
+    if (o != NULL) {
+        if (o->deleted) return false;
+        info->name = o->name;
+        info->node = o->node[0] ? o->node : NULL;
+        info->id = RFID_TAG_TABLE_COUNT + (uint16_t)(o - overlay);
+        info->from_overlay = true;
+        return true;
+    }
+
+    const rfid_tag_entry_t *e = rfid_tags_table_find(uid, size);
+    if (e == NULL) return false;
+    info->name = &RFID_TAG_NAMES[e->name];
+    info->node = (e->node == RFID_TAG_NO_NODE) ? NULL : RFID_TAG_NODES[e->node];
+    info->id = (uint16_t)(e - RFID_TAG_TABLE);
+    info->from_overlay = false;
+    return true;
+}
+
+bool rfid_tags_apply_update(const char *json) {
+    char hex[RFID_TAG_UID_MAX * 2 + 1];
+    uint8_t uid[RFID_TAG_UID_MAX];
+    uint8_t size;
+    if (!json_get_string(json, "tag", hex, sizeof(hex)) || !hex_to_uid(hex, uid, &size)) {
+        LOG_W(RFID, "[RFID] Atualizacao de tag invalida\n");
+        return false;
+    }
+
+    bool deleted = json_get_true(json, "deleted");
+    char name[RFID_TAG_NAME_MAX] = "";
+    char node[RFID_TAG_NODE_NAME_MAX] = "";
+    if (!deleted) {
+        if (!json_get_string(json, "name", name, sizeof(name))) name[0] = '\0';
+        if (!json_get_string(json, "node", node, sizeof(node))) node[0] = '\0';
+    }
+    uint32_t uid_head = ((uint32_t)uid[0] << 24) | ((uint32_t)uid[1] << 16) |
+                        ((uint32_t)uid[2] << 8) | uid[3];
+
+    // Igual à tabela: nada a sobrepor (e uma alteração anterior é desfeita)
+    rfid_tag_overlay_t *o = rfid_tags_overlay_find(uid, size);
+    if (rfid_tags_same_as_table(rfid_tags_table_find(uid, size), deleted, name, node)) {
+        if (o != NULL) {
+            o->size = 0;
+            LOG_I(RFID, "[RFID] Tag %08lX (%u bytes) de volta ao valor da tabela\n",
+                  uid_head, size);
+        }
+        return true;
+    }
+
+    if (o == NULL) {
+        for (uint8_t i = 0; i < RFID_TAG_OVERLAY_SIZE && o == NULL; i++) {
+            if (overlay[i].size == 0) o = &overlay[i];
+        }
+        if (o == NULL) {
+            LOG_W(RFID, "[RFID] Sobreposicao de tags cheia (%u), atualizacao ignorada\n",
+                  RFID_TAG_OVERLAY_SIZE);
+            return false;
+        }
+        memcpy(o->uid, uid, size);
+        o->size = size;
+    }
+
+    o->deleted = deleted;
+    memcpy(o->name, name, sizeof(o->name));
+    memcpy(o->node, node, sizeof(o->node));
+    LOG_I(RFID, "[RFID] Tag %08lX (%u bytes) %s pelo backend\n",
+          uid_head, size, o->deleted ? "removida" : "atualizada");
+    return true;
+}
+
+uint16_t rfid_tags_table_count(void) {
+    return RFID_TAG_TABLE_COUNT;
+}
+
+uint8_t rfid_tags_overlay_count(void) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < RFID_TAG_OVERLAY_SIZE; i++) {
+        if (overlay[i].size) n++;
+    }
+    return n;
+}
@@ -0,0 +1,56 @@
+#ifndef RFID_TAGS_H
+#define RFID_TAGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+
+// =====================================================
+// Tabela de tags RFID no firmware (UID -> item e nó do mapa)
+//
+// A base vem de data/rfid-tags.json, compilada no build por
+// tools/gen_rfid_table.py numa tabela ordenada em flash: a busca é binária,
+// O(log n), sem alocação. O backend publica cada tag retida em
+// MQTT_TOPIC_RFID_TAGS/<UID>, e o broker reenvia o cadastro inteiro a cada
+// conexão (inclusive depois de um reset). O que difere da tabela fica numa
+// sobreposição em RAM de RFID_TAG_OVERLAY_SIZE entradas, consultada antes
+// da tabela; mensagens iguais à tabela não ocupam espaço.
+// =====================================================
+
+#define RFID_TAG_UID_MAX        10
+#define RFID_TAG_NO_NODE        0xFF
+#define RFID_TAG_NAME_MAX       32      // Nomes recebidos por MQTT (com '\0')
+#define RFID_TAG_NODE_NAME_MAX  24
+
+// Entrada da tabela gerada (ordenada por tamanho do UID, depois bytes)
+typedef struct {
+    uint8_t uid[RFID_TAG_UID_MAX];
+    uint8_t size;
+    uint8_t node;               // Índice em RFID_TAG_NODES (RFID_TAG_NO_NODE = sem nó)
+    uint16_t name;              // Deslocamento em RFID_TAG_NAMES
+} rfid_tag_entry_t;
+
+typedef struct {
+    const char *name;           // Nome do item
+    const char *node;           // Nó do mapa (NULL = tag sem nó)
+    uint16_t id;                // Posição na tabela; sobreposição: após a tabela
+    bool from_overlay;          // Veio de uma atualização por MQTT
+} rfid_tag_info_t;
+
+// Busca um UID; retorna false se a tag não está cadastrada (ou foi removida).
+// Os ponteiros em info valem até a próxima atualização por MQTT.
+bool rfid_tags_lookup(const uint8_t *uid, uint8_t size, rfid_tag_info_t *info);
+
+// Aplica uma mensagem recebida em MQTT_TOPIC_RFID_TAGS/<UID> (JSON terminado
+// em '\0'): {"tag":"91B657A4","name":"Remédio","node":"Lilás"} cadastra ou
+// altera; {"tag":"91B657A4","deleted":true} remove. Uma mensagem igual à
+// tabela libera a entrada da tag na sobreposição. Retorna false para
+// mensagem inválida ou sobreposição cheia.
+bool rfid_tags_apply_update(const char *json);
+
+// Tags na tabela gerada / entradas ocupadas na sobreposição
+uint16_t rfid_tags_table_count(void);
+uint8_t rfid_tags_overlay_count(void);
+
+#endif // RFID_TAGS_H
@@ -0,0 +1,315 @@
+#include "safety_reflex.h"
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "agv_log.h"
+
+#define SAFETY_TTC_NONE     0xFFFF
+#define SAFETY_SENSOR_NONE  0xFF
+
+#if (SAFETY_EVENT_QUEUE_SIZE & (SAFETY_EVENT_QUEUE_SIZE - 1)) != 0
+#error "SAFETY_EVENT_QUEUE_SIZE deve ser potencia de 2"
+#endif
+
+// Limites por sensor (ordem: esquerda, centro, direita)
+static const uint16_t stop_mm[NUM_SENSORS] = {
+    SAFETY_STOP_MM_LEFT, SAFETY_STOP_MM_CENTER, SAFETY_STOP_MM_RIGHT
+};
+static const uint16_t slow_mm[NUM_SENSORS] = {
+    SAFETY_SLOW_MM_LEFT, SAFETY_SLOW_MM_CENTER, SAFETY_SLOW_MM_RIGHT
+};
+
+// Estado de cada sensor
+typedef struct {
+    bool enabled;
+    bool has_sample;
+    uint32_t last_sample_us;
+    uint16_t last_mm;
+    int32_t closing_mm_s;   // Velocidade de aproximação filtrada (> 0 = aproximando)
+    uint8_t level;          // safety_state_t com histerese aplicada
+    uint8_t reason;
+    uint16_t distance_mm;
+    uint16_t ttc_ms;
+} safety_sensor_t;
+
+static safety_sensor_t sensors[NUM_SENSORS];
+static safety_state_t current_state = SAFETY_STOP;
+static uint8_t holder = SAFETY_SENSOR_NONE;    // Sensor que sustenta o estado atual
+static uint32_t release_start_us = 0;
+static bool release_pending = false;
+
+// O timer avalia o reflexo em interrupção: o estado é protegido contra o loop
+static critical_section_t safety_lock;
+static repeating_timer_t safety_timer;
+
+// Fila de eventos (sobrescreve os mais antigos quando cheia)
+static safety_event_t event_queue[SAFETY_EVENT_QUEUE_SIZE];
+static uint8_t event_head = 0;
+static uint8_t event_tail = 0;
+
+// --- Funções Internas ---
+
+static void safety_drive_outputs(safety_state_t state) {
+    bool stop = (state == SAFETY_STOP);
+    bool slow = (state != SAFETY_CLEAR);
+    gpio_put(PIN_SAFETY_STOP, stop == SAFETY_OUTPUT_ACTIVE_HIGH);
+    gpio_put(PIN_SAFETY_SLOW, slow == SAFETY_OUTPUT_ACTIVE_HIGH);
+}
+
+static void safety_push_event(safety_state_t state, uint8_t reason, uint8_t sensor,
+                              uint16_t distance_mm, uint16_t ttc_ms, uint32_t now_us) {
+    safety_event_t *ev = &event_queue[event_head & (SAFETY_EVENT_QUEUE_SIZE - 1)];
+    ev->timestamp_ms = now_us / 1000;
+    ev->state = state;
+    ev->reason = reason;
+    ev->sensor = sensor;
+    ev->distance_mm = distance_mm;
+    ev->ttc_ms = ttc_ms;
+
+    event_head++;
+    if ((uint8_t)(event_head - event_tail) > SAFETY_EVENT_QUEUE_SIZE) {
+        event_tail++;  // Descarta o evento mais antigo
+    }
+}
+
+// Atualiza a velocidade de aproximação e retorna o TTC em ms
+static uint16_t safety_update_ttc(safety_sensor_t *s, uint16_t sample_mm, uint32_t now_us) {
+    if (s->has_sample && sample_mm < SAFETY_RANGE_MAX_MM && s->last_mm < SAFETY_RANGE_MAX_MM) {
+        uint32_t dt_ms = (now_us - s->last_sample_us) / 1000;
+        if (dt_ms > 0) {
+            int32_t speed = ((int32_t)s->last_mm - (int32_t)sample_mm) * 1000 / (int32_t)dt_ms;
+            // Média exponencial (peso 1/4) para reduzir o ruído do sensor
+            s->closing_mm_s += (speed - s->closing_mm_s) / 4;
+        }
+    } else {
+        // Sem obstáculo no alcance: não há aproximação a estimar
+        s->closing_mm_s = 0;
+    }
+
+    s->last_mm = sample_mm;
+    s->last_sample_us = now_us;
+    s->has_sample = true;
+
+    if (s->closing_mm_s < SAFETY_MIN_CLOSING_MM_S) return SAFETY_TTC_NONE;
+
+    uint32_t ttc = (uint32_t)sample_mm * 1000 / (uint32_t)s->closing_mm_s;
+    return ttc < SAFETY_TTC_NONE ? (uint16_t)ttc : (SAFETY_TTC_NONE - 1);
+}
+
+// Nível do sensor com histerese: entra pelo menor valor (amostra ou média),
+// sai apenas quando a média passa da zona + histerese
+static void safety_evaluate_sensor(uint8_t i, uint16_t sample_mm, uint16_t filtered_mm,
+                                   uint16_t ttc_ms) {
+    safety_sensor_t *s = &sensors[i];
+    uint16_t enter_mm = sample_mm < filtered_mm ? sample_mm : filtered_mm;
+
+    uint8_t level = SAFETY_CLEAR;
+    uint8_t reason = SAFETY_REASON_RELEASE;
+
+    if (enter_mm <= stop_mm[i]) {
+        level = SAFETY_STOP;
+        reason = SAFETY_REASON_ZONE;
+    } else if (ttc_ms < SAFETY_TTC_STOP_MS) {
+        level = SAFETY_STOP;
+        reason = SAFETY_REASON_TTC;
+    } else if (enter_mm <= slow_mm[i]) {
+        level = SAFETY_SLOW;
+        reason = SAFETY_REASON_ZONE;
+    } else if (ttc_ms < SAFETY_TTC_SLOW_MS) {
+        level = SAFETY_SLOW;
+        reason = SAFETY_REASON_TTC;
+    }
+
+    // Mantém o nível anterior enquanto não sair da zona com folga
+    if (s->level == SAFETY_STOP && level < SAFETY_STOP &&
+        filtered_mm <= stop_mm[i] + SAFETY_HYSTERESIS_MM) {
+        level = SAFETY_STOP;
+        reason = s->reason;
+    } else if (s->level >= SAFETY_SLOW && level < SAFETY_SLOW &&
+               filtered_mm <= slow_mm[i] + SAFETY_HYSTERESIS_MM) {
+        level = SAFETY_SLOW;
+        reason = SAFETY_REASON_ZONE;
+    }
+
+    s->level = level;
+    s->reason = reason;
+    s->distance_mm = enter_mm;
+    s->ttc_ms = ttc_ms;
+}
+
+// Combina os sensores, aplica a trava de liberação e aciona as saídas
+// (chamar com safety_lock)
+static void safety_apply(uint32_t now_us) {
+    safety_state_t worst = SAFETY_CLEAR;
+    uint8_t reason = SAFETY_REASON_RELEASE;
+    uint8_t sensor = SAFETY_SENSOR_NONE;
+    uint8_t holding = SAFETY_SENSOR_NONE;
+    bool any_enabled = false;
+
+    for (uint8_t i = 0; i < NUM_SENSORS; i++) {
+        safety_sensor_t *s = &sensors[i];
+        if (!s->enabled) continue;
+        any_enabled = true;
+
+        uint8_t level = s->level;
+        uint8_t why = s->reason;
+        if (!s->has_sample || (now_us - s->last_sample_us) > SAFETY_STALE_TIMEOUT_MS * 1000) {
+            level = SAFETY_STOP;
+            why = SAFETY_REASON_STALE;
+        }
+
+        if (level > worst || sensor == SAFETY_SENSOR_NONE) {
+            if (level > worst) {
+                worst = level;
+                reason = why;
+            }
+            sensor = i;
+        }
+        // Quem ainda sustenta o estado atual (de preferência o mesmo sensor)
+        if (level >= current_state && (holding == SAFETY_SENSOR_NONE || i == holder)) {
+            holding = i;
+        }
+    }
+    // O último sensor a deixar o estado é o que dispara a liberação
+    if (holding != SAFETY_SENSOR_NONE) holder = holding;
+
+    // Nenhum sensor disponível: não há como garantir o caminho livre
+    if (!any_enabled) {
+        worst = SAFETY_STOP;
+        reason = SAFETY_REASON_STALE;
+    }
+
+    if (worst >= current_state) {
+        // Agravamento (ou manutenção) é imediato
+        release_pending = false;
+        if (worst != current_state) {
+            current_state = worst;
+            holder = sensor;
+            safety_drive_outputs(current_state);
+            safety_push_event(current_state, reason, sensor,
+                              sensor < NUM_SENSORS ? sensors[sensor].distance_mm : 0,
+                              sensor < NUM_SENSORS ? sensors[sensor].ttc_ms : SAFETY_TTC_NONE,
+                              now_us);
+        }
+        return;
+    }
+
+    // Liberação só após SAFETY_RELEASE_HOLD_MS contínuos abaixo do estado atual
+    if (!release_pending) {
+        release_pending = true;
+        release_start_us = now_us;
+        return;
+    }
+    if ((now_us - release_start_us) < SAFETY_RELEASE_HOLD_MS * 1000) return;
+
+    uint8_t released_by = holder;
+    release_pending = false;
+    current_state = worst;
+    holder = sensor;
+    safety_drive_outputs(current_state);
+    safety_push_event(current_state, SAFETY_REASON_RELEASE, released_by,
+                      released_by < NUM_SENSORS ? sensors[released_by].distance_mm : 0,
+                      released_by < NUM_SENSORS ? sensors[released_by].ttc_ms : SAFETY_TTC_NONE,
+                      now_us);
+}
+
+// Avaliação periódica em interrupção: cobre sensor sem amostra e a liberação
+// mesmo com o loop principal bloqueado (reconexão, reinicialização, flash)
+static bool safety_timer_cb(repeating_timer_t *timer) {
+    critical_section_enter_blocking(&safety_lock);
+    safety_apply(time_us_32());
+    critical_section_exit(&safety_lock);
+    return true;
+}
+
+// --- Funções Públicas (declaradas em safety_reflex.h) ---
+
+void safety_reflex_init(void) {
+    gpio_init(PIN_SAFETY_STOP);
+    gpio_set_dir(PIN_SAFETY_STOP, GPIO_OUT);
+    gpio_init(PIN_SAFETY_SLOW);
+    gpio_set_dir(PIN_SAFETY_SLOW, GPIO_OUT);
+
+    for (uint8_t i = 0; i < NUM_SENSORS; i++) {
+        sensors[i] = (safety_sensor_t){
+            .enabled = true,
+            .level = SAFETY_STOP,
+            .reason = SAFETY_REASON_STALE,
+            .ttc_ms = SAFETY_TTC_NONE,
+        };
+    }
+
+    // Parado até os sensores entregarem as primeiras amostras
+    current_state = SAFETY_STOP;
+    holder = SAFETY_SENSOR_NONE;
+    release_pending = false;
+    safety_drive_outputs(current_state);
+
+    critical_section_init(&safety_lock);
+    if (!add_repeating_timer_ms(-SAFETY_CHECK_INTERVAL_MS, safety_timer_cb, NULL, &safety_timer)) {
+        LOG_E(DIST, "[SEGURANCA] ERRO: sem timer para o reflexo\n");
+    }
+
+    LOG_I(DIST, "[SEGURANCA] Reflexo ativo (STOP=GP%d, SLOW=GP%d)\n",
+          PIN_SAFETY_STOP, PIN_SAFETY_SLOW);
+}
+
+void safety_reflex_set_sensor_enabled(uint8_t sensor, bool enabled) {
+    if (sensor >= NUM_SENSORS) return;
+    critical_section_enter_blocking(&safety_lock);
+    sensors[sensor].enabled = enabled;
+    critical_section_exit(&safety_lock);
+}
+
+safety_state_t safety_reflex_update(uint8_t sensor, uint16_t sample_mm,
+                                    uint16_t filtered_mm, uint32_t now_us) {
+    if (sensor >= NUM_SENSORS) return current_state;
+
+    critical_section_enter_blocking(&safety_lock);
+    uint16_t ttc_ms = safety_update_ttc(&sensors[sensor], sample_mm, now_us);
+    safety_evaluate_sensor(sensor, sample_mm, filtered_mm, ttc_ms);
+    safety_apply(now_us);
+    safety_state_t state = current_state;
+    critical_section_exit(&safety_lock);
+
+    return state;
+}
+
+safety_state_t safety_reflex_state(void) {
+    return current_state;
+}
+
+int32_t safety_reflex_closing_speed(uint8_t sensor) {
+    if (sensor >= NUM_SENSORS) return 0;
+    return sensors[sensor].closing_mm_s;
+}
+
+bool safety_reflex_pop_event(safety_event_t *event) {
+    bool found = false;
+    critical_section_enter_blocking(&safety_lock);
+    if (event_tail != event_head) {
+        *event = event_queue[event_tail & (SAFETY_EVENT_QUEUE_SIZE - 1)];
+        event_tail++;
+        found = true;
+    }
+    critical_section_exit(&safety_lock);
+    return found;
+}
+
+const char *safety_state_name(safety_state_t state) {
+    switch (state) {
+        case SAFETY_CLEAR: return "clear";
+        case SAFETY_SLOW:  return "slow";
+        case SAFETY_STOP:  return "stop";
+        default:           return "unknown";
+    }
+}
+
+const char *safety_reason_name(safety_reason_t reason) {
+    switch (reason) {
+        case SAFETY_REASON_ZONE:    return "zone";
+        case SAFETY_REASON_TTC:     return "ttc";
+        case SAFETY_REASON_STALE:   return "stale";
+        case SAFETY_REASON_RELEASE: return "release";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef SAFETY_REFLEX_H
+#define SAFETY_REFLEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+// =====================================================
+// Reflexo local de parada por obstáculo
+//
+// Avaliado a cada amostra dos sensores VL53L0X (sem passar pelo MQTT):
+// zonas de parada/redução por sensor e tempo até colisão (TTC) a partir
+// da velocidade de aproximação. O resultado aciona diretamente as linhas
+// GPIO PIN_SAFETY_STOP / PIN_SAFETY_SLOW; os eventos ficam numa fila e são
+// publicados depois, fora do caminho crítico.
+//
+// A parada é travada: só é liberada quando todos os sensores estão além
+// da zona + histerese por SAFETY_RELEASE_HOLD_MS. Sensor sem amostra
+// válida há mais de SAFETY_STALE_TIMEOUT_MS força parada (fail-safe).
+//
+// Além de cada amostra, um timer (SAFETY_CHECK_INTERVAL_MS, em interrupção)
+// reavalia os sensores: com o loop principal bloqueado (reconexão MQTT,
+// reinicialização de sensor), as amostras param e a parada sai em até
+// SAFETY_STALE_TIMEOUT_MS + SAFETY_CHECK_INTERVAL_MS, sem depender do loop.
+// O timer não faz I2C; só durante a gravação da flash (interrupções
+// desligadas no core0) ele também fica parado.
+// =====================================================
+
+typedef enum {
+    SAFETY_CLEAR = 0,   // Livre
+    SAFETY_SLOW,        // Reduzir velocidade
+    SAFETY_STOP         // Parar
+} safety_state_t;
+
+typedef enum {
+    SAFETY_REASON_ZONE = 0,     // Distância dentro da zona
+    SAFETY_REASON_TTC,          // Tempo até colisão abaixo do limite
+    SAFETY_REASON_STALE,        // Sensor sem dados recentes
+    SAFETY_REASON_RELEASE       // Saída da zona (liberação)
+} safety_reason_t;
+
+// Evento de mudança de estado (publicado de forma assíncrona)
+typedef struct {
+    uint32_t timestamp_ms;
+    uint8_t state;          // safety_state_t
+    uint8_t reason;         // safety_reason_t
+    uint8_t sensor;         // Sensor que causou a mudança (na liberação: o último a sair)
+    uint16_t distance_mm;
+    uint16_t ttc_ms;        // 0xFFFF = sem aproximação
+} safety_event_t;
+
+// Configura as linhas GPIO e o timer; começa em STOP até chegarem amostras válidas
+void safety_reflex_init(void);
+
+// Marca se o sensor participa da avaliação (SAFETY_SENSOR_EXCLUDE_MASK)
+void safety_reflex_set_sensor_enabled(uint8_t sensor, bool enabled);
+
+// Processa uma nova amostra e atualiza as linhas GPIO imediatamente
+// sample_mm: amostra atual (resposta rápida); filtered_mm: média móvel
+safety_state_t safety_reflex_update(uint8_t sensor, uint16_t sample_mm,
+                                    uint16_t filtered_mm, uint32_t now_us);
+
+// Estado atual das linhas de segurança
+safety_state_t safety_reflex_state(void);
+
+// Velocidade de aproximação filtrada do sensor (mm/s, > 0 = aproximando)
+int32_t safety_reflex_closing_speed(uint8_t sensor);
+
+// Retira o próximo evento pendente; false se a fila estiver vazia
+bool safety_reflex_pop_event(safety_event_t *event);
+
+// Nomes para payloads/logs
+const char *safety_state_name(safety_state_t state);
+const char *safety_reason_name(safety_reason_t reason);
+
+#endif // SAFETY_REFLEX_H
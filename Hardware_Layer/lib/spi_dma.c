@@ -0,0 +1,153 @@
+#include "spi_dma.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+// Barramentos com DMA (consultados pela interrupção)
+static spi_dma_t *instances[2];
+
+// Origem/destino fixos quando a transação não tem tx/rx
+static const uint8_t dummy_tx = 0x00;
+static uint8_t dummy_rx;
+
+// --- Funções Internas ---
+
+// Inicia a transação da cabeça da fila (fila não vazia, nenhuma ativa)
+static void spi_dma_start_head(spi_dma_t *dma) {
+    spi_dma_xfer_t *xfer = dma->queue[dma->head];
+    spi_hw_t *hw = spi_get_hw(dma->spi);
+
+    // Sobras no RX FIFO deslocariam os bytes recebidos
+    while (spi_is_readable(dma->spi)) (void)hw->dr;
+
+    dma_channel_config c = dma_channel_get_default_config(dma->tx_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(dma->spi, true));
+    channel_config_set_read_increment(&c, xfer->tx != NULL);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(dma->tx_chan, &c, &hw->dr, xfer->tx ? xfer->tx : &dummy_tx,
+                          xfer->len, false);
+
+    c = dma_channel_get_default_config(dma->rx_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(dma->spi, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, xfer->rx != NULL);
+    dma_channel_configure(dma->rx_chan, &c, xfer->rx ? xfer->rx : &dummy_rx, &hw->dr,
+                          xfer->len, false);
+
+    gpio_put(xfer->cs_pin, 0);
+    dma_start_channel_mask((1u << dma->tx_chan) | (1u << dma->rx_chan));
+}
+
+// Fim do canal de recepção: o último byte já saiu e chegou
+static void spi_dma_complete(spi_dma_t *dma) {
+    spi_dma_xfer_t *xfer = dma->queue[dma->head];
+    gpio_put(xfer->cs_pin, 1);
+
+    dma->transfers++;
+    dma->bytes += xfer->len;
+    dma->head = (dma->head + 1) % SPI_DMA_QUEUE_LEN;
+    dma->count--;
+
+    xfer->done = true;
+    if (xfer->done_cb) xfer->done_cb(xfer, xfer->ctx);
+
+    if (dma->count) spi_dma_start_head(dma);
+}
+
+static void spi_dma_irq_handler(void) {
+    for (uint8_t i = 0; i < 2; i++) {
+        spi_dma_t *dma = instances[i];
+        if (dma == NULL || !dma_irqn_get_channel_status(SPI_DMA_IRQ_INDEX, dma->rx_chan)) continue;
+        dma_irqn_acknowledge_channel(SPI_DMA_IRQ_INDEX, dma->rx_chan);
+        spi_dma_complete(dma);
+    }
+}
+
+// Transferência pela CPU (curta ou sem DMA), com o mesmo protocolo de CS
+static void spi_dma_transfer_cpu(spi_dma_t *dma, uint cs_pin, const uint8_t *tx,
+                                 uint8_t *rx, size_t len) {
+    gpio_put(cs_pin, 0);
+    if (tx && rx) {
+        spi_write_read_blocking(dma->spi, tx, rx, len);
+    } else if (tx) {
+        spi_write_blocking(dma->spi, tx, len);
+    } else if (rx) {
+        spi_read_blocking(dma->spi, 0x00, rx, len);
+    }
+    gpio_put(cs_pin, 1);
+}
+
+// --- Funções Públicas (declaradas em spi_dma.h) ---
+
+bool spi_dma_init(spi_dma_t *dma, spi_inst_t *spi) {
+    dma->spi = spi;
+    dma->head = 0;
+    dma->count = 0;
+    dma->transfers = 0;
+    dma->bytes = 0;
+    dma->tx_chan = dma_claim_unused_channel(false);
+    dma->rx_chan = dma_claim_unused_channel(false);
+    if (dma->tx_chan < 0 || dma->rx_chan < 0) {
+        if (dma->tx_chan >= 0) dma_channel_unclaim(dma->tx_chan);
+        if (dma->rx_chan >= 0) dma_channel_unclaim(dma->rx_chan);
+        dma->tx_chan = dma->rx_chan = -1;
+        return false;
+    }
+
+    instances[spi_get_index(spi)] = dma;
+
+    // Handler compartilhado: o driver do CYW43 e outros podem usar a mesma linha
+    static bool handler_installed = false;
+    if (!handler_installed) {
+        irq_add_shared_handler(SPI_DMA_IRQ_INDEX ? DMA_IRQ_1 : DMA_IRQ_0, spi_dma_irq_handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(SPI_DMA_IRQ_INDEX ? DMA_IRQ_1 : DMA_IRQ_0, true);
+        handler_installed = true;
+    }
+    dma_irqn_set_channel_enabled(SPI_DMA_IRQ_INDEX, dma->rx_chan, true);
+    return true;
+}
+
+bool spi_dma_submit(spi_dma_t *dma, spi_dma_xfer_t *xfer) {
+    xfer->done = false;
+
+    if (dma->tx_chan < 0) {
+        spi_dma_transfer_cpu(dma, xfer->cs_pin, xfer->tx, xfer->rx, xfer->len);
+        xfer->done = true;
+        if (xfer->done_cb) xfer->done_cb(xfer, xfer->ctx);
+        return true;
+    }
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (dma->count >= SPI_DMA_QUEUE_LEN) {
+        restore_interrupts(irq_state);
+        return false;
+    }
+    dma->queue[(dma->head + dma->count) % SPI_DMA_QUEUE_LEN] = xfer;
+    dma->count++;
+    if (dma->count == 1) spi_dma_start_head(dma);
+    restore_interrupts(irq_state);
+    return true;
+}
+
+void spi_dma_wait_idle(spi_dma_t *dma) {
+    while (dma->count) tight_loop_contents();
+}
+
+void spi_dma_transfer(spi_dma_t *dma, uint cs_pin, const uint8_t *tx, uint8_t *rx, size_t len) {
+    spi_dma_wait_idle(dma);
+    if (dma->tx_chan < 0 || len < SPI_DMA_MIN_BYTES) {
+        spi_dma_transfer_cpu(dma, cs_pin, tx, rx, len);
+        return;
+    }
+
+    spi_dma_xfer_t xfer = {
+        .cs_pin = cs_pin, .tx = tx, .rx = rx, .len = (uint16_t)len, .done_cb = NULL, .ctx = NULL
+    };
+    spi_dma_submit(dma, &xfer);
+    while (!xfer.done) tight_loop_contents();
+}
@@ -0,0 +1,69 @@
+#ifndef SPI_DMA_H
+#define SPI_DMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "hardware/spi.h"
+#include "../config.h"
+
+// =====================================================
+// Transporte SPI por DMA com fila de transações
+//
+// Cada transação tem o próprio chip select: o CS desce quando ela começa e
+// sobe na interrupção de fim do canal de recepção, que já dispara a próxima
+// da fila. A CPU só participa no início e no fim de cada transação; uma
+// sequência inteira (ex.: armar um comando do MFRC522) pode ser enfileirada
+// e o chamador segue trabalhando.
+//
+// Transferências bloqueantes esperam a fila esvaziar (a ordem no barramento
+// é a ordem de chamada). As curtas (< SPI_DMA_MIN_BYTES) vão pela CPU: para
+// 2 bytes, configurar os dois canais custa mais que a transferência.
+// =====================================================
+
+typedef struct spi_dma_xfer spi_dma_xfer_t;
+
+// Chamado ao fim da transação, em contexto de interrupção
+typedef void (*spi_dma_done_cb_t)(spi_dma_xfer_t *xfer, void *ctx);
+
+struct spi_dma_xfer {
+    uint cs_pin;
+    const uint8_t *tx;          // NULL = envia 0x00
+    uint8_t *rx;                // NULL = descarta o recebido
+    uint16_t len;
+    spi_dma_done_cb_t done_cb;  // Opcional
+    void *ctx;
+    volatile bool done;         // Preenchido pelo transporte
+};
+
+typedef struct {
+    spi_inst_t *spi;
+    int tx_chan;                // Canais de DMA (-1 = sem DMA, tudo pela CPU)
+    int rx_chan;
+    spi_dma_xfer_t *queue[SPI_DMA_QUEUE_LEN];
+    volatile uint8_t head;      // Próxima a executar (a ativa, se houver)
+    volatile uint8_t count;     // Transações na fila, incluindo a ativa
+    uint32_t transfers;         // Transações concluídas por DMA
+    uint32_t bytes;             // Bytes transferidos por DMA
+} spi_dma_t;
+
+// Reserva dois canais de DMA para o barramento (SPI já inicializado).
+// Retorna false sem canais livres; as transferências seguem pela CPU.
+bool spi_dma_init(spi_dma_t *dma, spi_inst_t *spi);
+
+// Enfileira uma transação sem esperar. Os buffers e a estrutura devem viver
+// até xfer->done. Retorna false com a fila cheia.
+bool spi_dma_submit(spi_dma_t *dma, spi_dma_xfer_t *xfer);
+
+// Transação bloqueante (espera a fila esvaziar antes e a transação depois)
+void spi_dma_transfer(spi_dma_t *dma, uint cs_pin, const uint8_t *tx, uint8_t *rx, size_t len);
+
+// Verdadeiro enquanto houver transação na fila
+static inline bool spi_dma_busy(const spi_dma_t *dma) {
+    return dma->count != 0;
+}
+
+// Espera a fila esvaziar
+void spi_dma_wait_idle(spi_dma_t *dma);
+
+#endif // SPI_DMA_H
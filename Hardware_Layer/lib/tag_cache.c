@@ -0,0 +1,60 @@
+#include "tag_cache.h"
+#include <string.h>
+
+// --- Funções Internas ---
+
+static bool tag_cache_expired(const tag_cache_entry_t *e, uint32_t now_us) {
+    return (int32_t)(now_us - e->expires_us) >= 0;
+}
+
+// Entrada a reaproveitar: livre, senão expirada, senão a vista há mais tempo
+static tag_cache_entry_t *tag_cache_victim(tag_cache_t *cache, uint32_t now_us) {
+    tag_cache_entry_t *oldest = &cache->entries[0];
+    for (uint8_t i = 0; i < TAG_CACHE_SIZE; i++) {
+        tag_cache_entry_t *e = &cache->entries[i];
+        if (e->size == 0 || tag_cache_expired(e, now_us)) return e;
+        if ((int32_t)(e->last_seen_us - oldest->last_seen_us) < 0) oldest = e;
+    }
+    cache->evictions++;
+    return oldest;
+}
+
+// --- Funções Públicas (declaradas em tag_cache.h) ---
+
+void tag_cache_init(tag_cache_t *cache) {
+    memset(cache, 0, sizeof(*cache));
+}
+
+bool tag_cache_seen(tag_cache_t *cache, const uint8_t *uid, uint8_t size, uint32_t now_us) {
+    if (size > TAG_CACHE_UID_MAX) size = TAG_CACHE_UID_MAX;
+
+    tag_cache_entry_t *entry = NULL;
+    for (uint8_t i = 0; i < TAG_CACHE_SIZE; i++) {
+        tag_cache_entry_t *e = &cache->entries[i];
+        if (e->size == size && memcmp(e->uid, uid, size) == 0) {
+            entry = e;
+            break;
+        }
+    }
+
+    bool fresh = (entry == NULL || tag_cache_expired(entry, now_us));
+    if (entry == NULL) {
+        entry = tag_cache_victim(cache, now_us);
+        memcpy(entry->uid, uid, size);
+        entry->size = size;
+    }
+    if (!fresh) cache->hits++;
+
+    entry->last_seen_us = now_us;
+    entry->expires_us = now_us + RFID_DEBOUNCE_TIME_MS * 1000u;
+    return fresh;
+}
+
+uint8_t tag_cache_active(const tag_cache_t *cache, uint32_t now_us) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < TAG_CACHE_SIZE; i++) {
+        const tag_cache_entry_t *e = &cache->entries[i];
+        if (e->size != 0 && !tag_cache_expired(e, now_us)) count++;
+    }
+    return count;
+}
@@ -0,0 +1,43 @@
+#ifndef TAG_CACHE_H
+#define TAG_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+// =====================================================
+// Cache LRU das tags RFID vistas recentemente
+//
+// Cada tag tem o próprio prazo: a entrada expira RFID_DEBOUNCE_TIME_MS depois
+// da última vez que a tag foi vista. Enquanto a tag continua no campo (o
+// inventário a relê a cada ciclo) o prazo é renovado e ela não é publicada
+// de novo; duas tags lado a lado não se atrapalham. Com o cache cheio, sai a
+// tag vista há mais tempo.
+// =====================================================
+
+#define TAG_CACHE_UID_MAX   10
+
+typedef struct {
+    uint8_t uid[TAG_CACHE_UID_MAX];
+    uint8_t size;               // 0 = entrada livre
+    uint32_t last_seen_us;
+    uint32_t expires_us;
+} tag_cache_entry_t;
+
+typedef struct {
+    tag_cache_entry_t entries[TAG_CACHE_SIZE];
+    uint32_t hits;              // Leituras suprimidas (tag ainda no prazo)
+    uint32_t evictions;         // Entradas no prazo descartadas por falta de espaço
+} tag_cache_t;
+
+// Esvazia o cache
+void tag_cache_init(tag_cache_t *cache);
+
+// Registra uma leitura. Retorna true se a tag é nova (ausente ou expirada),
+// ou seja, deve ser publicada; renova o prazo em qualquer caso.
+bool tag_cache_seen(tag_cache_t *cache, const uint8_t *uid, uint8_t size, uint32_t now_us);
+
+// Tags ainda no prazo
+uint8_t tag_cache_active(const tag_cache_t *cache, uint32_t now_us);
+
+#endif // TAG_CACHE_H
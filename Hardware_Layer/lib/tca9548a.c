@@ -1,37 +1,74 @@
 #include "tca9548a.h"
+#include "pico/stdlib.h"
 
-// Inicializa a estrutura do multiplexador com a porta e o endereço I2C.
-void tca9548a_init(tca9548a_t *mux, i2c_inst_t *i2c_port, uint8_t address) {
-    mux->i2c_port = i2c_port;
+// Pulso de RESET (datasheet: mínimo 6 ns) e tempo até aceitar comandos
+#define TCA9548A_RESET_PULSE_US     1
+#define TCA9548A_RESET_RECOVERY_US  1
+
+// Inicializa a estrutura do multiplexador com o barramento e o endereço I2C.
+void tca9548a_init(tca9548a_t *mux, i2c_bus_t *bus, uint8_t address) {
+    mux->bus = bus;
     mux->address = address;
+    mux->channel_mask = 0;
+    mux->mask_valid = false;
+    mux->reset_pin = -1;
+}
+
+// Configura o GPIO de RESET, mantendo o mux fora de reset.
+void tca9548a_set_reset_pin(tca9548a_t *mux, int pin) {
+    mux->reset_pin = pin;
+    if (pin < 0) return;
+
+    gpio_init(pin);
+    gpio_put(pin, 1);
+    gpio_set_dir(pin, GPIO_OUT);
+}
+
+// Reinicia o mux. Sem pino de RESET, só reescreve a máscara: um mux que
+// ficou com canal indefinido após a falha volta a um estado conhecido.
+bool tca9548a_reset(tca9548a_t *mux) {
+    if (mux->reset_pin >= 0) {
+        gpio_put(mux->reset_pin, 0);
+        sleep_us(TCA9548A_RESET_PULSE_US);
+        gpio_put(mux->reset_pin, 1);
+        sleep_us(TCA9548A_RESET_RECOVERY_US);
+    }
+    mux->mask_valid = false;
+    return tca9548a_disable_all(mux);
 }
 
 // Seleciona e ativa um único canal do multiplexador (de 0 a 7).
+// Dispositivos atrás do mux chamam isto a cada transação; com o cache, só
+// a troca de canal custa uma escrita no barramento.
 bool tca9548a_select_channel(tca9548a_t *mux, uint8_t channel) {
     if (channel > 7) return false;
-    
-    uint8_t buf = 1 << channel;
-    return (i2c_write_blocking(mux->i2c_port, mux->address, &buf, 1, false) == 1);
+
+    uint8_t mask = 1 << channel;
+    if (mux->mask_valid && mux->channel_mask == mask) return true;
+    return tca9548a_set_channels(mux, mask);
 }
 
 // Desativa todos os canais, desconectando todos os dispositivos I2C do barramento.
 bool tca9548a_disable_all(tca9548a_t *mux) {
-    uint8_t buf = 0x00;
-    return (i2c_write_blocking(mux->i2c_port, mux->address, &buf, 1, false) == 1);
+    return tca9548a_set_channels(mux, 0x00);
 }
 
 // Verifica se o multiplexador está respondendo no endereço I2C configurado.
 bool tca9548a_is_connected(tca9548a_t *mux) {
     uint8_t dummy;
-    return (i2c_read_blocking(mux->i2c_port, mux->address, &dummy, 1, false) >= 0);
+    return (i2c_bus_read(mux->bus, mux->address, &dummy, 1, false) >= 0);
 }
 
 // Lê e retorna o byte que representa os canais atualmente ativos.
 bool tca9548a_get_status(tca9548a_t *mux, uint8_t *status) {
-    return (i2c_read_blocking(mux->i2c_port, mux->address, status, 1, false) >= 0);
+    return (i2c_bus_read(mux->bus, mux->address, status, 1, false) >= 0);
 }
 
 // Define quais canais devem estar ativos usando uma máscara de bits (ex: 0b00000101 ativa os canais 0 e 2).
 bool tca9548a_set_channels(tca9548a_t *mux, uint8_t channel_mask) {
-    return (i2c_write_blocking(mux->i2c_port, mux->address, &channel_mask, 1, false) == 1);
-}
\ No newline at end of file
+    bool ok = (i2c_bus_write(mux->bus, mux->address, &channel_mask, 1, false) == 1);
+    // Em falha o estado real do mux é desconhecido: força reescrita na próxima seleção
+    mux->channel_mask = channel_mask;
+    mux->mask_valid = ok;
+    return ok;
+}
@@ -1,22 +1,33 @@
 #ifndef TCA9548A_H
 #define TCA9548A_H
 
-#include "hardware/i2c.h"
+#include "i2c_bus.h"
 #include <stdint.h>
 #include <stdbool.h>
 
 #define TCA9548A_DEFAULT_ADDR 0x70
+#define TCA9548A_CHANNEL_NONE 0xFF
 
 // Estrutura do multiplexador
-typedef struct {
-    i2c_inst_t *i2c_port;
+typedef struct tca9548a {
+    i2c_bus_t *bus;
     uint8_t address;
+    uint8_t channel_mask;   // Último valor escrito (cache; evita reescrever o mesmo canal)
+    bool mask_valid;        // false até a primeira escrita bem-sucedida
+    int reset_pin;          // GPIO ligado ao RESET (ativo baixo); -1 = não ligado
 } tca9548a_t;
 
 // Inicializa o multiplexador
-void tca9548a_init(tca9548a_t *mux, i2c_inst_t *i2c_port, uint8_t address);
+void tca9548a_init(tca9548a_t *mux, i2c_bus_t *bus, uint8_t address);
 
-// Seleciona um canal (0-7)
+// Configura o pino de RESET do mux (-1 = não ligado)
+void tca9548a_set_reset_pin(tca9548a_t *mux, int pin);
+
+// Reinicia o mux (pulso em RESET, se ligado) e desabilita todos os canais.
+// Usado na recuperação do barramento: o cache de canal é descartado.
+bool tca9548a_reset(tca9548a_t *mux);
+
+// Seleciona um canal (0-7); não acessa o barramento se o canal já estiver ativo
 bool tca9548a_select_channel(tca9548a_t *mux, uint8_t channel);
 
 // Desabilita todos os canais
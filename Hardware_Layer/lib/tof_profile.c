@@ -0,0 +1,169 @@
+#include "tof_profile.h"
+#include "vl53l0x_rp2040.h"
+
+#define MCPS(x) ((FixPoint1616_t)((x) * 65536))
+#define MM(x)   ((FixPoint1616_t)((x) * 65536))
+
+// Limite de sinal fraco em Q16.16 (config em centésimos de MCPS)
+#define WEAK_SIGNAL_Q16 ((FixPoint1616_t)TOF_WEAK_SIGNAL_CMCPS * 65536 / 100)
+
+// Entre duas amostras de um sensor passam o intervalo do perfil, o timing
+// budget e a folga do loop; tudo precisa caber antes do reflexo declarar a
+// leitura velha (os budgets são enum: _Static_assert em vez de #if)
+#define TOF_PROFILE_FITS_STALE(interval_ms, budget_us) \
+    ((interval_ms) * 1000u + (budget_us) + TOF_STALE_MARGIN_MS * 1000u < SAFETY_STALE_TIMEOUT_MS * 1000u)
+
+_Static_assert(TOF_PROFILE_FITS_STALE(TOF_INTERVAL_HIGH_SPEED_MS, VL53L0X_HIGH_SPEED),
+               "high_speed: intervalo + budget + folga >= SAFETY_STALE_TIMEOUT_MS");
+_Static_assert(TOF_PROFILE_FITS_STALE(TOF_INTERVAL_DEFAULT_MS, VL53L0X_DEFAULT_MODE),
+               "default: intervalo + budget + folga >= SAFETY_STALE_TIMEOUT_MS");
+_Static_assert(TOF_PROFILE_FITS_STALE(TOF_INTERVAL_LONG_RANGE_MS, VL53L0X_LONG_RANGE),
+               "long_range: intervalo + budget + folga >= SAFETY_STALE_TIMEOUT_MS");
+_Static_assert(TOF_PROFILE_FITS_STALE(TOF_INTERVAL_HIGH_ACCURACY_MS, VL53L0X_HIGHT_ACCURACY),
+               "high_accuracy: intervalo + budget + folga >= SAFETY_STALE_TIMEOUT_MS");
+
+// Períodos VCSEL válidos: pre-range 12..18, final-range 8..14 (pares).
+// 0 = mantém os períodos do perfil anterior: a troca urgente para o perfil
+// rápido não dispara a calibração de fase (bloqueante) da API da ST.
+static const tof_profile_t profiles[TOF_PROFILE_COUNT] = {
+    [TOF_PROFILE_HIGH_SPEED] = {
+        "high_speed", VL53L0X_HIGH_SPEED, 0, 0, MCPS(0.25), MM(32), TOF_INTERVAL_HIGH_SPEED_MS
+    },
+    [TOF_PROFILE_DEFAULT] = {
+        "default", VL53L0X_DEFAULT_MODE, 14, 10, MCPS(0.25), MM(32), TOF_INTERVAL_DEFAULT_MS
+    },
+    [TOF_PROFILE_LONG_RANGE] = {
+        "long_range", VL53L0X_LONG_RANGE, 18, 14, MCPS(0.1), MM(60), TOF_INTERVAL_LONG_RANGE_MS
+    },
+    [TOF_PROFILE_HIGH_ACCURACY] = {
+        "high_accuracy", VL53L0X_HIGHT_ACCURACY, 14, 10, MCPS(0.25), MM(18), TOF_INTERVAL_HIGH_ACCURACY_MS
+    },
+};
+
+static int32_t vehicle_speed_mm_s = TOF_VEHICLE_SPEED_UNKNOWN;
+
+// --- Funções Internas ---
+
+// Grava o período VCSEL só se mudou (cada gravação refaz a calibração de fase);
+// com o cache de registradores ligado a leitura não vai ao barramento
+static VL53L0X_Error tof_profile_set_vcsel(VL53L0X_Dev_t *pDevice, VL53L0X_VcselPeriod type,
+                                           uint8_t period) {
+    uint8_t current;
+    if (period == 0) return VL53L0X_ERROR_NONE;
+    if (VL53L0X_GetVcselPulsePeriod(pDevice, type, &current) == VL53L0X_ERROR_NONE &&
+        current == period) {
+        return VL53L0X_ERROR_NONE;
+    }
+    return VL53L0X_SetVcselPulsePeriod(pDevice, type, period);
+}
+
+// Perfil desejado com histerese nas faixas de distância
+static tof_profile_id_t tof_profile_desired(const tof_profile_manager_t *mgr, uint16_t filtered_mm,
+                                            int32_t closing_mm_s, FixPoint1616_t signal_rate,
+                                            bool no_target) {
+    uint16_t near_mm = (mgr->current == TOF_PROFILE_HIGH_SPEED) ? TOF_NEAR_EXIT_MM : TOF_NEAR_ENTER_MM;
+    uint16_t far_mm = (mgr->current == TOF_PROFILE_LONG_RANGE) ? TOF_FAR_EXIT_MM : TOF_FAR_ENTER_MM;
+
+    // Obstáculo se aproximando, próximo ou veículo rápido: mede o mais rápido possível
+    if (closing_mm_s >= TOF_APPROACH_MM_S ||
+        (!no_target && filtered_mm < near_mm) ||
+        vehicle_speed_mm_s >= TOF_FAST_VEHICLE_MM_S) {
+        return TOF_PROFILE_HIGH_SPEED;
+    }
+
+    // Nada no alcance, alvo distante ou sinal fraco: prioriza alcance
+    if (no_target || filtered_mm >= far_mm || signal_rate < WEAK_SIGNAL_Q16) {
+        return TOF_PROFILE_LONG_RANGE;
+    }
+
+    // Veículo comprovadamente parado: pode gastar mais tempo por medição
+#if TOF_ALLOW_HIGH_ACCURACY
+    if (vehicle_speed_mm_s == 0) return TOF_PROFILE_HIGH_ACCURACY;
+#endif
+
+    return TOF_PROFILE_DEFAULT;
+}
+
+// --- Funções Públicas (declaradas em tof_profile.h) ---
+
+void tof_profile_init(tof_profile_manager_t *mgr, tof_profile_id_t initial) {
+    mgr->current = initial;
+    mgr->candidate = initial;
+    mgr->candidate_count = 0;
+    mgr->last_switch_us = 0;
+    mgr->last_sample_us = 0;
+}
+
+VL53L0X_Error tof_profile_apply(VL53L0X_Dev_t *pDevice, tof_profile_id_t profile) {
+    const tof_profile_t *p = &profiles[profile];
+    VL53L0X_Error Status;
+
+    Status = VL53L0X_SetLimitCheckValue(pDevice,
+            VL53L0X_CHECKENABLE_SIGNAL_RATE_FINAL_RANGE, p->signal_limit_mcps);
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    Status = VL53L0X_SetLimitCheckValue(pDevice,
+            VL53L0X_CHECKENABLE_SIGMA_FINAL_RANGE, p->sigma_limit_mm);
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    Status = tof_profile_set_vcsel(pDevice, VL53L0X_VCSEL_PERIOD_PRE_RANGE, p->vcsel_pre_range);
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    Status = tof_profile_set_vcsel(pDevice, VL53L0X_VCSEL_PERIOD_FINAL_RANGE, p->vcsel_final_range);
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    // Budget por último: depende dos períodos VCSEL
+    return VL53L0X_SetMeasurementTimingBudgetMicroSeconds(pDevice, p->timing_budget_us);
+}
+
+bool tof_profile_due(const tof_profile_manager_t *mgr, uint32_t now_us) {
+    return (now_us - mgr->last_sample_us) >= profiles[mgr->current].sample_interval_ms * 1000;
+}
+
+uint32_t tof_profile_next_us(const tof_profile_manager_t *mgr) {
+    return mgr->last_sample_us + profiles[mgr->current].sample_interval_ms * 1000;
+}
+
+bool tof_profile_update(tof_profile_manager_t *mgr, uint16_t filtered_mm,
+                        int32_t closing_mm_s, FixPoint1616_t signal_rate,
+                        bool no_target, uint32_t now_us) {
+    mgr->last_sample_us = now_us;
+
+    tof_profile_id_t desired = tof_profile_desired(mgr, filtered_mm, closing_mm_s,
+                                                   signal_rate, no_target);
+    if (desired == mgr->current) {
+        mgr->candidate_count = 0;
+        return false;
+    }
+
+    // Perfil rápido entra sem espera (obstáculo se aproximando)
+    bool urgent = (desired == TOF_PROFILE_HIGH_SPEED);
+
+    if (desired != mgr->candidate) {
+        mgr->candidate = desired;
+        mgr->candidate_count = 0;
+    }
+    if (mgr->candidate_count < UINT8_MAX) mgr->candidate_count++;
+
+    if (!urgent) {
+        if (mgr->candidate_count < TOF_PROFILE_CONFIRM) return false;
+        if ((now_us - mgr->last_switch_us) < TOF_PROFILE_MIN_DWELL_MS * 1000) return false;
+    }
+
+    mgr->current = desired;
+    mgr->candidate_count = 0;
+    mgr->last_switch_us = now_us;
+    return true;
+}
+
+void tof_profile_set_vehicle_speed(int32_t speed_mm_s) {
+    vehicle_speed_mm_s = speed_mm_s;
+}
+
+const tof_profile_t *tof_profile_get(tof_profile_id_t profile) {
+    return &profiles[profile];
+}
+
+const char *tof_profile_name(tof_profile_id_t profile) {
+    return profile < TOF_PROFILE_COUNT ? profiles[profile].name : "unknown";
+}
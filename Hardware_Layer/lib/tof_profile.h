@@ -0,0 +1,77 @@
+#ifndef TOF_PROFILE_H
+#define TOF_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+#include "vl53l0x_api.h"
+
+// =====================================================
+// Perfis de medição do VL53L0X por sensor
+//
+// Cada sensor alterna em tempo de execução entre perfis (timing budget,
+// períodos VCSEL e limites de sinal/sigma) conforme a distância filtrada,
+// a velocidade de aproximação, a taxa de sinal e a velocidade do veículo.
+// O sensor com obstáculo se aproximando mede no perfil rápido e a cada
+// iteração; sensores ociosos medem com menos frequência e ocupam menos o
+// barramento. Trocas para o perfil rápido são imediatas; as demais exigem
+// TOF_PROFILE_CONFIRM avaliações seguidas e TOF_PROFILE_MIN_DWELL_MS.
+// =====================================================
+
+typedef enum {
+    TOF_PROFILE_HIGH_SPEED = 0,     // ~20 ms, alcance menor, VCSEL do perfil anterior
+    TOF_PROFILE_DEFAULT,            // ~33 ms
+    TOF_PROFILE_LONG_RANGE,         // ~33 ms, VCSEL longo e limite de sinal baixo
+    TOF_PROFILE_HIGH_ACCURACY,      // ~200 ms, apenas com o veículo parado
+    TOF_PROFILE_COUNT
+} tof_profile_id_t;
+
+// Parâmetros de um perfil
+typedef struct {
+    const char *name;
+    uint32_t timing_budget_us;
+    uint8_t vcsel_pre_range;        // 0 = mantém o período atual
+    uint8_t vcsel_final_range;
+    FixPoint1616_t signal_limit_mcps;
+    FixPoint1616_t sigma_limit_mm;
+    uint32_t sample_interval_ms;    // Intervalo mínimo entre medições do sensor
+} tof_profile_t;
+
+// Estado do gerenciador de um sensor
+typedef struct {
+    tof_profile_id_t current;
+    tof_profile_id_t candidate;
+    uint8_t candidate_count;
+    uint32_t last_switch_us;
+    uint32_t last_sample_us;
+} tof_profile_manager_t;
+
+// Velocidade do veículo desconhecida (sem odometria)
+#define TOF_VEHICLE_SPEED_UNKNOWN   (-1)
+
+// Inicializa o gerenciador no perfil indicado (não acessa o sensor)
+void tof_profile_init(tof_profile_manager_t *mgr, tof_profile_id_t initial);
+
+// Aplica os parâmetros do perfil no sensor (canal do mux já selecionado)
+VL53L0X_Error tof_profile_apply(VL53L0X_Dev_t *pDevice, tof_profile_id_t profile);
+
+// Verdadeiro se o intervalo do perfil atual já passou desde a última medição
+bool tof_profile_due(const tof_profile_manager_t *mgr, uint32_t now_us);
+
+// Instante (time_us_32) em que o sensor volta a estar devido
+uint32_t tof_profile_next_us(const tof_profile_manager_t *mgr);
+
+// Avalia a próxima medição; retorna true se o perfil deve ser trocado
+// (novo perfil em mgr->current; chamar tof_profile_apply em seguida)
+bool tof_profile_update(tof_profile_manager_t *mgr, uint16_t filtered_mm,
+                        int32_t closing_mm_s, FixPoint1616_t signal_rate,
+                        bool no_target, uint32_t now_us);
+
+// Velocidade atual do veículo em mm/s (ou TOF_VEHICLE_SPEED_UNKNOWN)
+void tof_profile_set_vehicle_speed(int32_t speed_mm_s);
+
+// Parâmetros/nome de um perfil
+const tof_profile_t *tof_profile_get(tof_profile_id_t profile);
+const char *tof_profile_name(tof_profile_id_t profile);
+
+#endif // TOF_PROFILE_H
@@ -55,6 +55,23 @@ extern "C" {
  * @brief    Generic PAL device type that does link between API and platform abstraction layer
  *
  */
+struct i2c_bus;
+struct tca9548a;
+
+/**
+ * @struct  VL53L0X_Shadow_t
+ * @brief   Cópia write-through dos registradores de configuração (página 0)
+ */
+typedef struct {
+    uint8_t   regs[256];                 /*!< Último valor lido/escrito de cada registrador           */
+    uint32_t  valid[8];                  /*!< 1 bit por registrador: valor em regs[] é confiável      */
+    uint8_t   page;                      /*!< Último valor escrito em 0xFF (página != 0: sem cache)   */
+    uint8_t   priv;                      /*!< Último valor escrito em 0x80 (acesso interno: sem cache) */
+    uint8_t   enabled;                   /*!< Cache ativo (ligado só após a inicialização)            */
+    uint32_t  hits;                      /*!< Leituras atendidas pelo cache                           */
+    uint32_t  misses;                    /*!< Leituras cacheáveis que foram ao barramento             */
+} VL53L0X_Shadow_t;
+
 typedef struct {
     VL53L0X_DevData_t Data;               /*!< embed ST Ewok Dev  data as "Data"*/
 
@@ -63,6 +80,11 @@ typedef struct {
     uint8_t   comms_type;                /*!< Type of comms : VL53L0X_COMMS_I2C or VL53L0X_COMMS_SPI */
     uint16_t  comms_speed_khz;           /*!< Comms speed [kHz] : typically 400kHz for I2C           */
 
+    struct i2c_bus *bus;                 /*!< Barramento do sensor (transporte via i2c_bus_ops_t)    */
+    struct tca9548a *mux;                /*!< Multiplexador na frente do sensor ou NULL              */
+    uint8_t   mux_channel;               /*!< Canal do multiplexador (ignorado se mux == NULL)        */
+    VL53L0X_Shadow_t Shadow;             /*!< Cache de registradores (ver VL53L0X_ShadowEnable)       */
+
 } VL53L0X_Dev_t;
 
 
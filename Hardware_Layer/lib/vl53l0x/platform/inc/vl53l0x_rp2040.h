@@ -5,7 +5,8 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-#include "hardware/i2c.h"
+#include "i2c_bus.h"
+#include "tca9548a.h"
 #include "vl53l0x_platform.h"
 
 #define    BYTES_PER_WORD        2
@@ -20,24 +21,69 @@ enum {
 };
 extern int RANGE_PROFILE; // Declara como extern para evitar múltiplas definições
 
+// Amostra completa de uma medição (qualidade do sinal incluída)
+typedef struct {
+    uint16_t RangeMilliMeter;           // Distância medida (mm)
+    uint8_t RangeStatus;                // 0 = válida; 1 sigma, 2 sinal, 3 alcance mínimo, 4 fase, 5 hardware
+    FixPoint1616_t SignalRateMegaCps;   // Taxa de retorno do sinal (MCPS, Q16.16)
+    FixPoint1616_t AmbientRateMegaCps;  // Taxa de luz ambiente (MCPS, Q16.16)
+    uint16_t EffectiveSpadCount;        // SPADs efetivos (Q8.8)
+} VL53L0X_RangeSample_t;
 
-int32_t VL53L0X_write_multi(uint8_t address, uint8_t index, uint8_t  *pdata, int32_t count);
-int32_t VL53L0X_read_multi(uint8_t address,  uint8_t index, uint8_t  *pdata, int32_t count);
-int32_t VL53L0X_write_byte(uint8_t address,  uint8_t index, uint8_t   data);
-int32_t VL53L0X_write_word(uint8_t address,  uint8_t index, uint16_t  data);
-int32_t VL53L0X_write_dword(uint8_t address, uint8_t index, uint32_t  data);
-int32_t VL53L0X_read_byte(uint8_t address,  uint8_t index, uint8_t  *pdata);
-int32_t VL53L0X_read_word(uint8_t address,  uint8_t index, uint16_t *pdata);
-int32_t VL53L0X_read_dword(uint8_t address, uint8_t index, uint32_t *pdata);
+
+int32_t VL53L0X_write_multi(VL53L0X_DEV Dev, uint8_t index, uint8_t  *pdata, int32_t count);
+int32_t VL53L0X_read_multi(VL53L0X_DEV Dev,  uint8_t index, uint8_t  *pdata, int32_t count);
+int32_t VL53L0X_write_byte(VL53L0X_DEV Dev,  uint8_t index, uint8_t   data);
+int32_t VL53L0X_write_word(VL53L0X_DEV Dev,  uint8_t index, uint16_t  data);
+int32_t VL53L0X_write_dword(VL53L0X_DEV Dev, uint8_t index, uint32_t  data);
+int32_t VL53L0X_read_byte(VL53L0X_DEV Dev,  uint8_t index, uint8_t  *pdata);
+int32_t VL53L0X_read_word(VL53L0X_DEV Dev,  uint8_t index, uint16_t *pdata);
+int32_t VL53L0X_read_dword(VL53L0X_DEV Dev, uint8_t index, uint32_t *pdata);
 
 VL53L0X_Error VL53L0X_device_initizlise(VL53L0X_Dev_t *pDevice, uint32_t RangeProfile);
+VL53L0X_Error VL53L0X_device_base_initialise(VL53L0X_Dev_t *pDevice);
+
+// Só associa o sensor ao barramento/canal (não acessa o dispositivo)
+void VL53L0X_dev_i2c_attach(VL53L0X_Dev_t *pDevice, i2c_bus_t *bus,
+    tca9548a_t *mux, uint8_t mux_channel, uint8_t address);
 
-VL53L0X_Error VL53L0X_dev_i2c_default_initialise(VL53L0X_Dev_t *pDevice, uint32_t RangeProfile);
-VL53L0X_Error VL53L0X_dev_i2c_initialise(VL53L0X_Dev_t *pDevice,
-    i2c_inst_t* i2c_port, uint sda, uint scl, uint16_t i2c_speed_k, uint32_t RangeProfile);
+// Associa o sensor ao barramento/canal e inicializa apenas o dispositivo
+// (o barramento deve ter sido configurado antes com i2c_bus_init_hw)
+VL53L0X_Error VL53L0X_dev_i2c_initialise(VL53L0X_Dev_t *pDevice, i2c_bus_t *bus,
+    tca9548a_t *mux, uint8_t mux_channel, uint8_t address, uint32_t RangeProfile);
 void vl53l0x_print_device_info(VL53L0X_Dev_t *pDevice);
 
+// Cache de registradores de configuração: ligar após a inicialização/calibração.
+// Registradores voláteis (status, resultado, calibração) continuam indo ao barramento.
+void VL53L0X_ShadowEnable(VL53L0X_DEV Dev, uint8_t enable);
+void VL53L0X_ShadowInvalidate(VL53L0X_DEV Dev);
+
 VL53L0X_Error VL53L0X_SingleRanging(VL53L0X_Dev_t *pDevice, uint16_t *MeasureData);
+VL53L0X_Error VL53L0X_SingleRangingSample(VL53L0X_Dev_t *pDevice, VL53L0X_RangeSample_t *pSample);
+VL53L0X_Error VL53L0X_StartSingleRanging(VL53L0X_Dev_t *pDevice);
+VL53L0X_Error VL53L0X_PollRangingSample(VL53L0X_Dev_t *pDevice, VL53L0X_RangeSample_t *pSample,
+                                        uint8_t *pReady);
+
+// Máximo de sensores lidos juntos em uma rodada
+#define VL53L0X_GROUP_MAX I2C_BUS_GROUP_MAX
+
+// Lê o mesmo bloco de registradores voláteis de vários sensores; os ligados
+// direto em barramentos distintos são lidos juntos (paralelo nos barramentos PIO)
+void VL53L0X_ReadMultiGroup(VL53L0X_DEV const Devs[], uint8_t index, uint8_t *const bufs[],
+                            uint32_t count, VL53L0X_Error status[], uint8_t n);
+
+// Versões para vários sensores pendentes (pStatus[i]/pReady[i] por sensor)
+void VL53L0X_PollRangingGroup(VL53L0X_Dev_t *const pDevices[], VL53L0X_RangeSample_t pSamples[],
+                              uint8_t pReady[], VL53L0X_Error pStatus[], uint8_t count);
+
+// Caminho enxuto para medições em regime permanente (mesma interface de
+// StartSingleRanging/PollRangingSample): menos transações e sem a cadeia de
+// chamadas da API. Inicialização e calibração continuam pela API da ST.
+VL53L0X_Error VL53L0X_LeanStartRanging(VL53L0X_Dev_t *pDevice);
+VL53L0X_Error VL53L0X_LeanPollRanging(VL53L0X_Dev_t *pDevice, VL53L0X_RangeSample_t *pSample,
+                                      uint8_t *pReady);
+void VL53L0X_LeanPollRangingGroup(VL53L0X_Dev_t *const pDevices[], VL53L0X_RangeSample_t pSamples[],
+                                  uint8_t pReady[], VL53L0X_Error pStatus[], uint8_t count);
 VL53L0X_Error VL53L0X_ContinuousRanging(VL53L0X_Dev_t *pDevice, uint16_t *MeasuredData, uint16_t RangeCount, uint16_t *validCount);
 
 
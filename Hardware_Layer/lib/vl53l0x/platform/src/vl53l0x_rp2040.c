@@ -5,55 +5,48 @@
 #include "vl53l0x_rp2040.h"
 #include "string.h"
 #include "vl53l0x_api.h"
+#include "vl53l0x_api_core.h"
+#include "config.h"
+
+#if VL53L0X_BURST_TUNING
+#include "vl53l0x_tuning_burst.h"
+#endif
 
 #define STATUS_OK              0x00
 #define STATUS_FAIL            0x01
 
-//i2c_inst_t* vl53l0x_i2c_port = i2c_default;
-//uint vl53l0x_i2c_sda = PICO_DEFAULT_I2C_SDA_PIN;
-//uint vl53l0x_i2c_scl = PICO_DEFAULT_I2C_SCL_PIN;
-
-i2c_inst_t* vl53l0x_i2c_port = i2c1;
-uint vl53l0x_i2c_sda = 2;
-uint vl53l0x_i2c_scl = 3;
-
-
-
+// O barramento (i2c_bus_t) e o canal do multiplexador ficam em cada
+// VL53L0X_Dev_t: sensores em barramentos diferentes não compartilham estado.
 
-VL53L0X_Error VL53L0X_dev_i2c_default_initialise(VL53L0X_Dev_t *pDevice, uint32_t RangeProfile) {
-    VL53L0X_Error Status;
-    i2c_init(vl53l0x_i2c_port, 400 * 1000);
-    gpio_set_function(vl53l0x_i2c_sda, GPIO_FUNC_I2C);
-    gpio_set_function(vl53l0x_i2c_scl, GPIO_FUNC_I2C);
-    gpio_pull_up(vl53l0x_i2c_sda);
-    gpio_pull_up(vl53l0x_i2c_scl);
-
-    Status = VL53L0X_device_initizlise(pDevice, RangeProfile);
-
-    return Status;
+void VL53L0X_dev_i2c_attach(VL53L0X_Dev_t *pDevice, i2c_bus_t *bus,
+    tca9548a_t *mux, uint8_t mux_channel, uint8_t address)
+{
+    // Barramento já configurado por i2c_bus_init_hw (uma vez por barramento)
+    pDevice->I2cDevAddr = address;
+    pDevice->comms_type = 1;
+    pDevice->comms_speed_khz = (uint16_t)(bus->baudrate / 1000);
+    pDevice->bus = bus;
+    pDevice->mux = mux;
+    pDevice->mux_channel = mux_channel;
+
+    // Sensor recém-ligado está na página 0; cache desligado até o fim da inicialização
+    memset(&pDevice->Shadow, 0, sizeof(pDevice->Shadow));
 }
 
-VL53L0X_Error VL53L0X_dev_i2c_initialise(VL53L0X_Dev_t *pDevice,
-    i2c_inst_t* i2c_port, uint sda, uint scl, uint16_t i2c_speed_k, uint32_t RangeProfile)
+VL53L0X_Error VL53L0X_dev_i2c_initialise(VL53L0X_Dev_t *pDevice, i2c_bus_t *bus,
+    tca9548a_t *mux, uint8_t mux_channel, uint8_t address, uint32_t RangeProfile)
 {
     VL53L0X_Error Status;
-    vl53l0x_i2c_port = i2c_port;
-    vl53l0x_i2c_sda = sda;
-    vl53l0x_i2c_scl = scl;
-
-    i2c_init(vl53l0x_i2c_port, i2c_speed_k * 1000);
-    gpio_set_function(vl53l0x_i2c_sda, GPIO_FUNC_I2C);
-    gpio_set_function(vl53l0x_i2c_scl, GPIO_FUNC_I2C);
-    gpio_pull_up(vl53l0x_i2c_sda);
-    gpio_pull_up(vl53l0x_i2c_scl);
 
+    VL53L0X_dev_i2c_attach(pDevice, bus, mux, mux_channel, address);
     Status = VL53L0X_device_initizlise(pDevice, RangeProfile);
     return Status;
 }
 
-VL53L0X_Error VL53L0X_device_initizlise(VL53L0X_Dev_t *pDevice, uint32_t RangeProfile) {
+// Inicialização e calibração sem limites/timing/VCSEL: para quem aplica um
+// perfil logo em seguida (evita calibrar a fase duas vezes)
+VL53L0X_Error VL53L0X_device_base_initialise(VL53L0X_Dev_t *pDevice) {
     VL53L0X_Error Status = VL53L0X_ERROR_NONE;
-    int i;
     uint32_t refSpadCount;
     uint8_t isApertureSpads;
     uint8_t VhvSettings;
@@ -62,6 +55,13 @@ VL53L0X_Error VL53L0X_device_initizlise(VL53L0X_Dev_t *pDevice, uint32_t RangePr
     Status = VL53L0X_DataInit(pDevice); 
     if(Status != VL53L0X_ERROR_NONE) return Status;
 
+#if VL53L0X_BURST_TUNING
+    // Tabela de tuning gerada com escritas contíguas agrupadas em rajadas
+    // (tools/gen_vl53l0x_tuning.py); lida por VL53L0X_StaticInit
+    Status = VL53L0X_SetTuningSettingBuffer(pDevice, (uint8_t *)VL53L0X_TuningSettingsBurst, 0);
+    if(Status != VL53L0X_ERROR_NONE) return Status;
+#endif
+
     Status = VL53L0X_StaticInit(pDevice); // Device Initialization
     if(Status != VL53L0X_ERROR_NONE) return Status;
    
@@ -79,7 +79,14 @@ VL53L0X_Error VL53L0X_device_initizlise(VL53L0X_Dev_t *pDevice, uint32_t RangePr
 
     Status = VL53L0X_SetLimitCheckEnable(pDevice,
         		VL53L0X_CHECKENABLE_SIGNAL_RATE_FINAL_RANGE, 1);
-    if(Status != VL53L0X_ERROR_NONE) return Status;	
+    return Status;
+}
+
+VL53L0X_Error VL53L0X_device_initizlise(VL53L0X_Dev_t *pDevice, uint32_t RangeProfile) {
+    VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+
+    Status = VL53L0X_device_base_initialise(pDevice);
+    if(Status != VL53L0X_ERROR_NONE) return Status;
    
     Status = VL53L0X_SetLimitCheckValue(pDevice,
             VL53L0X_CHECKENABLE_SIGNAL_RATE_FINAL_RANGE,
@@ -106,55 +113,202 @@ VL53L0X_Error VL53L0X_device_initizlise(VL53L0X_Dev_t *pDevice, uint32_t RangePr
     return Status;
 }
 
-int32_t VL53L0X_write_multi(uint8_t address, uint8_t index, uint8_t *pdata, int32_t count)
+// ========== CACHE DE REGISTRADORES (SHADOW) ==========
+
+#define SHADOW_PAGE_REG     0xFF
+#define SHADOW_PRIV_REG     0x80
+
+// Registradores que o próprio sensor altera: sempre lidos do barramento
+static bool VL53L0X_shadow_volatile(uint8_t reg)
 {
-    int32_t status = STATUS_OK;
-    uint8_t i2c_buff[count+1];
-    i2c_buff[0] = index;
-    memcpy(i2c_buff+1, pdata, count);
-    if ( i2c_write_blocking(vl53l0x_i2c_port, address, i2c_buff, count+1, false) == PICO_ERROR_GENERIC) {
-        status = STATUS_FAIL;
+    switch (reg) {
+        case 0x00:                  // SYSRANGE_START (bit de início volta a 0)
+        case 0x0B:                  // SYSTEM_INTERRUPT_CLEAR
+        case 0x13:                  // RESULT_INTERRUPT_STATUS
+        case 0x83:                  // Strobe de leitura da NVM
+        case 0xCB:                  // Resultado da calibração VHV
+        case 0xEE:                  // Resultado da calibração de fase
+        case SHADOW_PRIV_REG:
+        case SHADOW_PAGE_REG:
+            return true;
+        default:
+            // Bloco de resultado da medição e porta de dados da NVM
+            return (reg >= 0x14 && reg <= 0x1F) || (reg >= 0x90 && reg <= 0x94);
     }
-    return status;
 }
 
-int32_t VL53L0X_read_multi(uint8_t address, uint8_t index, uint8_t *pdata, int32_t count)
+static inline bool VL53L0X_shadow_active(const VL53L0X_Shadow_t *sh)
 {
-    int32_t status = STATUS_OK;
+    return sh->enabled && sh->page == 0 && sh->priv == 0;
+}
 
-    int i2c_ret = i2c_write_blocking(vl53l0x_i2c_port, address, &index, 1, true);
-    if (i2c_ret == PICO_ERROR_GENERIC) return STATUS_FAIL;
-    i2c_ret = i2c_read_blocking(vl53l0x_i2c_port, address, pdata, count, false);
-    if (i2c_ret == PICO_ERROR_GENERIC) return STATUS_FAIL;
-    return status;
+static inline bool VL53L0X_shadow_is_valid(const VL53L0X_Shadow_t *sh, uint8_t reg)
+{
+    return (sh->valid[reg >> 5] >> (reg & 31)) & 1u;
+}
+
+static inline void VL53L0X_shadow_set_valid(VL53L0X_Shadow_t *sh, uint8_t reg, bool valid)
+{
+    if (valid) sh->valid[reg >> 5] |= 1u << (reg & 31);
+    else sh->valid[reg >> 5] &= ~(1u << (reg & 31));
+}
+
+// Tenta atender a leitura pelo cache (todos os bytes válidos e não voláteis)
+static bool VL53L0X_shadow_read(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, int32_t count)
+{
+    VL53L0X_Shadow_t *sh = &Dev->Shadow;
+    if (!VL53L0X_shadow_active(sh) || index + count > 256) return false;
+
+    for (int32_t i = 0; i < count; i++) {
+        if (VL53L0X_shadow_volatile(index + i)) return false;
+    }
+    for (int32_t i = 0; i < count; i++) {
+        if (!VL53L0X_shadow_is_valid(sh, index + i)) {
+            sh->misses++;
+            return false;
+        }
+    }
+
+    memcpy(pdata, &sh->regs[index], count);
+    sh->hits++;
+    return true;
+}
+
+// Guarda no cache o que foi lido do barramento
+static void VL53L0X_shadow_fill(VL53L0X_DEV Dev, uint8_t index, const uint8_t *pdata, int32_t count)
+{
+    VL53L0X_Shadow_t *sh = &Dev->Shadow;
+    if (!VL53L0X_shadow_active(sh)) return;
+
+    for (int32_t i = 0; i < count && index + i < 256; i++) {
+        uint8_t reg = index + i;
+        if (VL53L0X_shadow_volatile(reg)) continue;
+        sh->regs[reg] = pdata[i];
+        VL53L0X_shadow_set_valid(sh, reg, true);
+    }
+}
+
+// Write-through: acompanha página/acesso interno e atualiza (ou invalida) o cache
+static void VL53L0X_shadow_write(VL53L0X_DEV Dev, uint8_t index, const uint8_t *pdata,
+                                 int32_t count, bool ok)
+{
+    VL53L0X_Shadow_t *sh = &Dev->Shadow;
+
+    for (int32_t i = 0; i < count && index + i < 256; i++) {
+        uint8_t reg = index + i;
+        if (reg == SHADOW_PAGE_REG) {
+            // Falha deixa a página desconhecida: cache fica de fora até nova escrita
+            sh->page = ok ? pdata[i] : 0xFF;
+        } else if (reg == SHADOW_PRIV_REG) {
+            sh->priv = ok ? pdata[i] : 0x01;
+        } else if (VL53L0X_shadow_active(sh) && !VL53L0X_shadow_volatile(reg)) {
+            sh->regs[reg] = pdata[i];
+            VL53L0X_shadow_set_valid(sh, reg, ok);
+        }
+    }
+}
+
+void VL53L0X_ShadowEnable(VL53L0X_DEV Dev, uint8_t enable)
+{
+    VL53L0X_Shadow_t *sh = &Dev->Shadow;
+    memset(sh->valid, 0, sizeof(sh->valid));
+    sh->enabled = enable;
+}
+
+void VL53L0X_ShadowInvalidate(VL53L0X_DEV Dev)
+{
+    memset(Dev->Shadow.valid, 0, sizeof(Dev->Shadow.valid));
 }
 
+// ========== TRANSPORTE ==========
 
-int32_t VL53L0X_write_byte(uint8_t address, uint8_t index, uint8_t data)
+// Ativa o canal do sensor antes de cada transação (o mux guarda o canal atual)
+static bool VL53L0X_select(VL53L0X_DEV Dev)
+{
+    if (Dev->mux == NULL) return true;
+    return tca9548a_select_channel(Dev->mux, Dev->mux_channel);
+}
+
+int32_t VL53L0X_write_multi(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, int32_t count)
+{
+    bool ok = VL53L0X_select(Dev) &&
+              i2c_bus_write_reg(Dev->bus, Dev->I2cDevAddr, index, pdata, count);
+
+    VL53L0X_shadow_write(Dev, index, pdata, count, ok);
+    return ok ? STATUS_OK : STATUS_FAIL;
+}
+
+int32_t VL53L0X_read_multi(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, int32_t count)
+{
+    if (VL53L0X_shadow_read(Dev, index, pdata, count)) return STATUS_OK;
+
+    if (!VL53L0X_select(Dev)) return STATUS_FAIL;
+    if (!i2c_bus_read_reg(Dev->bus, Dev->I2cDevAddr, index, pdata, count)) return STATUS_FAIL;
+
+    VL53L0X_shadow_fill(Dev, index, pdata, count);
+    return STATUS_OK;
+}
+
+// Mesmo bloco de registradores voláteis de vários sensores (sem cache).
+// Sensores ligados direto em barramentos distintos são lidos juntos
+// (i2c_bus_read_reg_group: em paralelo nos barramentos PIO); os que estão
+// atrás de multiplexador, um por vez, pois o canal precisa ser trocado.
+void VL53L0X_ReadMultiGroup(VL53L0X_DEV const Devs[], uint8_t index, uint8_t *const bufs[],
+                            uint32_t count, VL53L0X_Error status[], uint8_t n)
+{
+    i2c_bus_t *buses[VL53L0X_GROUP_MAX];
+    uint8_t addrs[VL53L0X_GROUP_MAX];
+    uint8_t *dsts[VL53L0X_GROUP_MAX];
+    bool ok[VL53L0X_GROUP_MAX];
+    uint8_t group_index[VL53L0X_GROUP_MAX];
+    uint8_t direct = 0;
+
+    for (uint8_t i = 0; i < n; i++) {
+        VL53L0X_DEV Dev = Devs[i];
+        if (Dev->mux == NULL && direct < VL53L0X_GROUP_MAX) {
+            buses[direct] = Dev->bus;
+            addrs[direct] = Dev->I2cDevAddr;
+            dsts[direct] = bufs[i];
+            group_index[direct++] = i;
+            continue;
+        }
+        bool read_ok = VL53L0X_select(Dev) &&
+                       i2c_bus_read_reg(Dev->bus, Dev->I2cDevAddr, index, bufs[i], count);
+        status[i] = read_ok ? VL53L0X_ERROR_NONE : VL53L0X_ERROR_CONTROL_INTERFACE;
+    }
+
+    i2c_bus_read_reg_group(buses, addrs, index, dsts, count, ok, direct);
+    for (uint8_t k = 0; k < direct; k++) {
+        status[group_index[k]] = ok[k] ? VL53L0X_ERROR_NONE : VL53L0X_ERROR_CONTROL_INTERFACE;
+    }
+}
+
+
+int32_t VL53L0X_write_byte(VL53L0X_DEV Dev, uint8_t index, uint8_t data)
 {
     int32_t status = STATUS_OK;
 
-    status = VL53L0X_write_multi(address, index, &data, 1);
+    status = VL53L0X_write_multi(Dev, index, &data, 1);
 
     return status;
 
 }
 
 
-int32_t VL53L0X_write_word(uint8_t address, uint8_t index, uint16_t data)
+int32_t VL53L0X_write_word(VL53L0X_DEV Dev, uint8_t index, uint16_t data)
 {
     int32_t status = STATUS_OK;
     uint8_t  buffer[BYTES_PER_WORD];
     // Split 16-bit word into MS and LS uint8_t
     buffer[0] = (uint8_t)(data >> 8);
     buffer[1] = (uint8_t)(data &  0x00FF);
-    status = VL53L0X_write_multi(address, index, buffer, BYTES_PER_WORD);
+    status = VL53L0X_write_multi(Dev, index, buffer, BYTES_PER_WORD);
     return status;
 
 }
 
 
-int32_t VL53L0X_write_dword(uint8_t address, uint8_t index, uint32_t data)
+int32_t VL53L0X_write_dword(VL53L0X_DEV Dev, uint8_t index, uint32_t data)
 {
     int32_t status = STATUS_OK;
     uint8_t  buffer[BYTES_PER_DWORD];
@@ -163,53 +317,290 @@ int32_t VL53L0X_write_dword(uint8_t address, uint8_t index, uint32_t data)
     buffer[1] = (uint8_t)((data &  0x00FF0000) >> 16);
     buffer[2] = (uint8_t)((data &  0x0000FF00) >> 8);
     buffer[3] = (uint8_t) (data &  0x000000FF);
-    status = VL53L0X_write_multi(address, index, buffer, BYTES_PER_DWORD);
+    status = VL53L0X_write_multi(Dev, index, buffer, BYTES_PER_DWORD);
     return status;
 }
 
 
-int32_t VL53L0X_read_byte(uint8_t address, uint8_t index, uint8_t *pdata)
+int32_t VL53L0X_read_byte(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata)
 {
     int32_t status = STATUS_OK;
     int32_t cbyte_count = 1;
-    status = VL53L0X_read_multi(address, index, pdata, cbyte_count);
+    status = VL53L0X_read_multi(Dev, index, pdata, cbyte_count);
     return status;
 }
 
-int32_t VL53L0X_read_word(uint8_t address, uint8_t index, uint16_t *pdata)
+int32_t VL53L0X_read_word(VL53L0X_DEV Dev, uint8_t index, uint16_t *pdata)
 {
     int32_t  status = STATUS_OK;
     	uint8_t  buffer[BYTES_PER_WORD];
     
-    status = VL53L0X_read_multi(address, index, buffer, BYTES_PER_WORD);
+    status = VL53L0X_read_multi(Dev, index, buffer, BYTES_PER_WORD);
 
 	*pdata = ((uint16_t)buffer[0] << 8) + (uint16_t)buffer[1];
 
     return status;
 }
 
-int32_t VL53L0X_read_dword(uint8_t address, uint8_t index, uint32_t *pdata)
+int32_t VL53L0X_read_dword(VL53L0X_DEV Dev, uint8_t index, uint32_t *pdata)
 {
     int32_t status = STATUS_OK;
 	uint8_t  buffer[BYTES_PER_DWORD];
-    status = VL53L0X_read_multi(address, index, buffer, BYTES_PER_DWORD);
+    status = VL53L0X_read_multi(Dev, index, buffer, BYTES_PER_DWORD);
     *pdata = ((uint32_t)buffer[0] << 24) + ((uint32_t)buffer[1] << 16) + ((uint32_t)buffer[2] << 8) + (uint32_t)buffer[3];
     return status;
 }
 
 
+// Dispara uma medição única e retorna sem esperar o resultado.
+// Sensores em barramentos/canais diferentes medem em paralelo: dispara todos
+// e depois consulta cada um com VL53L0X_PollRangingSample.
+VL53L0X_Error VL53L0X_StartSingleRanging(VL53L0X_Dev_t *pDevice) {
+    VL53L0X_Error Status;
+
+    Status = VL53L0X_SetDeviceMode(pDevice, VL53L0X_DEVICEMODE_SINGLE_RANGING); // Setup in single ranging mode
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    return VL53L0X_StartMeasurement(pDevice);
+}
+
+// Verifica se a medição disparada terminou; se sim, lê a amostra preservando
+// status e qualidade do sinal e limpa a interrupção (*pReady = 1).
+// Retorna erro apenas em falha de comunicação; RangeStatus != 0 é repassado
+// na amostra para o chamador decidir (rejeitar, ponderar, "sem alvo").
+VL53L0X_Error VL53L0X_PollRangingSample(VL53L0X_Dev_t *pDevice, VL53L0X_RangeSample_t *pSample,
+                                        uint8_t *pReady) {
+    VL53L0X_Error Status;
+    VL53L0X_RangingMeasurementData_t RangingMeasurementData;
+
+    *pReady = 0;
+    Status = VL53L0X_GetMeasurementDataReady(pDevice, pReady);
+    if (Status != VL53L0X_ERROR_NONE || *pReady != 1) return Status;
+
+    Status = VL53L0X_GetRangingMeasurementData(pDevice, &RangingMeasurementData);
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    Status = VL53L0X_ClearInterruptMask(pDevice, 0);
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    // Mesmo estado que VL53L0X_PerformSingleMeasurement deixa ao terminar
+    PALDevDataSet(pDevice, PalState, VL53L0X_STATE_IDLE);
+
+    memset(pSample, 0, sizeof(*pSample));
+    pSample->RangeMilliMeter = RangingMeasurementData.RangeMilliMeter;
+    pSample->RangeStatus = RangingMeasurementData.RangeStatus;
+    pSample->SignalRateMegaCps = RangingMeasurementData.SignalRateRtnMegaCps;
+    pSample->AmbientRateMegaCps = RangingMeasurementData.AmbientRateRtnMegaCps;
+    pSample->EffectiveSpadCount = RangingMeasurementData.EffectiveSpadRtnCount;
+    return Status;
+}
+
+// VL53L0X_PollRangingSample para vários sensores (um após o outro)
+void VL53L0X_PollRangingGroup(VL53L0X_Dev_t *const pDevices[], VL53L0X_RangeSample_t pSamples[],
+                              uint8_t pReady[], VL53L0X_Error pStatus[], uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        pStatus[i] = VL53L0X_PollRangingSample(pDevices[i], &pSamples[i], &pReady[i]);
+    }
+}
+
+// ========== MEDIÇÃO ENXUTA (REGIME PERMANENTE) ==========
+// Mesmo protocolo de VL53L0X_StartMeasurement / GetMeasurementDataReady /
+// GetRangingMeasurementData / ClearInterruptMask, sem a cadeia de chamadas da
+// API: o status da interrupção e o bloco de resultado (0x13..0x1F) vêm numa
+// única leitura. A API da ST continua fazendo inicialização e calibração.
+// Não aplica compensação de crosstalk nem ganho de linearidade (desligados
+// neste firmware); o limite de sinal de referência (SIGNAL_REF_CLIP) só é
+// verificado com VL53L0X_LEAN_REF_CLIP, pois exige ler a página 1.
+
+#define LEAN_RESULT_BYTES       13      // 0x13 (interrupção) + 0x14..0x1F (resultado)
+
+// DeviceRangeStatus -> RangeStatus da API (VL53L0X_get_pal_range_status)
+static uint8_t VL53L0X_lean_range_status(uint8_t device_status, bool sigma_fail, bool ref_clip_fail)
+{
+    switch (device_status) {
+        case 0: case 5: case 7: case 12: case 13: case 14: case 15:
+            return 255;                 // Nenhum resultado
+        case 1: case 2: case 3:
+            return 5;                   // Falha de hardware
+        case 6: case 9:
+            return 4;                   // Falha de fase
+        case 8: case 10:
+            return 3;                   // Alcance mínimo
+        case 4:
+            return 2;                   // Sinal fraco
+        default:
+            if (ref_clip_fail) return 3;
+            return sigma_fail ? 1 : 0;
+    }
+}
+
+// Sigma estimado pela própria API (só contas, sem acesso ao barramento)
+static bool VL53L0X_lean_sigma_fail(VL53L0X_DEV Dev, const VL53L0X_RangeSample_t *pSample,
+                                    uint8_t device_status)
+{
+    uint8_t enabled;
+    FixPoint1616_t limit, sigma;
+    VL53L0X_RangingMeasurementData_t data;
+
+    VL53L0X_GETARRAYPARAMETERFIELD(Dev, LimitChecksEnable,
+                                   VL53L0X_CHECKENABLE_SIGMA_FINAL_RANGE, enabled);
+    VL53L0X_GETARRAYPARAMETERFIELD(Dev, LimitChecksValue,
+                                   VL53L0X_CHECKENABLE_SIGMA_FINAL_RANGE, limit);
+    if (!enabled || limit == 0) return false;
+
+    memset(&data, 0, sizeof(data));
+    data.RangeMilliMeter = pSample->RangeMilliMeter;
+    data.SignalRateRtnMegaCps = pSample->SignalRateMegaCps;
+    data.AmbientRateRtnMegaCps = pSample->AmbientRateMegaCps;
+    data.EffectiveSpadRtnCount = pSample->EffectiveSpadCount;
+    data.RangeStatus = (device_status == 11) ? 0 : 1;
+
+    if (VL53L0X_calc_sigma_estimate(Dev, &data, &sigma) != VL53L0X_ERROR_NONE) return false;
+    return sigma > limit;
+}
+
+#if VL53L0X_LEAN_REF_CLIP
+static bool VL53L0X_lean_ref_clip_fail(VL53L0X_DEV Dev)
+{
+    uint8_t enabled;
+    FixPoint1616_t limit;
+    uint16_t ref_rate = 0;
+
+    VL53L0X_GETARRAYPARAMETERFIELD(Dev, LimitChecksEnable,
+                                   VL53L0X_CHECKENABLE_SIGNAL_REF_CLIP, enabled);
+    VL53L0X_GETARRAYPARAMETERFIELD(Dev, LimitChecksValue,
+                                   VL53L0X_CHECKENABLE_SIGNAL_REF_CLIP, limit);
+    if (!enabled || limit == 0) return false;
+
+    VL53L0X_WrByte(Dev, 0xFF, 0x01);
+    VL53L0X_RdWord(Dev, VL53L0X_REG_RESULT_PEAK_SIGNAL_RATE_REF, &ref_rate);
+    VL53L0X_WrByte(Dev, 0xFF, 0x00);
+    return VL53L0X_FIXPOINT97TOFIXPOINT1616(ref_rate) > limit;
+}
+#endif
+
+// Dispara uma medição única: sequência do stop variable + SYSRANGE_START.
+// Não espera o bit de início voltar a 0: o "pronto" da leitura já confirma
+// que a medição começou e terminou.
+VL53L0X_Error VL53L0X_LeanStartRanging(VL53L0X_Dev_t *pDevice) {
+    static const uint8_t seq_reg[] = {0x80, 0xFF, 0x00, 0x91, 0x00, 0xFF, 0x80};
+    uint8_t seq_val[] = {0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00};
+    VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+
+    seq_val[3] = PALDevDataGet(pDevice, StopVariable);
+    for (uint8_t i = 0; i < sizeof(seq_reg) && Status == VL53L0X_ERROR_NONE; i++) {
+        Status = VL53L0X_WrByte(pDevice, seq_reg[i], seq_val[i]);
+    }
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    return VL53L0X_WrByte(pDevice, VL53L0X_REG_SYSRANGE_START, VL53L0X_REG_SYSRANGE_MODE_START_STOP);
+}
+
+// Resultado já lido (status da interrupção + bloco 0x14..0x1F): se pronto,
+// limpa a interrupção e converte para a amostra
+static VL53L0X_Error VL53L0X_lean_finish(VL53L0X_DEV Dev, const uint8_t *buf,
+                                         VL53L0X_RangeSample_t *pSample, uint8_t *pReady)
+{
+    VL53L0X_Error Status;
+
+    *pReady = 0;
+    if ((buf[0] & 0x07) == 0) return VL53L0X_ERROR_NONE;
+
+    // Resultado já está no buffer: libera a interrupção para a próxima medição
+    Status = VL53L0X_WrByte(Dev, VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+    if (Status == VL53L0X_ERROR_NONE) {
+        Status = VL53L0X_WrByte(Dev, VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR, 0x00);
+    }
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    // Layout de 0x14 (mesmo índice que GetRangingMeasurementData usa em localBuffer)
+    const uint8_t *res = &buf[1];
+    uint8_t device_status = (res[0] & 0x78) >> 3;
+    uint16_t range = VL53L0X_MAKEUINT16(res[11], res[10]);
+
+    memset(pSample, 0, sizeof(*pSample));
+    pSample->RangeMilliMeter = PALDevDataGet(Dev, RangeFractionalEnable) ? (range >> 2) : range;
+    pSample->SignalRateMegaCps = VL53L0X_FIXPOINT97TOFIXPOINT1616(VL53L0X_MAKEUINT16(res[7], res[6]));
+    pSample->AmbientRateMegaCps = VL53L0X_FIXPOINT97TOFIXPOINT1616(VL53L0X_MAKEUINT16(res[9], res[8]));
+    pSample->EffectiveSpadCount = VL53L0X_MAKEUINT16(res[3], res[2]);
+
+    bool sigma_fail = VL53L0X_lean_sigma_fail(Dev, pSample, device_status);
+#if VL53L0X_LEAN_REF_CLIP
+    bool ref_clip_fail = VL53L0X_lean_ref_clip_fail(Dev);
+#else
+    bool ref_clip_fail = false;
+#endif
+    pSample->RangeStatus = VL53L0X_lean_range_status(device_status, sigma_fail, ref_clip_fail);
+
+    *pReady = 1;
+    return VL53L0X_ERROR_NONE;
+}
+
+// Equivalente a VL53L0X_PollRangingSample: uma leitura em rajada traz o
+// status da interrupção e o resultado; se pronto, limpa a interrupção.
+// Com GPIO1 ligado, chamar só depois da interrupção (a primeira leitura já vem pronta).
+VL53L0X_Error VL53L0X_LeanPollRanging(VL53L0X_Dev_t *pDevice, VL53L0X_RangeSample_t *pSample,
+                                      uint8_t *pReady) {
+    uint8_t buf[LEAN_RESULT_BYTES];
+    VL53L0X_Error Status;
+
+    *pReady = 0;
+    Status = VL53L0X_ReadMulti(pDevice, VL53L0X_REG_RESULT_INTERRUPT_STATUS, buf, sizeof(buf));
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    return VL53L0X_lean_finish(pDevice, buf, pSample, pReady);
+}
+
+// VL53L0X_LeanPollRanging para vários sensores: os blocos de resultado vêm
+// numa única rodada (VL53L0X_ReadMultiGroup), em paralelo quando os sensores
+// estão em barramentos PIO distintos
+void VL53L0X_LeanPollRangingGroup(VL53L0X_Dev_t *const pDevices[], VL53L0X_RangeSample_t pSamples[],
+                                  uint8_t pReady[], VL53L0X_Error pStatus[], uint8_t count) {
+    uint8_t buf[VL53L0X_GROUP_MAX][LEAN_RESULT_BYTES];
+    uint8_t *bufs[VL53L0X_GROUP_MAX];
+
+    for (uint8_t first = 0; first < count; first += VL53L0X_GROUP_MAX) {
+        uint8_t n = (count - first < VL53L0X_GROUP_MAX) ? (count - first) : VL53L0X_GROUP_MAX;
+
+        for (uint8_t k = 0; k < n; k++) bufs[k] = buf[k];
+        VL53L0X_ReadMultiGroup(&pDevices[first], VL53L0X_REG_RESULT_INTERRUPT_STATUS, bufs,
+                               LEAN_RESULT_BYTES, &pStatus[first], n);
+
+        for (uint8_t k = 0; k < n; k++) {
+            uint8_t i = first + k;
+            pReady[i] = 0;
+            if (pStatus[i] != VL53L0X_ERROR_NONE) continue;
+            pStatus[i] = VL53L0X_lean_finish(pDevices[i], buf[k], &pSamples[i], &pReady[i]);
+        }
+    }
+}
+
+// Medição única bloqueante (dispara e aguarda até 200 ms)
+VL53L0X_Error VL53L0X_SingleRangingSample(VL53L0X_Dev_t *pDevice, VL53L0X_RangeSample_t *pSample) {
+    VL53L0X_Error Status;
+    uint8_t ready = 0;
+
+    memset(pSample, 0, sizeof(*pSample));
+    Status = VL53L0X_StartSingleRanging(pDevice);
+    if (Status != VL53L0X_ERROR_NONE) return Status;
+
+    absolute_time_t timeout = make_timeout_time_ms(200);
+    do {
+        Status = VL53L0X_PollRangingSample(pDevice, pSample, &ready);
+        if (ready || Status != VL53L0X_ERROR_NONE) return Status;
+    } while (absolute_time_diff_us(get_absolute_time(), timeout) > 0);
+
+    return VL53L0X_ERROR_TIME_OUT;
+}
+
 VL53L0X_Error VL53L0X_SingleRanging(VL53L0X_Dev_t *pDevice, uint16_t *MeasuredData) {
     VL53L0X_Error Status = VL53L0X_ERROR_NONE;
-    VL53L0X_RangingMeasurementData_t RangingMeasurementData;
+    VL53L0X_RangeSample_t Sample;
     
     *MeasuredData=0; 
-    Status = VL53L0X_SetDeviceMode(pDevice, VL53L0X_DEVICEMODE_SINGLE_RANGING); // Setup in single ranging mode
-    if(Status != VL53L0X_ERROR_NONE) return Status;
-
-    Status = VL53L0X_PerformSingleRangingMeasurement(pDevice,
-                &RangingMeasurementData);
-    if (Status == VL53L0X_ERROR_NONE && RangingMeasurementData.RangeStatus == 0) {
-        *MeasuredData = RangingMeasurementData.RangeMilliMeter;
+    Status = VL53L0X_SingleRangingSample(pDevice, &Sample);
+    if (Status == VL53L0X_ERROR_NONE && Sample.RangeStatus == 0) {
+        *MeasuredData = Sample.RangeMilliMeter;
     } else {
         Status = VL53L0X_ERROR_RANGE_ERROR;
     }
@@ -4,22 +4,31 @@
 // Publicação via MQTT para Dashboard AGV
 // =====================================================
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
-#include <math.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
 #include "hardware/spi.h"
 #include "hardware/i2c.h"
+#include "hardware/irq.h"
 #include "lwip/apps/mqtt.h"
 #include "lwip/dns.h"
 
 // Bibliotecas do RFID
 #include "mfrc522.h"
+#include "rfid_poller.h"
+#include "tag_cache.h"
+#include "rfid_tags.h"
+#include "json_util.h"
+#include "spi_dma.h"
 
 // Bibliotecas dos sensores de distância
+#include "i2c_bus.h"
+#include "pio_i2c.h"
 #include "tca9548a.h"
+#include "bus_supervisor.h"
 #include "vl53l0x/core/inc/vl53l0x_api.h"
 #include "vl53l0x/platform/inc/vl53l0x_rp2040.h"
 
@@ -28,6 +37,28 @@
 
 // Biblioteca do sensor de cor GY-33
 #include "gy33.h"
+#include "color_classifier.h"
+#include "color_events.h"
+#include "color_calib.h"
+#include "color_wake.h"
+
+// Log com níveis em tempo de compilação
+#include "agv_log.h"
+
+// Aritmética de ponto fixo (sem float no caminho dos sensores)
+#include "fixed_point.h"
+
+// Contagem de ciclos (SysTick)
+#include "benchmark.h"
+
+// Reflexo local de parada por obstáculo
+#include "safety_reflex.h"
+
+// Filtro de distância ponderado pela qualidade do sinal
+#include "distance_filter.h"
+
+// Perfis de medição adaptativos do VL53L0X
+#include "tof_profile.h"
 
 // Configurações do projeto
 #include "config.h"
@@ -39,58 +70,147 @@ mqtt_client_t *mqtt_client = NULL;
 bool mqtt_connected = false;
 ip_addr_t mqtt_broker_ip;
 
-// Controle de leitura RFID
-volatile uint8_t last_uid[10] = {0};
-volatile uint8_t last_uid_size = 0;
-volatile absolute_time_t last_read_time;
+// Leitores RFID no SPI0, cada um com o próprio CS (e IRQ, se ligado)
+#if RFID_READER_COUNT > MFRC_MAX_INSTANCES
+#error "RFID_READER_COUNT maior que MFRC_MAX_INSTANCES (mfrc522.h)"
+#endif
+typedef struct {
+    uint cs_pin;
+    int reset_pin;              // -1 = reset compartilhado com o primeiro leitor
+    int irq_pin;                // -1 = conclusão consultada por SPI
+} rfid_reader_pins_t;
+
+static const rfid_reader_pins_t RFID_READER_PINS[RFID_READER_COUNT] = {
+    { PIN_CS, PIN_RST, PIN_IRQ },
+#if RFID_READER_COUNT > 1
+    { PIN_CS2, PIN_RST2, PIN_IRQ2 },
+#endif
+};
+MFRC522Ptr_t rfid_readers[RFID_READER_COUNT];   // NULL = leitor ausente
+
+// Leitura de tags sem bloquear o loop (um passo por leitor e iteração)
+rfid_poller_t rfid_pollers[RFID_READER_COUNT];
+
+// Tags vistas recentemente (não são republicadas enquanto no prazo)
+tag_cache_t rfid_tag_cache;
+
+// Nó do mapa da última tag de posição lida (localização sem o servidor)
+static char rfid_last_node[RFID_TAG_NODE_NAME_MAX];    // "" = nenhum nó visto
+
+// Mensagem MQTT recebida (o lwIP entrega o tópico e depois o payload em partes)
+static char mqtt_in_topic[64];
+static char mqtt_in_payload[MQTT_IN_PAYLOAD_MAX + 1];
+static size_t mqtt_in_len;
+static bool mqtt_in_overflow;
+
+// Transporte SPI do leitor (fila de transações por DMA)
+spi_dma_t rfid_spi;
 
 // Status da conexão
 bool wifi_connected = false;
 absolute_time_t last_reconnect_attempt;
 
+// Piscada do LED por publicação: apagado no callback, religado pelo loop
+static bool led_blink_pending = false;
+static uint32_t led_blink_start_us;
+
 // Sensores de distância
 VL53L0X_Dev_t gVL53L0XDevices[NUM_SENSORS];
-bool sensor_ok[NUM_SENSORS] = {false};
+i2c_bus_t tof_bus;
 tca9548a_t mux;
 const uint8_t SENSOR_CHANNELS[NUM_SENSORS] = {SENSOR_CHANNEL_LEFT, SENSOR_CHANNEL_CENTER, SENSOR_CHANNEL_RIGHT};
 const char* SENSOR_NAMES[NUM_SENSORS] = {"Esquerda", "Centro", "Direita"};
-
-// Filtros de medição
-uint16_t filter_buffer[NUM_SENSORS][FILTER_SIZE] = {0};
-uint8_t buffer_index[NUM_SENSORS] = {0};
-
-// Variáveis de distância
-float distancia_esquerda = 0.0;
-float distancia_centro = 0.0;
-float distancia_direita = 0.0;
+const char* SENSOR_KEYS[NUM_SENSORS] = {"left", "center", "right"};
+
+// Barramento e multiplexador de cada sensor (NULL = ligado direto no barramento)
+#if TOF_BUS_LAYOUT == TOF_LAYOUT_PIO
+// Centro e direita em barramentos PIO: mesmo endereço, sem multiplexador
+i2c_bus_t tof_bus_center;
+i2c_bus_t tof_bus_right;
+pio_i2c_t pio_i2c_center;
+pio_i2c_t pio_i2c_right;
+i2c_bus_t *const SENSOR_BUSES[NUM_SENSORS] = {&tof_bus, &tof_bus_center, &tof_bus_right};
+tca9548a_t *const SENSOR_MUXES[NUM_SENSORS] = {NULL, NULL, NULL};
+#else
+i2c_bus_t *const SENSOR_BUSES[NUM_SENSORS] = {&tof_bus, &tof_bus, &tof_bus};
+tca9548a_t *const SENSOR_MUXES[NUM_SENSORS] = {&mux, &mux, &mux};
+#endif
+
+// Saúde de cada sensor no barramento (offline após falhas seguidas, religado pelo supervisor)
+bus_device_t tof_health[NUM_SENSORS];
+
+// Disparo/leitura em regime permanente: caminho enxuto ou API completa da ST
+#if VL53L0X_LEAN_RANGING
+#define tof_start_ranging   VL53L0X_LeanStartRanging
+#define tof_poll_ranging    VL53L0X_LeanPollRangingGroup
+#else
+#define tof_start_ranging   VL53L0X_StartSingleRanging
+#define tof_poll_ranging    VL53L0X_PollRangingGroup
+#endif
+
+// Medição em andamento (disparo e leitura separados: sensores medem em paralelo)
+bool ranging_pending[NUM_SENSORS] = {false};
+uint32_t ranging_start_us[NUM_SENSORS] = {0};
+
+// Filtros de medição (peso pela taxa de sinal, ver distance_filter.h)
+dist_filter_t dist_filters[NUM_SENSORS];
+
+// Perfil de medição de cada sensor
+tof_profile_manager_t tof_profiles[NUM_SENSORS];
+
+// Variáveis de distância (mm)
+uint16_t distancia_esquerda_mm = 0;
+uint16_t distancia_centro_mm = 0;
+uint16_t distancia_direita_mm = 0;
 
 // Dados do MPU6050
+i2c_bus_t imu_bus;
+bus_device_t imu_health;
 mpu6050_data_t imu_data = {0};
 
 // Dados do sensor de cor GY-33
+#if TOF_BUS_LAYOUT == TOF_LAYOUT_PIO
+#define COLOR_BUS   (&imu_bus)      // I2C1, junto do MPU6050 (0x29 e 0x68)
+#define COLOR_MUX   NULL
+#else
+#define COLOR_BUS   (&tof_bus)      // I2C0, canal GY33_CHANNEL do TCA9548A
+#define COLOR_MUX   (&mux)
+#endif
+bus_device_t color_health;
 uint16_t color_r = 0;
 uint16_t color_g = 0;
 uint16_t color_b = 0;
 uint16_t color_c = 0;
 const char* detected_color = "---";
+uint8_t color_confidence = 0;       // 0..COLOR_CONFIDENCE_MAX
+bool color_settling = false;        // Próxima leitura mistura exposições: descartar
+uint32_t color_samples = 0;         // Leituras desde o último status
+color_events_t color_events;        // Entrada/saída de marcadores
+uint32_t color_stats_start_us = 0;
+color_wake_t color_wake;            // Leitura parada no piso, acordada pelo pino INT
+volatile bool color_int_pending = false;
 
 // Últimos valores publicados (para filtro de variação)
-float last_published_accel_x = 0.0;
-float last_published_accel_y = 0.0;
-float last_published_accel_z = 0.0;
-float last_published_gyro_x = 0.0;
-float last_published_gyro_y = 0.0;
-float last_published_gyro_z = 0.0;
+q16_t last_published_accel_x = 0;
+q16_t last_published_accel_y = 0;
+q16_t last_published_accel_z = 0;
+q16_t last_published_gyro_x = 0;
+q16_t last_published_gyro_y = 0;
+q16_t last_published_gyro_z = 0;
 
-float last_published_distance_left = 0.0;
-float last_published_distance_center = 0.0;
-float last_published_distance_right = 0.0;
+uint16_t last_published_distance_left = 0;
+uint16_t last_published_distance_center = 0;
+uint16_t last_published_distance_right = 0;
 
 // Timestamp da última publicação IMU forçada
 absolute_time_t last_forced_imu_publish;
 
-// Threshold de variação (15%)
-#define VARIATION_THRESHOLD 0.15f
+// Threshold de variação (15% = 3/20, comparado sem divisão)
+#define VARIATION_THRESHOLD_NUM 3
+#define VARIATION_THRESHOLD_DEN 20
+// Abaixo deste valor o último publicado é tratado como zero
+#define IMU_ZERO_THRESHOLD      Q16_CONST(0.1)
+#define DISTANCE_ZERO_MM        1
 // Intervalo para publicação forçada do IMU (5 segundos)
 #define IMU_FORCED_PUBLISH_INTERVAL 5000000
 
@@ -106,18 +226,23 @@ void init_distance_sensors(void);
 // Callbacks MQTT
 void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status);
 void mqtt_pub_request_cb(void *arg, err_t result);
+void mqtt_sub_request_cb(void *arg, err_t result);
+void mqtt_incoming_publish_cb(void *arg, const char *topic, u32_t tot_len);
+void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags);
 void dns_found_cb(const char *hostname, const ip_addr_t *ipaddr, void *arg);
 
 // Operações RFID
-void publish_rfid_tag(const uint8_t *uid, uint8_t uid_size);
-bool is_same_tag(const uint8_t *uid, uint8_t uid_size);
+void setup_rfid_readers(void);
+void publish_rfid_tag(const uint8_t *uid, uint8_t uid_size, const char *node, uint8_t reader);
+const char *locate_rfid_tag(const uint8_t *uid, uint8_t uid_size);
 void uid_to_hex_string(const uint8_t *uid, uint8_t size, char *output);
 
 // Operações sensores de distância
 void read_distance_sensors(void);
 void publish_distance_data(void);
-VL53L0X_Error singleRanging(VL53L0X_Dev_t *pDevice, uint16_t *MeasuredData);
 bool should_publish_distance(void);
+void publish_safety_events(void);
+void distance_deadline(uint32_t *wake_us);
 
 // Operações IMU
 bool should_publish_imu(void);
@@ -125,7 +250,8 @@ bool should_publish_imu(void);
 // Operações sensor de cor
 void init_color_sensor(void);
 void read_color_sensor(void);
-void publish_color_data(void);
+void publish_color_events(void);
+void publish_color_calib_report(void);
 
 // Gerais
 void publish_status(const char *status);
@@ -145,12 +271,66 @@ void setup_gpio_rfid(void) {
     gpio_set_function(PIN_SCK, GPIO_FUNC_SPI);
     gpio_set_function(PIN_MOSI, GPIO_FUNC_SPI);
 
-    // Configura Chip Select (CS)
-    gpio_init(PIN_CS);
-    gpio_set_dir(PIN_CS, GPIO_OUT);
-    gpio_put(PIN_CS, 1);  // CS inativo (HIGH)
+    // Configura Chip Select (CS) de todos os leitores antes do primeiro
+    // acesso: um CS flutuando faria dois chips responderem no mesmo MISO
+    for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+        gpio_init(RFID_READER_PINS[r].cs_pin);
+        gpio_set_dir(RFID_READER_PINS[r].cs_pin, GPIO_OUT);
+        gpio_put(RFID_READER_PINS[r].cs_pin, 1);  // CS inativo (HIGH)
+    }
+
+    LOG_I(RFID, "[RFID] GPIO configurado\n");
+}
+
+void setup_rfid_readers(void) {
+    for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+        const rfid_reader_pins_t *pins = &RFID_READER_PINS[r];
+        MFRC522Ptr_t mfrc = MFRC522_InitPins(pins->cs_pin, pins->reset_pin);
+        if (mfrc == NULL) break;
+
+        PCD_Init(mfrc, spi0);
+        uint8_t version = PCD_ReadRegister(mfrc, VersionReg);
+        if (version == 0x00 || version == 0xFF) {
+            LOG_W(RFID, "[RFID] Leitor %u nao responde (CS GP%u), desligado\n", r, pins->cs_pin);
+            continue;
+        }
+        rfid_readers[r] = mfrc;
+        LOG_I(RFID, "[RFID] Leitor %u inicializado (CS GP%u, versao 0x%02X)\n",
+              r, pins->cs_pin, version);
+
+        if (pins->irq_pin >= 0) {
+            if (PCD_EnableIrq(mfrc, pins->irq_pin, NULL, NULL)) {
+                LOG_I(RFID, "[RFID] Leitor %u: conclusao de comandos pelo pino IRQ (GP%d)\n",
+                      r, pins->irq_pin);
+            } else {
+                LOG_W(RFID, "[RFID] Leitor %u: IRQ nao responde em GP%d, consultando por SPI\n",
+                      r, pins->irq_pin);
+            }
+        }
+    }
 
-    printf("[RFID] GPIO configurado\n");
+#if RFID_SPI_USE_DMA
+    // Uma fila para o barramento: as transações dos leitores se intercalam
+    // nela, cada uma com o próprio CS. Sem canais livres o transporte segue
+    // pela CPU, com a mesma interface
+    if (!spi_dma_init(&rfid_spi, spi0)) {
+        LOG_W(RFID, "[RFID] Sem canais de DMA livres, SPI pela CPU\n");
+    }
+    for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+        if (rfid_readers[r]) PCD_UseDma(rfid_readers[r], &rfid_spi);
+    }
+#endif
+
+    // Clock validado em cada chip (versão + FIFO cheio de ida e volta). O
+    // barramento é um só: cada leitor parte de 1 MHz e sobe até o clock
+    // aceito pelos anteriores, e fica valendo o menor
+    uint32_t rfid_spi_hz = RFID_SPI_BAUDRATE_MAX;
+    for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+        if (rfid_readers[r] == NULL) continue;
+        spi_set_baudrate(spi0, 1000000);
+        rfid_spi_hz = PCD_SetSpiClock(rfid_readers[r], rfid_spi_hz);
+    }
+    LOG_I(RFID, "[RFID] SPI a %lu kHz\n", rfid_spi_hz / 1000);
 }
 
 void uid_to_hex_string(const uint8_t *uid, uint8_t size, char *output) {
@@ -160,28 +340,35 @@ void uid_to_hex_string(const uint8_t *uid, uint8_t size, char *output) {
     output[size * 2] = '\0';
 }
 
-bool is_same_tag(const uint8_t *uid, uint8_t uid_size) {
-    if (last_uid_size != uid_size) return false;
-
-    for (uint8_t i = 0; i < uid_size; i++) {
-        if (last_uid[i] != uid[i]) return false;
+// Consulta a tabela de tags: nome do item e nó do mapa, sem ida ao servidor.
+// Retorna o nó (NULL para tag sem nó ou não cadastrada).
+const char *locate_rfid_tag(const uint8_t *uid, uint8_t uid_size) {
+    rfid_tag_info_t info;
+    if (!rfid_tags_lookup(uid, uid_size, &info)) {
+        LOG_D(RFID, "[RFID] Tag nao cadastrada no firmware\n");
+        return NULL;
     }
 
-    absolute_time_t now = get_absolute_time();
-    int64_t diff_ms = absolute_time_diff_us(last_read_time, now) / 1000;
-
-    return diff_ms < RFID_DEBOUNCE_TIME_MS;
+    // Só o índice no log: o nome pode estar na sobreposição em RAM, e o log
+    // formata o texto depois
+    LOG_I(RFID, "[RFID] Item #%u%s, %s\n", info.id,
+          info.from_overlay ? " (alterado pelo backend)" : "",
+          info.node ? "com no no mapa" : "sem no");
+    if (info.node) {
+        snprintf(rfid_last_node, sizeof(rfid_last_node), "%s", info.node);
+    }
+    return info.node;
 }
 
-void publish_rfid_tag(const uint8_t *uid, uint8_t uid_size) {
+void publish_rfid_tag(const uint8_t *uid, uint8_t uid_size, const char *node, uint8_t reader) {
     if (!mqtt_connected) {
-        printf("[MQTT] Nao conectado, pulando publicacao RFID...\n");
+        LOG_D(MQTT, "[MQTT] Nao conectado, pulando publicacao RFID...\n");
         return;
     }
 
     // Verifica se o cliente MQTT está pronto
     if (mqtt_client == NULL || !mqtt_client_is_connected(mqtt_client)) {
-        printf("[MQTT] Cliente nao esta pronto, pulando publicacao...\n");
+        LOG_D(MQTT, "[MQTT] Cliente nao esta pronto, pulando publicacao...\n");
         mqtt_connected = false;
         return;
     }
@@ -189,148 +376,246 @@ void publish_rfid_tag(const uint8_t *uid, uint8_t uid_size) {
     char uid_str[32] = {0};
     uid_to_hex_string(uid, uid_size, uid_str);
 
-    char payload[128];
+    char payload[256];
     uint32_t timestamp = to_ms_since_boot(get_absolute_time());
 
-    snprintf(payload, sizeof(payload),
-             "{\"tag\":\"%s\",\"timestamp\":%lu,\"reader\":\"PicoW\"}",
-             uid_str, timestamp);
+    int len = snprintf(payload, sizeof(payload),
+                       "{\"tag\":\"%s\",\"timestamp\":%lu,\"reader\":\"PicoW\",\"reader_id\":%u",
+                       uid_str, timestamp, reader);
+    // Nó resolvido no próprio AGV (tabela gerada de data/rfid-tags.json)
+    if (node) {
+        char node_json[RFID_TAG_NODE_NAME_MAX * 6];
+        json_escape(node, node_json, sizeof(node_json));
+        len += snprintf(payload + len, sizeof(payload) - len, ",\"node\":\"%s\"", node_json);
+    }
+    snprintf(payload + len, sizeof(payload) - len, "}");
 
-    printf("[RFID] Tag detectada: %s\n", uid_str);
-    printf("[MQTT] Publicando RFID: %s\n", payload);
+    LOG_I(RFID, "[RFID] Tag detectada: %08lX (%u bytes) no leitor %u\n",
+          ((uint32_t)uid[0] << 24) | ((uint32_t)uid[1] << 16) | ((uint32_t)uid[2] << 8) | uid[3],
+          uid_size, reader);
+    LOG_D(MQTT, "[MQTT] Publicando RFID (%u bytes)\n", strlen(payload));
 
     err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_RFID, payload, strlen(payload),
                             1, 0, mqtt_pub_request_cb, NULL);
 
     if (err != ERR_OK) {
-        printf("[MQTT] ERRO ao publicar RFID! Codigo: %d\n", err);
+        LOG_E(MQTT, "[MQTT] ERRO ao publicar RFID! Codigo: %d\n", err);
         if (err == ERR_CONN) {
             mqtt_connected = false;
         }
     }
-
-    memcpy((void*)last_uid, uid, uid_size);
-    last_uid_size = uid_size;
-    last_read_time = get_absolute_time();
 }
 
 // ========== IMPLEMENTAÇÃO - SENSORES DE DISTÂNCIA ==========
 
 void setup_i2c_distance(void) {
-    i2c_init(I2C_PORT, 400 * 1000);
-    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA_PIN);
-    gpio_pull_up(I2C_SCL_PIN);
+    // Barramento configurado uma única vez; os sensores só guardam o ponteiro
+    i2c_bus_init_hw(&tof_bus, "i2c0", I2C_PORT, I2C_SDA_PIN, I2C_SCL_PIN, 400 * 1000);
+
+#if TOF_BUS_LAYOUT == TOF_LAYOUT_PIO
+    // Sem state machine livre o sensor fica offline (transferências falham)
+    if (!i2c_bus_init_pio(&tof_bus_center, "pio_center", &pio_i2c_center,
+                          PIO_I2C_CENTER_SDA_PIN, PIO_I2C_CENTER_SCL_PIN, PIO_I2C_BAUDRATE) ||
+        !i2c_bus_init_pio(&tof_bus_right, "pio_right", &pio_i2c_right,
+                          PIO_I2C_RIGHT_SDA_PIN, PIO_I2C_RIGHT_SCL_PIN, PIO_I2C_BAUDRATE)) {
+        LOG_E(DIST, "[I2C] ERRO: sem state machine PIO livre para os barramentos extras\n");
+    }
+    LOG_I(DIST, "[I2C] Barramentos separados: i2c0 + PIO (GP%d/GP%d, GP%d/GP%d) a %lu Hz\n",
+          PIO_I2C_CENTER_SDA_PIN, PIO_I2C_CENTER_SCL_PIN, PIO_I2C_RIGHT_SDA_PIN,
+          PIO_I2C_RIGHT_SCL_PIN, tof_bus_center.baudrate);
+#else
+    tca9548a_init(&mux, &tof_bus, TCA9548A_DEFAULT_ADDR);
+    tca9548a_set_reset_pin(&mux, PIN_MUX_RESET);
+    LOG_I(DIST, "[I2C] Configurado com multiplexador TCA9548A\n");
+#endif
+}
 
-    tca9548a_init(&mux, I2C_PORT, TCA9548A_DEFAULT_ADDR);
-    printf("[I2C] Configurado com multiplexador TCA9548A\n");
+// Inicializa/reinicializa um sensor: calibração, cache e perfil de longo alcance
+static VL53L0X_Error tof_sensor_setup(int i) {
+    VL53L0X_Dev_t *pDevice = &gVL53L0XDevices[i];
+
+    VL53L0X_dev_i2c_attach(pDevice, SENSOR_BUSES[i], SENSOR_MUXES[i], SENSOR_CHANNELS[i], VL53L0X_ADDR);
+    VL53L0X_Error status = VL53L0X_device_base_initialise(pDevice);
+    if (status == VL53L0X_ERROR_NONE) {
+        // Calibração concluída: registradores de configuração passam a vir do
+        // cache (com a inicialização falha o cache fica desligado)
+        VL53L0X_ShadowEnable(pDevice, VL53L0X_REGISTER_CACHE);
+        // Começa em longo alcance; o perfil define limites, timing e VCSEL uma única vez
+        status = tof_profile_apply(pDevice, TOF_PROFILE_LONG_RANGE);
+    }
+    tof_profile_init(&tof_profiles[i], TOF_PROFILE_LONG_RANGE);
+    ranging_pending[i] = false;
+    return status;
 }
 
-void init_distance_sensors(void) {
-    printf("[DISTANCIA] Inicializando sensores VL53L0X...\n");
+// Supervisor: o sensor responde com o ID de modelo do VL53L0X?
+static bool tof_sensor_probe(void *ctx) {
+    VL53L0X_Dev_t *pDevice = &gVL53L0XDevices[(uintptr_t)ctx];
+    uint8_t model_id = 0;
 
-    for (int i = 0; i < NUM_SENSORS; i++) {
-        tca9548a_select_channel(&mux, SENSOR_CHANNELS[i]);
-        VL53L0X_Dev_t *pDevice = &gVL53L0XDevices[i];
-        pDevice->I2cDevAddr = 0x29;
-        pDevice->comms_type = 1;
-        pDevice->comms_speed_khz = 400;
-
-        VL53L0X_Error status = VL53L0X_dev_i2c_initialise(pDevice, I2C_PORT,
-                                                          I2C_SDA_PIN, I2C_SCL_PIN,
-                                                          400, VL53L0X_DEFAULT_MODE);
-        sensor_ok[i] = (status == VL53L0X_ERROR_NONE);
-        printf("[DISTANCIA] Sensor %s: %s\n", SENSOR_NAMES[i],
-               sensor_ok[i] ? "OK" : "FALHOU");
-        sleep_ms(50);
-    }
+    // Sem cache: a leitura precisa ir ao barramento
+    VL53L0X_ShadowEnable(pDevice, 0);
+    return VL53L0X_RdByte(pDevice, VL53L0X_REG_IDENTIFICATION_MODEL_ID, &model_id) == VL53L0X_ERROR_NONE &&
+           model_id == 0xEE;
 }
 
-VL53L0X_Error singleRanging(VL53L0X_Dev_t *pDevice, uint16_t *MeasuredData) {
-    return VL53L0X_SingleRanging(pDevice, MeasuredData);
+// Supervisor: sensor voltou (ex.: queda de alimentação), refaz a inicialização
+static bool tof_sensor_reinit(void *ctx) {
+    int i = (int)(uintptr_t)ctx;
+    return tof_sensor_setup(i) == VL53L0X_ERROR_NONE;
 }
 
-void read_distance_sensors(void) {
-    for (int i = 0; i < NUM_SENSORS; i++) {
-        if (!sensor_ok[i]) continue;
+void init_distance_sensors(void) {
+    LOG_I(DIST, "[DISTANCIA] Inicializando sensores VL53L0X...\n");
 
-        if (!tca9548a_select_channel(&mux, SENSOR_CHANNELS[i])) continue;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        i2c_bus_t *bus = SENSOR_BUSES[i];
+        uint32_t start_us = time_us_32();
+        uint32_t start_transactions = bus->transactions;
+
+        VL53L0X_Error status = tof_sensor_setup(i);
+
+        LOG_I(DIST, "[DISTANCIA] Sensor %s: init em %lu us, %lu transacoes I2C\n", SENSOR_NAMES[i],
+              time_us_32() - start_us, bus->transactions - start_transactions);
+
+        bool ok = (status == VL53L0X_ERROR_NONE);
+        tof_health[i] = (bus_device_t){
+            .name = SENSOR_KEYS[i],
+            .bus = bus,
+            .mux = SENSOR_MUXES[i],
+            .probe = tof_sensor_probe,
+            .reinit = tof_sensor_reinit,
+            .ctx = (void *)(uintptr_t)i,
+        };
+        bus_supervisor_register(&tof_health[i], ok);
+
+        distance_filter_init(&dist_filters[i]);
+        // Todo sensor configurado participa do reflexo: falhando no boot, fica
+        // sem amostras e segura a parada até o supervisor religá-lo. Só
+        // SAFETY_SENSOR_EXCLUDE_MASK tira um sensor da avaliação.
+        safety_reflex_set_sensor_enabled(i, !(SAFETY_SENSOR_EXCLUDE_MASK & (1u << i)));
+        LOG_I(DIST, "[DISTANCIA] Sensor %s: %s\n", SENSOR_NAMES[i],
+                    ok ? "OK" : "FALHOU");
+        sleep_ms(50);
+    }
+}
 
-        VL53L0X_Dev_t *pDevice = &gVL53L0XDevices[i];
-        uint16_t ranging_value = 0;
-        VL53L0X_Error status = singleRanging(pDevice, &ranging_value);
+// Filtra a amostra, avalia o reflexo e ajusta o perfil do sensor
+static void process_distance_sample(int i, const VL53L0X_RangeSample_t *sample) {
+    VL53L0X_Dev_t *pDevice = &gVL53L0XDevices[i];
 
-        if (status == VL53L0X_ERROR_NONE) {
-            // Adiciona ao buffer de filtro
-            filter_buffer[i][buffer_index[i]] = ranging_value;
-            buffer_index[i] = (buffer_index[i] + 1) % FILTER_SIZE;
+    // Classifica pela qualidade e aplica offset de calibração
+    dist_sample_class_t cls = distance_filter_update(&dist_filters[i], sample, DISTANCE_OFFSET);
+    if (cls == DIST_SAMPLE_REJECTED) {
+        LOG_D(DIST, "[DISTANCIA] %s: amostra rejeitada (status %u, sinal %lu)\n",
+              SENSOR_NAMES[i], sample->RangeStatus, sample->SignalRateMegaCps);
+        return;
+    }
 
-            // Calcula média
-            uint32_t sum_values = 0;
-            for (int j = 0; j < FILTER_SIZE; j++) {
-                sum_values += filter_buffer[i][j];
-            }
+    uint16_t filtered_mm = distance_filter_value(&dist_filters[i]);
+
+    // Reflexo de segurança na taxa do sensor (aciona GPIO imediatamente)
+    safety_reflex_update(i, distance_filter_last_sample(&dist_filters[i]),
+                         filtered_mm, time_us_32());
+
+    // Ajusta o perfil conforme distância, aproximação e sinal
+    if (tof_profile_update(&tof_profiles[i], filtered_mm, safety_reflex_closing_speed(i),
+                           sample->SignalRateMegaCps, cls == DIST_SAMPLE_NO_TARGET,
+                           time_us_32())) {
+        tof_profile_id_t profile = tof_profiles[i].current;
+        if (tof_profile_apply(pDevice, profile) == VL53L0X_ERROR_NONE) {
+            LOG_I(DIST, "[DISTANCIA] %s: perfil %s\n", SENSOR_NAMES[i], tof_profile_name(profile));
+        } else {
+            LOG_W(DIST, "[DISTANCIA] %s: falha ao aplicar perfil %s\n",
+                  SENSOR_NAMES[i], tof_profile_name(profile));
+        }
+    }
 
-            uint16_t averaged_value = sum_values / FILTER_SIZE;
+    // Armazena em mm (conversão para cm só na montagem do payload)
+    if (i == 0) distancia_esquerda_mm = filtered_mm;
+    else if (i == 1) distancia_centro_mm = filtered_mm;
+    else if (i == 2) distancia_direita_mm = filtered_mm;
+}
 
-            // Aplica offset de calibração
-            if (averaged_value > DISTANCE_OFFSET) {
-                averaged_value -= DISTANCE_OFFSET;
-            } else {
-                averaged_value = 0;
-            }
+// Não bloqueia: dispara os sensores devidos e recolhe os que já terminaram.
+// As medições correm em paralelo (cada sensor tem seu barramento/canal).
+void read_distance_sensors(void) {
+    // Fase 1: dispara os sensores cujo intervalo do perfil já passou
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        if (!bus_device_online(&tof_health[i]) || ranging_pending[i]) continue;
 
-            // Converte para cm e armazena
-            float distancia_cm = averaged_value / 10.0f;
+        // Sensores ociosos medem com menos frequência (libera o barramento)
+        if (!tof_profile_due(&tof_profiles[i], time_us_32())) continue;
 
-            if (i == 0) distancia_esquerda = distancia_cm;
-            else if (i == 1) distancia_centro = distancia_cm;
-            else if (i == 2) distancia_direita = distancia_cm;
+        bool started = (tof_start_ranging(&gVL53L0XDevices[i]) == VL53L0X_ERROR_NONE);
+        bus_device_report(&tof_health[i], started);
+        if (started) {
+            ranging_pending[i] = true;
+            ranging_start_us[i] = time_us_32();
         }
     }
-}
 
-bool should_publish_distance(void) {
-    // Calcula variação percentual para cada sensor
-    float variation_left = 0.0;
-    float variation_center = 0.0;
-    float variation_right = 0.0;
-
-    // Evita divisão por zero - se o último valor foi 0, sempre publica
-    if (last_published_distance_left > 0.1) {
-        variation_left = fabsf(distancia_esquerda - last_published_distance_left) / last_published_distance_left;
-    } else {
-        variation_left = 1.0; // Força publicação se era 0
+    // Fase 2: lê os resultados de todos os pendentes numa rodada
+    // (em paralelo quando os sensores estão em barramentos PIO distintos)
+    VL53L0X_Dev_t *pending[NUM_SENSORS];
+    uint8_t pending_index[NUM_SENSORS];
+    uint8_t count = 0;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        if (!ranging_pending[i]) continue;
+        pending_index[count] = (uint8_t)i;
+        pending[count++] = &gVL53L0XDevices[i];
     }
+    if (count == 0) return;
+
+    VL53L0X_RangeSample_t samples[NUM_SENSORS];
+    uint8_t ready[NUM_SENSORS];
+    VL53L0X_Error status[NUM_SENSORS];
+    tof_poll_ranging(pending, samples, ready, status, count);
+
+    for (uint8_t k = 0; k < count; k++) {
+        int i = pending_index[k];
+
+        if (status[k] != VL53L0X_ERROR_NONE ||
+            (!ready[k] && (time_us_32() - ranging_start_us[i]) > TOF_RANGING_TIMEOUT_MS * 1000)) {
+            // Dispara de novo na próxima iteração; sem amostra, o reflexo trata como sensor parado
+            ranging_pending[i] = false;
+            bus_device_report(&tof_health[i], false);
+            LOG_W(DIST, "[DISTANCIA] %s: medicao sem resposta (status %d)\n",
+                  SENSOR_NAMES[i], status[k]);
+            continue;
+        }
+        if (!ready[k]) continue;
 
-    if (last_published_distance_center > 0.1) {
-        variation_center = fabsf(distancia_centro - last_published_distance_center) / last_published_distance_center;
-    } else {
-        variation_center = 1.0;
+        ranging_pending[i] = false;
+        bus_device_report(&tof_health[i], true);
+        process_distance_sample(i, &samples[k]);
     }
+}
 
-    if (last_published_distance_right > 0.1) {
-        variation_right = fabsf(distancia_direita - last_published_distance_right) / last_published_distance_right;
-    } else {
-        variation_right = 1.0;
-    }
+// Verdadeiro se a distância variou mais que o threshold desde a última publicação
+static bool distance_changed(uint16_t current_mm, uint16_t last_mm) {
+    // Evita divisão por zero - se o último valor foi 0, sempre publica
+    if (last_mm <= DISTANCE_ZERO_MM) return true;
+    return fixed_variation_exceeds(current_mm, last_mm,
+                                   VARIATION_THRESHOLD_NUM, VARIATION_THRESHOLD_DEN);
+}
 
+bool should_publish_distance(void) {
     // Publica se qualquer sensor variou mais que o threshold
-    return (variation_left > VARIATION_THRESHOLD ||
-            variation_center > VARIATION_THRESHOLD ||
-            variation_right > VARIATION_THRESHOLD);
+    return (distance_changed(distancia_esquerda_mm, last_published_distance_left) ||
+            distance_changed(distancia_centro_mm, last_published_distance_center) ||
+            distance_changed(distancia_direita_mm, last_published_distance_right));
 }
 
 void publish_distance_data(void) {
     if (!mqtt_connected) {
-        printf("[MQTT] Nao conectado, pulando publicacao de distancia...\n");
+        LOG_D(MQTT, "[MQTT] Nao conectado, pulando publicacao de distancia...\n");
         return;
     }
 
     // Verifica se o cliente MQTT está pronto
     if (mqtt_client == NULL || !mqtt_client_is_connected(mqtt_client)) {
-        printf("[MQTT] Cliente nao esta pronto, pulando publicacao...\n");
+        LOG_D(MQTT, "[MQTT] Cliente nao esta pronto, pulando publicacao...\n");
         mqtt_connected = false;
         return;
     }
@@ -343,95 +628,169 @@ void publish_distance_data(void) {
     char payload[256];
     uint32_t timestamp = to_ms_since_boot(get_absolute_time());
 
+    // mm -> cm com uma casa decimal, sem printf de float
     snprintf(payload, sizeof(payload),
-             "{\"left\":%.1f,\"center\":%.1f,\"right\":%.1f,\"timestamp\":%lu,\"unit\":\"cm\"}",
-             distancia_esquerda, distancia_centro, distancia_direita, timestamp);
+             "{\"left\":" FIXED_DECI_FMT ",\"center\":" FIXED_DECI_FMT
+             ",\"right\":" FIXED_DECI_FMT ",\"timestamp\":%lu,\"unit\":\"cm\"}",
+             FIXED_DECI_ARGS(distancia_esquerda_mm), FIXED_DECI_ARGS(distancia_centro_mm),
+             FIXED_DECI_ARGS(distancia_direita_mm), timestamp);
 
-    printf("[DISTANCIA] Esq: %.1f cm | Centro: %.1f cm | Dir: %.1f cm\n",
-           distancia_esquerda, distancia_centro, distancia_direita);
-    printf("[MQTT] Publicando distancias: %s\n", payload);
+    LOG_D(DIST, "[DISTANCIA] Esq: %u mm | Centro: %u mm | Dir: %u mm\n",
+          distancia_esquerda_mm, distancia_centro_mm, distancia_direita_mm);
+    LOG_D(MQTT, "[MQTT] Publicando distancias (%u bytes)\n", strlen(payload));
 
     err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_DISTANCE, payload, strlen(payload),
                             1, 0, mqtt_pub_request_cb, NULL);
 
     if (err != ERR_OK) {
-        printf("[MQTT] ERRO ao publicar distancias! Codigo: %d\n", err);
+        LOG_E(MQTT, "[MQTT] ERRO ao publicar distancias! Codigo: %d\n", err);
         if (err == ERR_CONN) {
             mqtt_connected = false;
         }
     } else {
         // Atualiza últimos valores publicados
-        last_published_distance_left = distancia_esquerda;
-        last_published_distance_center = distancia_centro;
-        last_published_distance_right = distancia_direita;
+        last_published_distance_left = distancia_esquerda_mm;
+        last_published_distance_center = distancia_centro_mm;
+        last_published_distance_right = distancia_direita_mm;
+    }
+}
+
+// Publica os eventos do reflexo de segurança (fora do caminho crítico)
+void publish_safety_events(void) {
+    if (!mqtt_connected || mqtt_client == NULL) return;
+
+    safety_event_t ev;
+    while (safety_reflex_pop_event(&ev)) {
+        char payload[160];
+        snprintf(payload, sizeof(payload),
+                 "{\"state\":\"%s\",\"reason\":\"%s\",\"sensor\":\"%s\","
+                 "\"distance\":%u,\"ttc\":%u,\"timestamp\":%lu}",
+                 safety_state_name(ev.state), safety_reason_name(ev.reason),
+                 ev.sensor < NUM_SENSORS ? SENSOR_NAMES[ev.sensor] : "---",
+                 ev.distance_mm, ev.ttc_ms, ev.timestamp_ms);
+
+        LOG_I(DIST, "[SEGURANCA] %s (%s) sensor %u: %u mm\n",
+              safety_state_name(ev.state), safety_reason_name(ev.reason),
+              ev.sensor, ev.distance_mm);
+
+        err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_SAFETY, payload, strlen(payload),
+                                 1, 0, mqtt_pub_request_cb, NULL);
+        if (err != ERR_OK) {
+            LOG_E(MQTT, "[MQTT] ERRO ao publicar evento de seguranca! Codigo: %d\n", err);
+            if (err == ERR_CONN) {
+                mqtt_connected = false;
+            }
+            break;
+        }
     }
 }
 
 // ========== IMPLEMENTAÇÃO - WIFI E MQTT ==========
 
 void connect_wifi(void) {
-    printf("[WiFi] Conectando a: %s\n", WIFI_SSID);
+    LOG_I(WIFI, "[WiFi] Conectando a: %s\n", WIFI_SSID);
 
     if (cyw43_arch_init()) {
-        printf("[WiFi] ERRO: Falha ao inicializar CYW43!\n");
+        LOG_E(WIFI, "[WiFi] ERRO: Falha ao inicializar CYW43!\n");
         return;
     }
 
     cyw43_arch_enable_sta_mode();
-    printf("[WiFi] Aguardando conexao...\n");
+    LOG_I(WIFI, "[WiFi] Aguardando conexao...\n");
 
     if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD,
                                            CYW43_AUTH_WPA2_AES_PSK, 30000)) {
-        printf("[WiFi] ERRO: Falha ao conectar!\n");
+        LOG_E(WIFI, "[WiFi] ERRO: Falha ao conectar!\n");
         wifi_connected = false;
         return;
     }
 
     wifi_connected = true;
-    printf("[WiFi] Conectado com sucesso!\n");
-    printf("[WiFi] IP: %s\n", ip4addr_ntoa(netif_ip4_addr(netif_list)));
+    LOG_I(WIFI, "[WiFi] Conectado com sucesso!\n");
+    const ip_addr_t *ip = netif_ip4_addr(netif_list);
+    LOG_I(WIFI, "[WiFi] IP: %u.%u.%u.%u\n",
+          ip4_addr1(ip), ip4_addr2(ip), ip4_addr3(ip), ip4_addr4(ip));
 }
 
 void dns_found_cb(const char *hostname, const ip_addr_t *ipaddr, void *arg) {
     if (ipaddr != NULL) {
         mqtt_broker_ip = *ipaddr;
-        printf("[MQTT] Broker resolvido: %s\n", ip4addr_ntoa(ipaddr));
+        LOG_I(MQTT, "[MQTT] Broker resolvido: %u.%u.%u.%u\n",
+              ip4_addr1(ipaddr), ip4_addr2(ipaddr), ip4_addr3(ipaddr), ip4_addr4(ipaddr));
     } else {
-        printf("[MQTT] ERRO: Falha ao resolver hostname!\n");
+        LOG_E(MQTT, "[MQTT] ERRO: Falha ao resolver hostname!\n");
     }
 }
 
 void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status) {
     if (status == MQTT_CONNECT_ACCEPTED) {
         mqtt_connected = true;
-        printf("[MQTT] Conectado ao broker!\n");
+        LOG_I(MQTT, "[MQTT] Conectado ao broker!\n");
+        // Cadastro de tags: uma mensagem retida por tag, reenviada pelo broker
+        // a cada conexão
+        mqtt_subscribe(client, MQTT_TOPIC_RFID_TAGS "/+", 1, mqtt_sub_request_cb, NULL);
+        // Calibração das cores em campo
+        mqtt_subscribe(client, MQTT_TOPIC_COLOR_CALIB, 1, mqtt_sub_request_cb, NULL);
         publish_status("online");
         cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
     } else {
         mqtt_connected = false;
-        printf("[MQTT] Conexao falhou! Status: %d\n", status);
+        LOG_W(MQTT, "[MQTT] Conexao falhou! Status: %d\n", status);
         cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 0);
     }
 }
 
 void mqtt_pub_request_cb(void *arg, err_t result) {
     if (result == ERR_OK) {
-        printf("[MQTT] Mensagem publicada com sucesso!\n");
-        // Pisca LED
+        LOG_D(MQTT, "[MQTT] Mensagem publicada com sucesso!\n");
+        // Pisca LED sem parar o lwIP: o loop religa depois de LED_BLINK_MS
         cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 0);
-        sleep_ms(50);
-        cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
+        led_blink_pending = true;
+        led_blink_start_us = time_us_32();
     } else {
-        printf("[MQTT] ERRO ao publicar! Codigo: %d\n", result);
+        LOG_E(MQTT, "[MQTT] ERRO ao publicar! Codigo: %d\n", result);
+    }
+}
+
+void mqtt_sub_request_cb(void *arg, err_t result) {
+    if (result != ERR_OK) {
+        LOG_E(MQTT, "[MQTT] ERRO ao assinar topico! Codigo: %d\n", result);
+    }
+}
+
+void mqtt_incoming_publish_cb(void *arg, const char *topic, u32_t tot_len) {
+    snprintf(mqtt_in_topic, sizeof(mqtt_in_topic), "%s", topic);
+    mqtt_in_len = 0;
+    mqtt_in_overflow = tot_len > MQTT_IN_PAYLOAD_MAX;
+}
+
+void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags) {
+    if (!mqtt_in_overflow) {
+        memcpy(mqtt_in_payload + mqtt_in_len, data, len);
+        mqtt_in_len += len;
+    }
+    if (!(flags & MQTT_DATA_FLAG_LAST)) return;
+
+    if (mqtt_in_overflow) {
+        LOG_W(MQTT, "[MQTT] Mensagem recebida maior que %u bytes, descartada\n",
+              MQTT_IN_PAYLOAD_MAX);
+        return;
+    }
+    mqtt_in_payload[mqtt_in_len] = '\0';
+
+    if (strncmp(mqtt_in_topic, MQTT_TOPIC_RFID_TAGS "/", sizeof(MQTT_TOPIC_RFID_TAGS "/") - 1) == 0) {
+        rfid_tags_apply_update(mqtt_in_payload);
+    } else if (strcmp(mqtt_in_topic, MQTT_TOPIC_COLOR_CALIB) == 0) {
+        color_calib_command(mqtt_in_payload);
     }
 }
 
 void mqtt_init_and_connect(void) {
-    printf("[MQTT] Inicializando cliente...\n");
+    LOG_I(MQTT, "[MQTT] Inicializando cliente...\n");
 
     // Limpa cliente antigo com cuidado para evitar memory leak
     if (mqtt_client != NULL) {
-        printf("[MQTT] Liberando cliente antigo...\n");
+        LOG_I(MQTT, "[MQTT] Liberando cliente antigo...\n");
 
         // Desconecta se estiver conectado
         if (mqtt_client_is_connected(mqtt_client)) {
@@ -456,16 +815,17 @@ void mqtt_init_and_connect(void) {
 
     mqtt_client = mqtt_client_new();
     if (mqtt_client == NULL) {
-        printf("[MQTT] ERRO: Falha ao criar cliente!\n");
+        LOG_E(MQTT, "[MQTT] ERRO: Falha ao criar cliente!\n");
         return;
     }
+    mqtt_set_inpub_callback(mqtt_client, mqtt_incoming_publish_cb, mqtt_incoming_data_cb, NULL);
 
     if (!ip4addr_aton(MQTT_BROKER_IP, &mqtt_broker_ip)) {
-        printf("[MQTT] IP invalido, tentando resolver DNS...\n");
+        LOG_I(MQTT, "[MQTT] IP invalido, tentando resolver DNS...\n");
         err_t err = dns_gethostbyname(MQTT_BROKER_IP, &mqtt_broker_ip, dns_found_cb, NULL);
 
         if (err == ERR_INPROGRESS) {
-            printf("[MQTT] Aguardando resolucao DNS...\n");
+            LOG_I(MQTT, "[MQTT] Aguardando resolucao DNS...\n");
             for (int i = 0; i < 50; i++) {
                 sleep_ms(100);
                 cyw43_arch_poll();
@@ -474,15 +834,16 @@ void mqtt_init_and_connect(void) {
         }
 
         if (mqtt_broker_ip.addr == 0) {
-            printf("[MQTT] ERRO: Nao foi possivel resolver o broker!\n");
+            LOG_E(MQTT, "[MQTT] ERRO: Nao foi possivel resolver o broker!\n");
             mqtt_client_free(mqtt_client);
             mqtt_client = NULL;
             return;
         }
     }
 
-    printf("[MQTT] Conectando ao broker %s:%d...\n",
-           ip4addr_ntoa(&mqtt_broker_ip), MQTT_BROKER_PORT);
+    LOG_I(MQTT, "[MQTT] Conectando ao broker %u.%u.%u.%u:%d...\n",
+          ip4_addr1(&mqtt_broker_ip), ip4_addr2(&mqtt_broker_ip),
+          ip4_addr3(&mqtt_broker_ip), ip4_addr4(&mqtt_broker_ip), MQTT_BROKER_PORT);
 
     struct mqtt_connect_client_info_t ci;
     memset(&ci, 0, sizeof(ci));
@@ -493,25 +854,129 @@ void mqtt_init_and_connect(void) {
                                     mqtt_connection_cb, NULL, &ci);
 
     if (err != ERR_OK) {
-        printf("[MQTT] ERRO ao iniciar conexao! Codigo: %d\n", err);
+        LOG_E(MQTT, "[MQTT] ERRO ao iniciar conexao! Codigo: %d\n", err);
         mqtt_connected = false;
         mqtt_client_free(mqtt_client);
         mqtt_client = NULL;
     } else {
-        printf("[MQTT] Conexao iniciada, aguardando confirmacao...\n");
+        LOG_I(MQTT, "[MQTT] Conexao iniciada, aguardando confirmacao...\n");
     }
 }
 
+// O status vai inteiro para o buffer de saída do MQTT (tópico + cabeçalho)
+_Static_assert(STATUS_PAYLOAD_MAX + 64 <= MQTT_OUTPUT_RINGBUF_SIZE,
+               "MQTT_OUTPUT_RINGBUF_SIZE menor que o status");
+
+// Acrescenta ao payload do status; len nunca passa de size - 1
+static int status_append(char *buf, size_t size, int len, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static int status_append(char *buf, size_t size, int len, const char *fmt, ...) {
+    if ((size_t)len >= size - 1) return len;
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, size - len, fmt, args);
+    va_end(args);
+    if (n < 0) return len;
+    return ((size_t)(len + n) < size) ? len + n : (int)size - 1;
+}
+
 void publish_status(const char *status) {
     if (!mqtt_connected) return;
 
-    char payload[128];
-    snprintf(payload, sizeof(payload),
-             "{\"status\":\"%s\",\"rfid\":true,\"distance\":true,\"color\":true,\"reader\":\"PicoW\"}",
+    // Estático: o payload com a saúde dos barramentos não cabe folgado na pilha.
+    // Dois leitores RFID, o sensor de cor e a saúde somam ~1,3 KB; o buffer de
+    // saída do MQTT (MQTT_OUTPUT_RINGBUF_SIZE) comporta o payload inteiro.
+    static char payload[STATUS_PAYLOAD_MAX];
+    int len = status_append(payload, sizeof(payload), 0,
+             "{\"status\":\"%s\",\"rfid\":true,\"distance\":true,\"color\":true,\"reader\":\"PicoW\"",
              status);
 
-    mqtt_publish(mqtt_client, MQTT_TOPIC_STATUS, payload, strlen(payload),
-                0, 0, mqtt_pub_request_cb, NULL);
+    // Taxas de amostras válidas/inválidas por sensor desde o último status (%)
+    len = status_append(payload, sizeof(payload), len, ",\"distance_quality\":{");
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        dist_filter_stats_t st;
+        distance_filter_take_stats(&dist_filters[i], &st);
+        uint32_t total = (uint32_t)st.valid + st.no_target + st.too_close + st.rejected;
+        uint32_t div = total ? total : 1;
+        unsigned long valid_pct = ((uint32_t)st.valid + st.too_close) * 100 / div;
+        unsigned long no_target_pct = (uint32_t)st.no_target * 100 / div;
+        unsigned long invalid_pct = (uint32_t)st.rejected * 100 / div;
+        len = status_append(payload, sizeof(payload), len,
+                        "%s\"%s\":{\"valid\":%lu,\"no_target\":%lu,\"invalid\":%lu,\"samples\":%lu,\"profile\":\"%s\",\"cache_hits\":%lu}",
+                        i ? "," : "", SENSOR_KEYS[i],
+                        valid_pct, no_target_pct, invalid_pct, (unsigned long)total,
+                        tof_profile_name(tof_profiles[i].current),
+                        gVL53L0XDevices[i].Shadow.hits);
+    }
+    len = status_append(payload, sizeof(payload), len, "},");
+    len = status_append(payload, sizeof(payload), len, "\"rfid_poller\":[");
+    for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+        if (r) len = status_append(payload, sizeof(payload), len, ",");
+        if (rfid_readers[r]) {
+            len += rfid_poller_format_stats(&rfid_pollers[r], payload + len,
+                                            sizeof(payload) - len, time_us_32());
+        } else {
+            len = status_append(payload, sizeof(payload), len, "null");
+        }
+    }
+    len = status_append(payload, sizeof(payload), len, "]");
+    // Cache de tags comum aos leitores: no prazo, suprimidas e despejadas
+    len = status_append(payload, sizeof(payload), len,
+                    ",\"rfid_cache\":{\"active\":%u,\"hits\":%lu,\"evictions\":%lu}",
+                    tag_cache_active(&rfid_tag_cache, time_us_32()),
+                    (unsigned long)rfid_tag_cache.hits, (unsigned long)rfid_tag_cache.evictions);
+    char node_json[RFID_TAG_NODE_NAME_MAX * 6];
+    json_escape(rfid_last_node, node_json, sizeof(node_json));
+    len = status_append(payload, sizeof(payload), len,
+                    ",\"rfid_tags\":{\"table\":%u,\"overlay\":%u,\"node\":%s%s%s}",
+                    rfid_tags_table_count(), rfid_tags_overlay_count(),
+                    node_json[0] ? "\"" : "", node_json[0] ? node_json : "null",
+                    node_json[0] ? "\"" : "");
+    // Sensor de cor: taxa real de leitura e exposição escolhida
+    uint32_t now_us = time_us_32();
+    uint32_t color_elapsed_ms = (now_us - color_stats_start_us) / 1000;
+    const gy33_config_t *color_cfg = gy33_get_config();
+    char marker_json[COLOR_NAME_MAX * 6];
+    json_escape(color_class_name(color_events_current(&color_events)), marker_json, sizeof(marker_json));
+    len = status_append(payload, sizeof(payload), len,
+                    ",\"color_sensor\":{\"rate_hz\":%lu,\"gain\":%u,\"integration_us\":%lu,\"wait_ms\":%u,\"ae_adjustments\":%lu,"
+                    "\"marker\":\"%s\",\"events\":%lu,\"dropped\":%lu,\"classes\":%u,\"calibration\":\"%s\",\"calib_refused\":%lu,"
+                    "\"wake\":{\"mode\":\"%s\",\"wakeups\":%lu,\"missed\":%lu}}",
+                    (unsigned long)(color_elapsed_ms ? (uint64_t)color_samples * 1000 / color_elapsed_ms : 0),
+                    gy33_gain_x(color_cfg->gain),
+                    (unsigned long)gy33_integration_us(),
+                    color_cfg->wait_ms, (unsigned long)color_cfg->ae_adjustments,
+                    marker_json,
+                    (unsigned long)color_events.events, (unsigned long)color_events.dropped,
+                    color_class_count(), color_calib_source(),
+                    (unsigned long)color_calib_flash_refused(),
+                    color_wake_state_name(&color_wake),
+                    (unsigned long)color_wake.wakeups, (unsigned long)color_wake.missed);
+    color_samples = 0;
+    color_stats_start_us = now_us;
+
+    len = status_append(payload, sizeof(payload), len, ",\"health\":{");
+
+    // Erros/timeouts/recuperações por barramento e estado de cada dispositivo
+    len += bus_supervisor_format_health(payload + len, sizeof(payload) - len);
+    len = status_append(payload, sizeof(payload), len, "}}");
+
+    // Truncado não é JSON válido: melhor não publicar
+    if ((size_t)len >= sizeof(payload) - 1) {
+        LOG_W(MQTT, "[MQTT] Status maior que %u bytes, nao publicado\n", (unsigned)sizeof(payload));
+        return;
+    }
+
+    err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_STATUS, payload, (u16_t)len,
+                             0, 0, mqtt_pub_request_cb, NULL);
+    if (err != ERR_OK) {
+        LOG_E(MQTT, "[MQTT] ERRO ao publicar status (%d bytes)! Codigo: %d\n", len, err);
+        if (err == ERR_CONN) {
+            mqtt_connected = false;
+        }
+    }
 }
 
 void mqtt_reconnect(void) {
@@ -522,149 +987,315 @@ void mqtt_reconnect(void) {
 
     if (diff_ms < RECONNECT_DELAY_MS) return;
 
-    printf("[MQTT] Tentando reconectar...\n");
+    LOG_I(MQTT, "[MQTT] Tentando reconectar...\n");
     last_reconnect_attempt = now;
     mqtt_init_and_connect();
 }
 
-// ========== IMPLEMENTAÇÃO - FILTROS DE VARIAÇÃO ==========
+// ========== IMPLEMENTAÇÃO - IMU ==========
 
-bool should_publish_imu(void) {
-    // Calcula variação percentual para cada eixo do acelerômetro e giroscópio
-    float variation_accel_x = 0.0;
-    float variation_accel_y = 0.0;
-    float variation_accel_z = 0.0;
-    float variation_gyro_x = 0.0;
-    float variation_gyro_y = 0.0;
-    float variation_gyro_z = 0.0;
-
-    // Acelerômetro - evita divisão por zero
-    if (fabsf(last_published_accel_x) > 0.1) {
-        variation_accel_x = fabsf(imu_data.accel_x - last_published_accel_x) / fabsf(last_published_accel_x);
-    } else {
-        variation_accel_x = 1.0; // Força publicação se era ~0
-    }
+// Supervisor: MPU6050 responde com WHO_AM_I válido?
+static bool imu_probe(void *ctx) {
+    return mpu6050_probe();
+}
 
-    if (fabsf(last_published_accel_y) > 0.1) {
-        variation_accel_y = fabsf(imu_data.accel_y - last_published_accel_y) / fabsf(last_published_accel_y);
-    } else {
-        variation_accel_y = 1.0;
-    }
+static bool imu_reinit(void *ctx) {
+    return mpu6050_init(&imu_bus);
+}
 
-    if (fabsf(last_published_accel_z) > 0.1) {
-        variation_accel_z = fabsf(imu_data.accel_z - last_published_accel_z) / fabsf(last_published_accel_z);
-    } else {
-        variation_accel_z = 1.0;
-    }
+// Lê o MPU6050 e informa o resultado ao supervisor
+static bool imu_read(void) {
+    bool ok = mpu6050_read_data(&imu_data);
+    bus_device_report(&imu_health, ok);
+    return ok;
+}
 
-    // Giroscópio - evita divisão por zero
-    if (fabsf(last_published_gyro_x) > 0.1) {
-        variation_gyro_x = fabsf(imu_data.gyro_x - last_published_gyro_x) / fabsf(last_published_gyro_x);
-    } else if (fabsf(imu_data.gyro_x) > 0.1) {
-        variation_gyro_x = 1.0; // Mudou de ~0 para algo significativo
-    }
+// ========== IMPLEMENTAÇÃO - FILTROS DE VARIAÇÃO ==========
 
-    if (fabsf(last_published_gyro_y) > 0.1) {
-        variation_gyro_y = fabsf(imu_data.gyro_y - last_published_gyro_y) / fabsf(last_published_gyro_y);
-    } else if (fabsf(imu_data.gyro_y) > 0.1) {
-        variation_gyro_y = 1.0;
-    }
+// Acelerômetro: força publicação se o último valor era ~0
+static bool imu_accel_changed(q16_t current, q16_t last) {
+    if (q16_abs(last) <= IMU_ZERO_THRESHOLD) return true;
+    return fixed_variation_exceeds(current, last,
+                                   VARIATION_THRESHOLD_NUM, VARIATION_THRESHOLD_DEN);
+}
 
-    if (fabsf(last_published_gyro_z) > 0.1) {
-        variation_gyro_z = fabsf(imu_data.gyro_z - last_published_gyro_z) / fabsf(last_published_gyro_z);
-    } else if (fabsf(imu_data.gyro_z) > 0.1) {
-        variation_gyro_z = 1.0;
-    }
+// Giroscópio: de ~0 só publica se passou a ter valor significativo
+static bool imu_gyro_changed(q16_t current, q16_t last) {
+    if (q16_abs(last) <= IMU_ZERO_THRESHOLD) return q16_abs(current) > IMU_ZERO_THRESHOLD;
+    return fixed_variation_exceeds(current, last,
+                                   VARIATION_THRESHOLD_NUM, VARIATION_THRESHOLD_DEN);
+}
 
+bool should_publish_imu(void) {
     // Publica se qualquer eixo variou mais que o threshold
-    return (variation_accel_x > VARIATION_THRESHOLD ||
-            variation_accel_y > VARIATION_THRESHOLD ||
-            variation_accel_z > VARIATION_THRESHOLD ||
-            variation_gyro_x > VARIATION_THRESHOLD ||
-            variation_gyro_y > VARIATION_THRESHOLD ||
-            variation_gyro_z > VARIATION_THRESHOLD);
+    return (imu_accel_changed(imu_data.accel_x, last_published_accel_x) ||
+            imu_accel_changed(imu_data.accel_y, last_published_accel_y) ||
+            imu_accel_changed(imu_data.accel_z, last_published_accel_z) ||
+            imu_gyro_changed(imu_data.gyro_x, last_published_gyro_x) ||
+            imu_gyro_changed(imu_data.gyro_y, last_published_gyro_y) ||
+            imu_gyro_changed(imu_data.gyro_z, last_published_gyro_z));
 }
 
 // ========== IMPLEMENTAÇÃO - SENSOR DE COR ==========
 
+// Ativa o canal do GY-33 quando ele está atrás do multiplexador
+static bool color_sensor_select(void) {
+    tca9548a_t *color_mux = COLOR_MUX;
+    return color_mux == NULL || tca9548a_select_channel(color_mux, GY33_CHANNEL);
+}
+
+// Supervisor: seleciona o canal do GY-33 e verifica se responde
+static bool color_sensor_probe(void *ctx) {
+    return color_sensor_select() && gy33_probe(COLOR_BUS);
+}
+
+static bool color_sensor_reinit(void *ctx) {
+    if (!color_sensor_select() || !gy33_init(COLOR_BUS)) return false;
+    color_wake_restart(&color_wake);    // Leitura contínua até reaprender o piso
+    return true;
+}
+
+#if PIN_COLOR_INT >= 0
+static void color_int_handler(void) {
+    if (gpio_get_irq_event_mask(PIN_COLOR_INT) & GPIO_IRQ_EDGE_FALL) {
+        gpio_acknowledge_irq(PIN_COLOR_INT, GPIO_IRQ_EDGE_FALL);
+        color_int_pending = true;
+    }
+}
+#endif
+
+// Pino INT do TCS34725: confere o fio forçando a interrupção (PERS = 0
+// interrompe a cada ciclo) antes de parar a leitura contínua no piso
+static bool color_int_init(void) {
+#if PIN_COLOR_INT >= 0
+    gpio_init(PIN_COLOR_INT);
+    gpio_set_dir(PIN_COLOR_INT, GPIO_IN);
+    gpio_pull_up(PIN_COLOR_INT);        // INT é dreno aberto
+
+    bool asserted = false;
+    if (gy33_set_interrupt(COLOR_BUS, 0xFFFF, 0xFFFF, 0)) {
+        sleep_us(2 * gy33_cycle_us());
+        asserted = !gpio_get(PIN_COLOR_INT);
+    }
+    bool released = gy33_disable_interrupt(COLOR_BUS);
+    sleep_us(10);
+    if (!asserted || !released || !gpio_get(PIN_COLOR_INT)) return false;
+
+    gpio_add_raw_irq_handler(PIN_COLOR_INT, color_int_handler);
+    gpio_set_irq_enabled(PIN_COLOR_INT, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Arma os limiares em volta do piso quando a leitura pode parar
+static void color_wake_update(void) {
+    bool hold = color_calib_sampling() ||
+                color_events_current(&color_events) != COLOR_CLASS_NONE;
+    if (color_wake_sample(&color_wake, color_c, hold) != COLOR_WAKE_ARM) return;
+
+    uint16_t low, high;
+    color_wake_thresholds(&color_wake, &low, &high);
+    color_int_pending = false;          // Borda dos limiares antigos
+    if (gy33_set_interrupt(COLOR_BUS, low, high, COLOR_WAKE_PERSISTENCE)) {
+        color_wake_armed(&color_wake);
+        LOG_D(COLOR, "[COR] Piso %u..%u: leitura parada ate a borda\n", low, high);
+    }
+}
+
 void init_color_sensor(void) {
-    printf("[COR] Inicializando sensor GY-33 no canal %d...\n", GY33_CHANNEL);
+    // Cores calibradas em campo (flash) ou de fábrica
+    color_calib_init();
+    color_events_init(&color_events);
+
+    LOG_I(COLOR, "[COR] Inicializando sensor GY-33 no %s...\n", COLOR_BUS->name);
 
-    // Seleciona o canal 7 do multiplexador para o sensor de cor
-    tca9548a_select_channel(&mux, GY33_CHANNEL);
+    // Seleciona o canal do sensor de cor (montagem com multiplexador)
+    bool ok = color_sensor_select();
     sleep_ms(50);
 
     // Inicializa o sensor GY-33
-    gy33_init(GY33_I2C_PORT);
-
-    printf("[COR] Sensor GY-33 inicializado!\n");
+    ok = ok && gy33_init(COLOR_BUS);
+
+    color_health = (bus_device_t){
+        .name = "color",
+        .bus = COLOR_BUS,
+        .mux = COLOR_MUX,
+        .probe = color_sensor_probe,
+        .reinit = color_sensor_reinit,
+    };
+    bus_supervisor_register(&color_health, ok);
+
+    // Sem pino INT conferido, a leitura fica contínua
+    bool wake = ok && color_int_init();
+    color_wake_init(&color_wake, wake);
+
+    if (ok) {
+        LOG_I(COLOR, "[COR] Sensor GY-33 inicializado! (despertar por limiar: %s)\n",
+              wake ? "sim" : "nao");
+    } else {
+        LOG_W(COLOR, "[COR] Sensor GY-33 nao respondeu\n");
+    }
 }
 
 void read_color_sensor(void) {
-    // Seleciona o canal do sensor de cor no multiplexador
-    if (!tca9548a_select_channel(&mux, GY33_CHANNEL)) {
-        return;
+    // Borda no pino INT: saiu da faixa do piso, leitura contínua
+    if (color_int_pending) {
+        color_int_pending = false;
+        color_wake_interrupt(&color_wake);
     }
 
-    // Lê os valores de cor do sensor
-    gy33_read_color(GY33_I2C_PORT, &color_r, &color_g, &color_b, &color_c);
+    if (!bus_device_online(&color_health)) {
+        detected_color = "---";
+        return;
+    }
 
-    // Identifica a cor detectada
-    detected_color = identificar_cor(color_r, color_g, color_b, color_c);
-}
+    // Seleciona o canal do sensor de cor (se houver mux) e lê os valores de cor
+    bool ok = color_sensor_select() &&
+              gy33_read_color(COLOR_BUS, &color_r, &color_g, &color_b, &color_c);
+    bus_device_report(&color_health, ok);
+    if (!ok) return;
+    color_samples++;
 
-void publish_color_data(void) {
-    if (!mqtt_connected) {
-        printf("[MQTT] Nao conectado, pulando publicacao de cor...\n");
+    // Integração em andamento durante a troca de exposição: valores inconsistentes
+    if (color_settling) {
+        color_settling = false;
         return;
     }
+    color_settling = gy33_auto_exposure(COLOR_BUS, color_c);
+    if (color_settling) {
+        color_wake_restart(&color_wake);    // O nível do piso muda com a exposição
+    } else {
+        color_wake_update();
+    }
 
-    // Verifica se o cliente MQTT está pronto
-    if (mqtt_client == NULL || !mqtt_client_is_connected(mqtt_client)) {
-        printf("[MQTT] Cliente nao esta pronto, pulando publicacao...\n");
-        mqtt_connected = false;
+    // Coleta de calibração: leituras brutas, sem classificar
+    if (color_calib_sampling()) {
+        color_calib_add_sample(color_r, color_g, color_b, color_c, time_us_32());
         return;
     }
 
-    char payload[128];
-    uint32_t timestamp = to_ms_since_boot(get_absolute_time());
-
-    snprintf(payload, sizeof(payload),
-             "{\"color\":\"%s\",\"timestamp\":%lu}",
-             detected_color, timestamp);
-
-    printf("[COR] Cor detectada: %s\n", detected_color);
-    printf("[MQTT] Publicando cor: %s\n", payload);
+    // Identifica a cor detectada (a proporção entre canais não depende da exposição)
+    color_match_t match = color_classify(color_r, color_g, color_b, color_c);
+    detected_color = color_class_name(match.index);
+    color_confidence = match.confidence;
+    color_events_update(&color_events, match, to_ms_since_boot(get_absolute_time()));
+}
 
-    err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_COLOR, payload, strlen(payload),
-                            1, 0, mqtt_pub_request_cb, NULL);
+// Publica o resultado do último comando de calibração de cor
+void publish_color_calib_report(void) {
+    char payload[COLOR_CALIB_REPORT_MAX];
+    if (!mqtt_connected || mqtt_client == NULL) return;
+    if (!color_calib_take_report(payload, sizeof(payload))) return;
 
+    err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_COLOR_CALIB_REPORT, payload, strlen(payload),
+                             1, 0, mqtt_pub_request_cb, NULL);
     if (err != ERR_OK) {
-        printf("[MQTT] ERRO ao publicar cor! Codigo: %d\n", err);
+        LOG_E(MQTT, "[MQTT] ERRO ao publicar calibracao de cor! Codigo: %d\n", err);
         if (err == ERR_CONN) {
             mqtt_connected = false;
         }
     }
 }
 
+// Publica as entradas/saídas de marcador pendentes (a cor atual vai em "color")
+void publish_color_events(void) {
+    if (!mqtt_connected || mqtt_client == NULL) return;
+
+    // Só sai da fila depois de publicado: com ERR_MEM, tenta de novo na próxima volta
+    color_event_t ev;
+    while (color_events_peek(&color_events, &ev)) {
+        // Nome da cor calibrado pelo backend: escapado no JSON
+        char node[COLOR_NAME_MAX * 6];
+        json_escape(color_class_name(ev.color), node, sizeof(node));
+        char payload[384];
+        if (ev.type == COLOR_EVENT_ENTER) {
+            snprintf(payload, sizeof(payload),
+                     "{\"event\":\"enter\",\"color\":\"%s\",\"node\":\"%s\",\"confidence\":%u,\"timestamp\":%lu}",
+                     node, node, ev.confidence, ev.timestamp_ms);
+        } else {
+            snprintf(payload, sizeof(payload),
+                     "{\"event\":\"exit\",\"color\":\"---\",\"node\":\"%s\",\"dwell_ms\":%lu,\"timestamp\":%lu}",
+                     node, ev.dwell_ms, ev.timestamp_ms);
+        }
+
+        // Só o índice no log: o nome fica num vetor em RAM refeito a cada recarga
+        LOG_I(COLOR, "[COR] Marcador %s: cor %u (%lu ms)\n",
+              color_event_type_name(ev.type), ev.color, ev.dwell_ms);
+
+        err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_COLOR, payload, strlen(payload),
+                                 1, 0, mqtt_pub_request_cb, NULL);
+        if (err != ERR_OK) {
+            LOG_E(MQTT, "[MQTT] ERRO ao publicar evento de cor! Codigo: %d\n", err);
+            if (err == ERR_CONN) {
+                mqtt_connected = false;
+            }
+            break;
+        }
+        color_events_pop(&color_events, &ev);
+    }
+}
+
+// ========== IMPLEMENTAÇÃO - RITMO DO LOOP ==========
+
+// Antecipa wake_us para at_us (instantes de time_us_32, com volta)
+static void loop_deadline(uint32_t *wake_us, uint32_t at_us) {
+    if ((int32_t)(at_us - *wake_us) < 0) *wake_us = at_us;
+}
+
+// Próximo sensor de distância devido ou medição que já deveria ter terminado
+void distance_deadline(uint32_t *wake_us) {
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        if (!bus_device_online(&tof_health[i])) continue;
+        if (!ranging_pending[i]) {
+            loop_deadline(wake_us, tof_profile_next_us(&tof_profiles[i]));
+            continue;
+        }
+        uint32_t done_us = ranging_start_us[i] +
+                           tof_profile_get(tof_profiles[i].current)->timing_budget_us;
+        uint32_t now_us = time_us_32();
+        // Passou do timing budget sem amostra: consulta a cada LOOP_BUSY_POLL_US
+        loop_deadline(wake_us, (int32_t)(done_us - now_us) > 0 ? done_us : now_us + LOOP_BUSY_POLL_US);
+    }
+}
+
+// Dorme até wake_us; qualquer interrupção (rede, pino INT do sensor de cor,
+// IRQ dos leitores RFID) acorda antes e o loop roda de novo
+static void loop_wait_until(uint32_t wake_us) {
+    int32_t wait_us = (int32_t)(wake_us - time_us_32());
+    if (wait_us <= 0 || color_int_pending) return;
+    best_effort_wfe_or_timeout(make_timeout_time_us((uint64_t)wait_us));
+}
+
 // ========== FUNÇÃO PRINCIPAL ==========
 
 int main() {
     stdio_init_all();
+    agv_log_init();
+
+    // Linhas de segurança em PARADA desde o boot, antes de qualquer conexão
+    safety_reflex_init();
     sleep_ms(3000);
 
-    printf("\n");
-    printf("========================================\n");
-    printf("  Hardware Layer Unificado\n");
-    printf("  RFID + Distancia + IMU + Cor\n");
-    printf("  Dashboard Integration via MQTT\n");
-    printf("========================================\n\n");
+    LOG_I(SYS, "\n");
+    LOG_I(SYS, "========================================\n");
+    LOG_I(SYS, "  Hardware Layer Unificado\n");
+    LOG_I(SYS, "  RFID + Distancia + IMU + Cor\n");
+    LOG_I(SYS, "  Dashboard Integration via MQTT\n");
+    LOG_I(SYS, "========================================\n\n");
+
+#if BENCHMARK_FIXED_POINT
+    benchmark_fixed_point_run();
+#endif
 
     // PASSO 1: Conectar ao WiFi
     connect_wifi();
     if (!wifi_connected) {
-        printf("\n[ERRO] WiFi nao conectou! Verifique credenciais.\n");
-        printf("Encerrando...\n");
+        LOG_E(SYS, "\n[ERRO] WiFi nao conectou! Verifique credenciais.\n");
+        LOG_I(SYS, "Encerrando...\n");
+        agv_log_flush();
         return 1;
     }
 
@@ -673,86 +1304,125 @@ int main() {
     sleep_ms(2000);
 
     if (!mqtt_connected) {
-        printf("\n[AVISO] MQTT nao conectou! Tentando continuar...\n");
-        printf("Verifique se o broker esta rodando em: %s:%d\n",
-               MQTT_BROKER_IP, MQTT_BROKER_PORT);
+        LOG_W(SYS, "\n[AVISO] MQTT nao conectou! Tentando continuar...\n");
+        LOG_I(SYS, "Verifique se o broker esta rodando em: %s:%d\n",
+                   MQTT_BROKER_IP, MQTT_BROKER_PORT);
     }
 
     // PASSO 3: Configurar hardware RFID
-    printf("\n[RFID] Configurando hardware...\n");
+    LOG_I(RFID, "\n[RFID] Configurando hardware...\n");
     setup_gpio_rfid();
 
-    MFRC522Ptr_t mfrc = MFRC522_Init();
-    if (mfrc == NULL) {
-        printf("[ERRO] Falha ao inicializar MFRC522!\n");
-        printf("Verifique conexoes do modulo RFID:\n");
-        printf("  MISO -> GP%d\n", PIN_MISO);
-        printf("  MOSI -> GP%d\n", PIN_MOSI);
-        printf("  SCK  -> GP%d\n", PIN_SCK);
-        printf("  CS   -> GP%d\n", PIN_CS);
-        printf("  RST  -> GP%d\n", PIN_RST);
-        while(1) sleep_ms(1000);
+    setup_rfid_readers();
+    if (rfid_readers[0] == NULL) {
+        LOG_E(SYS, "[ERRO] Falha ao inicializar MFRC522!\n");
+        LOG_I(SYS, "Verifique conexoes do modulo RFID:\n");
+        LOG_I(SYS, "  MISO -> GP%d\n", PIN_MISO);
+        LOG_I(SYS, "  MOSI -> GP%d\n", PIN_MOSI);
+        LOG_I(SYS, "  SCK  -> GP%d\n", PIN_SCK);
+        LOG_I(SYS, "  CS   -> GP%d\n", PIN_CS);
+        LOG_I(SYS, "  RST  -> GP%d\n", PIN_RST);
     }
 
-    PCD_Init(mfrc, spi0);
-    printf("[RFID] Leitor inicializado com sucesso!\n");
+#if BENCHMARK_MFRC522_SPI
+    if (rfid_readers[0]) {
+        benchmark_mfrc522_spi_run(rfid_readers[0]);
+    }
+#endif
 
     // PASSO 4: Configurar sensores de distância (I2C0)
-    printf("\n[DISTANCIA] Configurando I2C0 e sensores...\n");
+    LOG_I(DIST, "\n[DISTANCIA] Configurando I2C0 e sensores...\n");
     setup_i2c_distance();
     init_distance_sensors();
 
-    // PASSO 5: Configurar MPU6050 (I2C1 - SEPARADO!)
-    printf("\n[IMU] Configurando I2C1 para MPU6050...\n");
-    i2c_init(MPU_I2C_PORT, 400 * 1000);
-    gpio_set_function(MPU_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(MPU_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(MPU_SDA_PIN);
-    gpio_pull_up(MPU_SCL_PIN);
-    printf("[IMU] I2C1 configurado: SDA=GP%d, SCL=GP%d\n", MPU_SDA_PIN, MPU_SCL_PIN);
+#if BENCHMARK_VL53L0X_RANGING
+    if (bus_device_online(&tof_health[0])) {
+        benchmark_vl53l0x_ranging_run(&gVL53L0XDevices[0]);
+    }
+#endif
+
+#if BENCHMARK_TOF_BUSES
+    {
+        VL53L0X_Dev_t *online[NUM_SENSORS];
+        uint8_t n = 0;
+        for (int i = 0; i < NUM_SENSORS; i++) {
+            if (bus_device_online(&tof_health[i])) online[n++] = &gVL53L0XDevices[i];
+        }
+        benchmark_tof_buses_run(online, n);
+    }
+#endif
 
-    mpu6050_init(MPU_I2C_PORT);
-    printf("[IMU] MPU6050 inicializado!\n");
+    // PASSO 5: Configurar MPU6050 (I2C1 - SEPARADO!)
+    LOG_I(IMU, "\n[IMU] Configurando I2C1 para MPU6050...\n");
+    i2c_bus_init_hw(&imu_bus, "i2c1", MPU_I2C_PORT, MPU_SDA_PIN, MPU_SCL_PIN, 400 * 1000);
+    LOG_I(IMU, "[IMU] I2C1 configurado: SDA=GP%d, SCL=GP%d\n", MPU_SDA_PIN, MPU_SCL_PIN);
+
+    imu_health = (bus_device_t){
+        .name = "imu",
+        .bus = &imu_bus,
+        .probe = imu_probe,
+        .reinit = imu_reinit,
+    };
+    bus_supervisor_register(&imu_health, mpu6050_init(&imu_bus));
 
     // PASSO 6: Inicializar sensor de cor GY-33
-    printf("\n[COR] Configurando sensor de cor no I2C0...\n");
+    LOG_I(COLOR, "\n[COR] Configurando sensor de cor no %s...\n", COLOR_BUS->name);
     init_color_sensor();
 
-    printf("\n========================================\n");
-    printf("  Sistema pronto!\n");
-    printf("========================================\n");
-    printf("Topicos MQTT:\n");
-    printf("  - RFID: %s\n", MQTT_TOPIC_RFID);
-    printf("  - Distancia: %s\n", MQTT_TOPIC_DISTANCE);
-    printf("  - IMU: %s\n", MQTT_TOPIC_IMU);
-    printf("  - Cor: %s\n", MQTT_TOPIC_COLOR);
-    printf("  - Status: %s\n", MQTT_TOPIC_STATUS);
-    printf("\nLendo sensores e publicando via MQTT...\n\n");
+    LOG_I(SYS, "\n========================================\n");
+    LOG_I(SYS, "  Sistema pronto!\n");
+    LOG_I(SYS, "========================================\n");
+    LOG_I(SYS, "Topicos MQTT:\n");
+    LOG_I(SYS, "  - RFID: %s\n", MQTT_TOPIC_RFID);
+    LOG_I(SYS, "  - Distancia: %s\n", MQTT_TOPIC_DISTANCE);
+    LOG_I(SYS, "  - IMU: %s\n", MQTT_TOPIC_IMU);
+    LOG_I(SYS, "  - Cor: %s\n", MQTT_TOPIC_COLOR);
+    LOG_I(SYS, "  - Status: %s\n", MQTT_TOPIC_STATUS);
+    LOG_I(SYS, "  - Seguranca: %s\n", MQTT_TOPIC_SAFETY);
+    LOG_I(SYS, "\nLendo sensores e publicando via MQTT...\n\n");
 
     // Inicializa controle de tempo
-    last_read_time = get_absolute_time();
     last_reconnect_attempt = get_absolute_time();
     last_forced_imu_publish = get_absolute_time();
     absolute_time_t last_status = get_absolute_time();
     absolute_time_t last_distance_publish = get_absolute_time();
     absolute_time_t last_imu_publish = get_absolute_time();
-    absolute_time_t last_color_publish = get_absolute_time();
+    absolute_time_t last_color_sample = get_absolute_time();
+    int64_t color_period = 0;
 
     uint32_t loop_count = 0;
+    for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+        if (rfid_readers[r]) rfid_poller_init(&rfid_pollers[r], rfid_readers[r], time_us_32());
+    }
+    tag_cache_init(&rfid_tag_cache);
+    color_stats_start_us = time_us_32();
 
     // ========== LOOP PRINCIPAL ==========
     while (1) {
         // Processa eventos de rede (crítico para lwIP)
         cyw43_arch_poll();
 
+        // Fim da piscada do LED (aceso = conectado ao broker)
+        if (led_blink_pending && time_us_32() - led_blink_start_us >= LED_BLINK_MS * 1000u) {
+            led_blink_pending = false;
+            cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, mqtt_connected);
+        }
+
         // Reconecta MQTT se necessário (com proteção de taxa)
         if (!mqtt_connected && wifi_connected) {
             mqtt_reconnect();
         }
 
-        // Lê sensores de distância continuamente
+        // Libera barramentos presos e religa sensores offline
+        bus_supervisor_poll(time_us_32());
+
+        // Lê sensores de distância continuamente (reflexo avaliado a cada amostra;
+        // sensor sem amostra é tratado pelo timer do reflexo)
         read_distance_sensors();
 
+        // Eventos de segurança vão para o MQTT depois, sem atrasar o reflexo
+        publish_safety_events();
+
         // Obtém timestamp atual
         absolute_time_t now = get_absolute_time();
 
@@ -760,79 +1430,125 @@ int main() {
         if (mqtt_connected && absolute_time_diff_us(last_distance_publish, now) > 1000000) {
             publish_distance_data();
             last_distance_publish = now;
-            // Dá tempo para processar a publicação
-            cyw43_arch_poll();
-            sleep_ms(10);
         }
 
-        // Verifica se há cartão RFID próximo
-        if (PICC_IsNewCardPresent(mfrc)) {
-            if (PICC_ReadCardSerial(mfrc)) {
-                if (!is_same_tag(mfrc->uid.uidByte, mfrc->uid.size)) {
-                    publish_rfid_tag(mfrc->uid.uidByte, mfrc->uid.size);
-                    printf("----------------------------------------\n");
-                    // Dá tempo para processar a publicação
-                    cyw43_arch_poll();
-                    sleep_ms(10);
+        // Inventário RFID: cada leitor avança (WUPA/REQA, anticolisão, seleção,
+        // HLTA) até ficar esperando a resposta no RF ou o próximo ciclo; os
+        // leitores são intercalados, e enquanto um espera o RF o SPI atende o
+        // outro. Toda tag no campo volta a cada ciclo; o cache (comum aos
+        // leitores) só deixa passar as novas
+        for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+            if (rfid_readers[r] == NULL) continue;
+            for (uint8_t n = 0; n < RFID_STEPS_PER_PASS; n++) {
+                if (!rfid_poller_step(&rfid_pollers[r], time_us_32())) {
+                    if (rfid_pollers[r].waiting) break;
+                    continue;
+                }
+                const Uid *uid = &rfid_pollers[r].uid;
+                if (!tag_cache_seen(&rfid_tag_cache, uid->uidByte, uid->size, time_us_32())) continue;
+
+                const char *node = locate_rfid_tag(uid->uidByte, uid->size);
+                publish_rfid_tag(uid->uidByte, uid->size, node, r);
+                rfid_poller_published(&rfid_pollers[r], time_us_32());
+                // A próxima tag do percurso pode passar sob qualquer antena
+                for (uint8_t o = 0; o < RFID_READER_COUNT; o++) {
+                    if (o != r && rfid_readers[o]) {
+                        rfid_poller_expect_tag(&rfid_pollers[o], time_us_32(), RFID_EXPECT_WINDOW_MS);
+                    }
                 }
-                PCD_StopCrypto1(mfrc);
+                LOG_D(RFID, "----------------------------------------\n");
             }
         }
 
         // Lê e publica IMU a cada 2 segundos (publicação contínua garantida)
-        if (mqtt_connected && absolute_time_diff_us(last_imu_publish, now) > 2000000) {
-            mpu6050_read_data(&imu_data);
+        if (mqtt_connected && absolute_time_diff_us(last_imu_publish, now) > 2000000 &&
+            bus_device_online(&imu_health) && imu_read()) {
+
+            // Q16.16 -> centésimos; o float só existe no texto do JSON
+            int32_t ax = q16_to_centi(imu_data.accel_x);
+            int32_t ay = q16_to_centi(imu_data.accel_y);
+            int32_t az = q16_to_centi(imu_data.accel_z);
+            int32_t gx = q16_to_centi(imu_data.gyro_x);
+            int32_t gy = q16_to_centi(imu_data.gyro_y);
+            int32_t gz = q16_to_centi(imu_data.gyro_z);
+            int32_t tc = q16_to_centi(imu_data.temp_c);
 
             char payload[256];
             snprintf(payload, sizeof(payload),
-                     "{\"accel\":{\"x\":%.2f,\"y\":%.2f,\"z\":%.2f},"
-                     "\"gyro\":{\"x\":%.2f,\"y\":%.2f,\"z\":%.2f},"
-                     "\"temp\":%.2f,"
+                     "{\"accel\":{\"x\":" FIXED_CENTI_FMT ",\"y\":" FIXED_CENTI_FMT ",\"z\":" FIXED_CENTI_FMT "},"
+                     "\"gyro\":{\"x\":" FIXED_CENTI_FMT ",\"y\":" FIXED_CENTI_FMT ",\"z\":" FIXED_CENTI_FMT "},"
+                     "\"temp\":" FIXED_CENTI_FMT ","
                      "\"timestamp\":%lu}",
-                     imu_data.accel_x, imu_data.accel_y, imu_data.accel_z,
-                     imu_data.gyro_x, imu_data.gyro_y, imu_data.gyro_z,
-                     imu_data.temp_c,
+                     FIXED_CENTI_ARGS(ax), FIXED_CENTI_ARGS(ay), FIXED_CENTI_ARGS(az),
+                     FIXED_CENTI_ARGS(gx), FIXED_CENTI_ARGS(gy), FIXED_CENTI_ARGS(gz),
+                     FIXED_CENTI_ARGS(tc),
                      to_ms_since_boot(get_absolute_time()));
 
             err_t err = mqtt_publish(mqtt_client, MQTT_TOPIC_IMU, payload, strlen(payload),
                         1, 0, mqtt_pub_request_cb, NULL);
 
             if (err == ERR_OK) {
-                printf("[IMU] Dados publicados: Accel(%.2f,%.2f,%.2f) Gyro(%.2f,%.2f,%.2f)\n",
-                       imu_data.accel_x, imu_data.accel_y, imu_data.accel_z,
-                       imu_data.gyro_x, imu_data.gyro_y, imu_data.gyro_z);
+                LOG_D(IMU, "[IMU] Dados publicados (x100): Accel(%ld,%ld,%ld) Gyro(%ld,%ld,%ld)\n",
+                      ax, ay, az, gx, gy, gz);
                 last_imu_publish = now;
             } else {
-                printf("[MQTT] ERRO ao publicar IMU! Codigo: %d\n", err);
+                LOG_E(MQTT, "[MQTT] ERRO ao publicar IMU! Codigo: %d\n", err);
                 if (err == ERR_CONN) {
                     mqtt_connected = false;
                 }
             }
-            cyw43_arch_poll();
-            sleep_ms(10);
         }
 
-        // Lê e publica sensor de cor a cada 2 segundos
-        if (mqtt_connected && absolute_time_diff_us(last_color_publish, now) > 2000000) {
+        // Lê o sensor de cor a cada leitura completa do TCS34725 (gy33_cycle_us(),
+        // ~17 ms) perto de marcadores; no piso liso, só na borda acusada pelo
+        // pino INT (e no heartbeat). Só entradas e saídas de marcador vão para o MQTT
+        color_period = color_wake_full_rate(&color_wake) ? (int64_t)gy33_cycle_us()
+                                                         : COLOR_WAKE_HEARTBEAT_MS * 1000LL;
+        if (color_int_pending || absolute_time_diff_us(last_color_sample, now) >= color_period) {
+            last_color_sample = now;
             read_color_sensor();
-            publish_color_data();
-            last_color_publish = now;
-            cyw43_arch_poll();
-            sleep_ms(10);
+            publish_color_events();
+        }
+
+        // Calibração de cor: conclui coletas, grava na flash (só em STOP) e
+        // publica o resultado; uma gravação recusada também sai no status
+        uint32_t calib_refused = color_calib_flash_refused();
+        if (color_calib_poll(time_us_32(), safety_reflex_state() == SAFETY_STOP)) {
+            color_events_init(&color_events);   // Índices das cores mudaram
+        }
+        publish_color_calib_report();
+        if (color_calib_flash_refused() != calib_refused) {
+            publish_status("online");
         }
 
         // Publica status periodicamente (a cada 30 segundos)
         if (mqtt_connected && absolute_time_diff_us(last_status, now) > STATUS_PUBLISH_INTERVAL) {
             publish_status("online");
             last_status = now;
-            printf("[INFO] Status publicado (loop: %lu)\n", loop_count);
-            // Dá tempo para processar a publicação
-            cyw43_arch_poll();
-            sleep_ms(10);
+            LOG_D(SYS, "[INFO] Status publicado (loop: %lu)\n", loop_count);
         }
 
+#if !LOG_DRAIN_ON_CORE1
+        // Sem core1 dedicado, os logs são esvaziados aqui, fora das leituras
+        agv_log_drain(LOG_DRAIN_BATCH);
+#endif
+
         loop_count++;
-        sleep_ms(SCAN_INTERVAL_MS);
+
+        // Dorme até o prazo mais próximo (RFID, ToF, cor); interrupções
+        // (rede, INT do sensor de cor, IRQ dos leitores) acordam antes
+        uint32_t wake_us = time_us_32() + SCAN_INTERVAL_MS * 1000u;
+        for (uint8_t r = 0; r < RFID_READER_COUNT; r++) {
+            if (rfid_readers[r]) loop_deadline(&wake_us, rfid_poller_next_us(&rfid_pollers[r], time_us_32()));
+        }
+        distance_deadline(&wake_us);
+        if (bus_device_online(&color_health)) {
+            loop_deadline(&wake_us, (uint32_t)to_us_since_boot(last_color_sample) + (uint32_t)color_period);
+        }
+        if (led_blink_pending) {
+            loop_deadline(&wake_us, led_blink_start_us + LED_BLINK_MS * 1000u);
+        }
+        loop_wait_until(wake_us);
     }
 
     // Cleanup (nunca alcançado)
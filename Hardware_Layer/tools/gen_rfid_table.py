@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Gera a tabela de tags RFID do firmware a partir de data/rfid-tags.json.
+
+O JSON é o mesmo banco do backend (rfidService.js): UID em hex -> {name, ...}.
+O campo opcional "node" liga a tag a um nó do mapa (ex.: "Lilás"). A saída é
+ordenada por (tamanho do UID, bytes), para busca binária em rfid_tags.c:
+
+    RFID_TAG_TABLE[]   UID, tamanho, índice do nó, deslocamento do nome
+    RFID_TAG_NAMES     nomes terminados em '\\0', um após o outro
+    RFID_TAG_NODES[]   nós distintos
+
+Fica tudo em flash (static const). Executado pelo CMake quando o JSON muda.
+
+Uso:
+    python3 tools/gen_rfid_table.py ../data/rfid-tags.json saida.h
+"""
+
+import json
+import sys
+
+UID_SIZES = (4, 7, 10)  # ISO/IEC 14443-3: simples, duplo e triplo
+NO_NODE = 0xFF
+
+# ========== LEITURA DO BANCO ==========
+
+def ler_tags(caminho):
+    with open(caminho, encoding='utf-8') as f:
+        banco = json.load(f)
+
+    tags = []
+    for uid_hex, info in banco.items():
+        try:
+            uid = bytes.fromhex(uid_hex)
+        except ValueError:
+            raise ValueError('UID inválido: %r' % uid_hex)
+        if len(uid) not in UID_SIZES:
+            raise ValueError('UID com %d bytes: %s' % (len(uid), uid_hex))
+        tags.append((uid, info.get('name', ''), info.get('node')))
+
+    # Mesma ordem de rfid_tag_compare(): tamanho, depois bytes
+    tags.sort(key=lambda t: (len(t[0]), t[0]))
+    return tags
+
+# ========== SAÍDA ==========
+
+def literal_c(texto):
+    """String C com bytes não ASCII em octal (UTF-8 sem depender do compilador)."""
+    partes = []
+    for b in texto.encode('utf-8'):
+        if b in (0x22, 0x5C):
+            partes.append('\\' + chr(b))
+        elif 0x20 <= b < 0x7F:
+            partes.append(chr(b))
+        else:
+            partes.append('\\%03o' % b)
+    return ''.join(partes)
+
+
+def gerar(tags, caminho):
+    nos = sorted({no for _, _, no in tags if no})
+    if len(nos) >= NO_NODE:
+        raise ValueError('nós demais: %d' % len(nos))
+
+    linhas = [
+        '// Gerado por tools/gen_rfid_table.py a partir de data/rfid-tags.json - não editar',
+        '#ifndef RFID_TAG_TABLE_H',
+        '#define RFID_TAG_TABLE_H',
+        '',
+        '#define RFID_TAG_TABLE_COUNT  %d' % len(tags),
+        '#define RFID_TAG_NODE_COUNT   %d' % len(nos),
+        '',
+        'static const char *const RFID_TAG_NODES[RFID_TAG_NODE_COUNT + 1] = {',
+    ]
+    linhas += ['    "%s",' % literal_c(no) for no in nos]
+    linhas += [
+        '    NULL',
+        '};',
+        '',
+        'static const char RFID_TAG_NAMES[] =',
+    ]
+
+    deslocamentos = []
+    total = 0
+    for _, nome, _ in tags:
+        deslocamentos.append(total)
+        total += len(nome.encode('utf-8')) + 1
+        linhas.append('    "%s\\0"' % literal_c(nome))
+    if total > 0xFFFF:
+        raise ValueError('nomes somam %d bytes (máximo 65535)' % total)
+    linhas += [
+        '    "";',
+        '',
+        'static const rfid_tag_entry_t RFID_TAG_TABLE[RFID_TAG_TABLE_COUNT + 1] = {',
+    ]
+    for (uid, nome, no), desl in zip(tags, deslocamentos):
+        no_idx = nos.index(no) if no else NO_NODE
+        linhas.append('    { { %s }, %d, 0x%02X, %d },  // %s' %
+                      (', '.join('0x%02X' % b for b in uid), len(uid), no_idx, desl,
+                       uid.hex().upper()))
+    linhas += [
+        '    { { 0 }, 0, 0, 0 }',
+        '};',
+        '',
+        '#endif // RFID_TAG_TABLE_H',
+        '',
+    ]
+    with open(caminho, 'w') as f:
+        f.write('\n'.join(linhas))
+    return total
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    tags = ler_tags(sys.argv[1])
+    nomes = gerar(tags, sys.argv[2])
+    print('rfid tags: %d tags, %d bytes de nomes' % (len(tags), nomes))
+
+
+if __name__ == '__main__':
+    main()
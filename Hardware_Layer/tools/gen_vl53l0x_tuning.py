@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Gera a tabela de tuning do VL53L0X com escritas em rajada.
+
+Lê DefaultTuningSettings de vl53l0x_tuning.h (formato da ST: N, registrador,
+N bytes; N = 0xFF para parâmetros internos; 0 encerra) e junta escritas
+consecutivas em registradores contíguos numa única entrada de até 4 bytes
+(limite de VL53L0X_load_tuning_settings). A ordem das escritas é mantida;
+a troca de página (registrador 0xFF) nunca é agrupada.
+
+A saída usa o mesmo formato da ST, então é carregada sem alterar a API
+(VL53L0X_SetTuningSettingBuffer). Executado pelo CMake a cada build.
+
+Uso:
+    python3 tools/gen_vl53l0x_tuning.py lib/vl53l0x/core/inc/vl53l0x_tuning.h saida.h
+"""
+
+import re
+import sys
+
+MAX_BURST = 4           # localBuffer[4] em VL53L0X_load_tuning_settings
+PAGE_REGISTER = 0xFF
+
+# ========== LEITURA DA TABELA DA ST ==========
+
+def ler_tabela(caminho):
+    with open(caminho, encoding='latin-1') as f:
+        texto = f.read()
+
+    m = re.search(r'DefaultTuningSettings\[\]\s*=\s*\{(.*?)\};', texto, re.S)
+    if not m:
+        raise ValueError('DefaultTuningSettings não encontrado em ' + caminho)
+
+    corpo = re.sub(r'/\*.*?\*/', '', m.group(1), flags=re.S)
+    return [int(v, 16) for v in re.findall(r'0x[0-9a-fA-F]+', corpo)]
+
+
+def decodificar(valores):
+    """Lista de entradas: ('w', reg, [bytes]) ou ('p', [bytes brutos])."""
+    entradas = []
+    i = 0
+    while valores[i] != 0:
+        n = valores[i]
+        if n == 0xFF:
+            entradas.append(('p', valores[i:i + 4]))
+            i += 4
+        elif n <= MAX_BURST:
+            entradas.append(('w', valores[i + 1], valores[i + 2:i + 2 + n]))
+            i += 2 + n
+        else:
+            raise ValueError('entrada inválida no índice %d' % i)
+    return entradas
+
+# ========== AGRUPAMENTO ==========
+
+def agrupar(entradas):
+    saida = []
+    for e in entradas:
+        if e[0] == 'w' and saida and saida[-1][0] == 'w':
+            _, reg, dados = saida[-1]
+            contiguo = e[1] == reg + len(dados)
+            if (contiguo and PAGE_REGISTER not in (reg, e[1]) and
+                    len(dados) + len(e[2]) <= MAX_BURST):
+                saida[-1] = ('w', reg, dados + e[2])
+                continue
+        saida.append(e)
+    return saida
+
+
+def escritas(entradas):
+    return sum(1 for e in entradas if e[0] == 'w')
+
+# ========== SAÍDA ==========
+
+def gerar(origem, agrupadas, caminho):
+    linhas = [
+        '// Gerado por tools/gen_vl53l0x_tuning.py a partir de vl53l0x_tuning.h - não editar',
+        '#ifndef VL53L0X_TUNING_BURST_H',
+        '#define VL53L0X_TUNING_BURST_H',
+        '',
+        '#include <stdint.h>',
+        '',
+        '#define VL53L0X_TUNING_WRITES_DEFAULT  %d   // Transações da tabela original' % escritas(origem),
+        '#define VL53L0X_TUNING_WRITES_BURST    %d   // Transações desta tabela' % escritas(agrupadas),
+        '',
+        'static const uint8_t VL53L0X_TuningSettingsBurst[] = {',
+    ]
+    for e in agrupadas:
+        if e[0] == 'p':
+            valores = e[1]
+        else:
+            valores = [len(e[2]), e[1]] + e[2]
+        linhas.append('    ' + ', '.join('0x%02X' % v for v in valores) + ',')
+    linhas += [
+        '    0x00',
+        '};',
+        '',
+        '#endif // VL53L0X_TUNING_BURST_H',
+        '',
+    ]
+    with open(caminho, 'w') as f:
+        f.write('\n'.join(linhas))
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    origem = decodificar(ler_tabela(sys.argv[1]))
+    agrupadas = agrupar(origem)
+    gerar(origem, agrupadas, sys.argv[2])
+    print('vl53l0x tuning: %d -> %d escritas' % (escritas(origem), escritas(agrupadas)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Decodificador dos frames binários de log (LOG_OUTPUT_BINARY = 1).
+
+Formato de cada frame (little-endian):
+    A5 5A | nargs (1 byte) | nível<<5 | módulo (1 byte)
+    timestamp_us (u32) | endereço do formato (u32) | args (nargs x u32)
+
+As strings de formato (e argumentos "%s") são lidas do ELF gerado pelo
+build, usando o endereço gravado no frame. Bytes fora de frames são
+repassados como texto (saída do printf normal).
+
+Uso:
+    python3 tools/log_decoder.py build/Hardware_Layer.elf /dev/ttyACM0
+    python3 tools/log_decoder.py build/Hardware_Layer.elf captura.bin
+    cat captura.bin | python3 tools/log_decoder.py build/Hardware_Layer.elf
+"""
+
+import re
+import struct
+import sys
+
+SYNC = b'\xA5\x5A'
+NIVEIS = {1: 'E', 2: 'W', 3: 'I', 4: 'D'}
+MODULOS = ['SYS', 'WIFI', 'MQTT', 'RFID', 'DIST', 'IMU', 'COLOR']
+
+# ========== LEITURA DO ELF ==========
+
+class Elf:
+    """Leitor mínimo de ELF32 little-endian: mapeia endereços para bytes."""
+
+    def __init__(self, caminho):
+        with open(caminho, 'rb') as f:
+            self.dados = f.read()
+        if self.dados[:4] != b'\x7fELF' or self.dados[4] != 1:
+            raise ValueError('arquivo não é um ELF32')
+
+        (shoff,) = struct.unpack_from('<I', self.dados, 0x20)
+        shentsize, shnum = struct.unpack_from('<HH', self.dados, 0x2E)
+
+        # Seções com conteúdo carregado (PROGBITS com flag ALLOC)
+        self.secoes = []
+        for i in range(shnum):
+            base = shoff + i * shentsize
+            (_, tipo, flags, addr, offset, tamanho) = struct.unpack_from('<IIIIII', self.dados, base)
+            if tipo == 1 and (flags & 0x2) and addr != 0:
+                self.secoes.append((addr, offset, tamanho))
+
+    def string(self, endereco):
+        for addr, offset, tamanho in self.secoes:
+            if addr <= endereco < addr + tamanho:
+                inicio = offset + (endereco - addr)
+                fim = self.dados.index(b'\x00', inicio)
+                return self.dados[inicio:fim].decode('utf-8', errors='replace')
+        return None
+
+# ========== FORMATAÇÃO ==========
+
+ESPEC = re.compile(r'%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])')
+
+def formatar(elf, fmt, args):
+    """Aplica o formato estilo printf aos argumentos brutos de 32 bits."""
+    args = list(args)
+
+    def substituir(m):
+        flags, largura, precisao, _, conv = m.groups()
+        if conv == '%':
+            return '%'
+        if largura == '*':
+            largura = str(args.pop(0) if args else 0)
+        valor = args.pop(0) if args else 0
+        spec = '%' + flags + (largura or '') + ('.' + precisao if precisao else '')
+
+        if conv in 'di':
+            if valor & 0x80000000:
+                valor -= 1 << 32
+            return (spec + 'd') % valor
+        if conv == 'c':
+            return (spec + 'c') % chr(valor & 0xFF)
+        if conv == 's':
+            texto = elf.string(valor)
+            return (spec + 's') % (texto if texto is not None else '<0x%08X>' % valor)
+        if conv == 'p':
+            return '0x%08x' % valor
+        return (spec + conv) % valor
+
+    return ESPEC.sub(substituir, fmt)
+
+# ========== LEITURA DOS FRAMES ==========
+
+def decodificar(elf, entrada, saida):
+    buffer = b''
+    while True:
+        bloco = entrada.read(1) if entrada.isatty() else entrada.read(4096)
+        if not bloco:
+            break
+        buffer += bloco
+
+        while True:
+            pos = buffer.find(SYNC)
+            if pos < 0:
+                # Mantém o último byte caso seja o início de um sync
+                manter = 1 if buffer.endswith(SYNC[:1]) else 0
+                texto, buffer = buffer[:len(buffer) - manter], buffer[len(buffer) - manter:]
+                saida.write(texto.decode('utf-8', errors='replace'))
+                break
+
+            if pos > 0:
+                saida.write(buffer[:pos].decode('utf-8', errors='replace'))
+                buffer = buffer[pos:]
+
+            if len(buffer) < 4:
+                break
+            nargs, nivel_modulo = buffer[2], buffer[3]
+            tamanho = 4 + 8 + 4 * nargs
+            if nargs > 8:
+                # Sync falso: repassa o byte e continua procurando
+                saida.write(buffer[:1].decode('utf-8', errors='replace'))
+                buffer = buffer[1:]
+                continue
+            if len(buffer) < tamanho:
+                break
+
+            timestamp, endereco = struct.unpack_from('<II', buffer, 4)
+            args = struct.unpack_from('<%dI' % nargs, buffer, 12)
+            buffer = buffer[tamanho:]
+
+            fmt = elf.string(endereco)
+            if fmt is None:
+                fmt = '<formato desconhecido 0x%08X>\n' % endereco
+
+            nivel = NIVEIS.get(nivel_modulo >> 5, '?')
+            modulo = nivel_modulo & 0x1F
+            nome = MODULOS[modulo] if modulo < len(MODULOS) else str(modulo)
+            saida.write('%10.3f %s/%-5s %s' % (timestamp / 1e6, nivel, nome, formatar(elf, fmt, args)))
+        saida.flush()
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    elf = Elf(sys.argv[1])
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], 'rb', buffering=0) as entrada:
+            decodificar(elf, entrada, sys.stdout)
+    else:
+        decodificar(elf, sys.stdin.buffer, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
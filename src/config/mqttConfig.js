@@ -1,6 +1,6 @@
 import { connect } from "mqtt";
 import { updateStatus, getStatusFromAGV } from "../services/agvService.js";
-import { getTagInfo } from "../services/rfidService.js";
+import { getTagInfo, getAllTags } from "../services/rfidService.js";
 
 const mqttOptions = {
   host: "localhost",
@@ -153,10 +153,18 @@ client.on("message", (topic, message) => {
       console.log(`🎨🎨🎨 [MQTT CONFIG] HANDLER DE COR FINALIZADO! 🎨🎨🎨\n`);
     }
 
+    // Resultado dos comandos de calibração do sensor de cor
+    if (topic === "agv/color/calibration") {
+      console.log(`[MQTT CONFIG] 🎨 Calibração de cor:`, data);
+      import("../services/socketService.js").then(({ broadcast }) => {
+        broadcast("agv/color/calibration", data);
+      });
+    }
+
     // Log se nenhum handler foi executado
-    if (topic !== "agv/rfid" && topic !== "agv/status" && topic !== "agv/distance" && topic !== "agv/color" && topic !== "agv/imu") {
+    if (topic !== "agv/rfid" && topic !== "agv/status" && topic !== "agv/distance" && topic !== "agv/color" && topic !== "agv/imu" && topic !== "agv/color/calibration") {
       console.warn(`[MQTT CONFIG] ⚠️ TÓPICO NÃO RECONHECIDO: "${topic}"`);
-      console.warn(`[MQTT CONFIG] Handlers disponíveis: agv/rfid, agv/status, agv/distance, agv/color, agv/imu`);
+      console.warn(`[MQTT CONFIG] Handlers disponíveis: agv/rfid, agv/status, agv/distance, agv/color, agv/imu, agv/color/calibration`);
     }
   } catch (e) {
     console.error("[MQTT CONFIG] ❌ Erro ao processar mensagem:", e);
@@ -170,7 +178,7 @@ client.on("connect", () => {
 
   // Subscrever aos tópicos
   client.subscribe(
-    ["agv/status", "agv/rfid", "agv/distance", "agv/color", "agv/imu"],
+    ["agv/status", "agv/rfid", "agv/distance", "agv/color", "agv/imu", "agv/color/calibration"],
     { qos: 1 },
     (err, granted) => {
       if (err) {
@@ -181,6 +189,11 @@ client.on("connect", () => {
       }
     }
   );
+
+  // Cadastro de tags retido no broker para o AGV (agv/rfid/tags/<UID>)
+  import("../controllers/mqttController.js").then(({ sincronizarTagsRfid }) => {
+    sincronizarTagsRfid(getAllTags());
+  });
 });
 
 client.on("error", (err) => {
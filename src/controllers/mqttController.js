@@ -1,9 +1,43 @@
 import client from "../config/mqttConfig.js";
 
 // O listener de mensagens agora está em mqttConfig.js
-// Este arquivo apenas exporta a função de publicar rota
+// Este arquivo apenas exporta as funções de publicação
 
 export function publicarRota(rota) {
   client.publish("agv/commands", JSON.stringify(rota));
   console.log("[MQTT] Rota enviada:", rota);
 }
+
+/**
+ * Publica uma tag RFID para o AGV em agv/rfid/tags/<UID>, retida no broker:
+ * o firmware assina agv/rfid/tags/+ e recebe o cadastro inteiro a cada
+ * conexão, inclusive depois de um reset. Remoções também ficam retidas.
+ */
+export function publicarTagRfid(tagId, tag) {
+  const mensagem = tag
+    ? { tag: tagId, name: tag.name, ...(tag.node ? { node: tag.node } : {}) }
+    : { tag: tagId, deleted: true };
+  client.publish(`agv/rfid/tags/${tagId}`, JSON.stringify(mensagem), {
+    qos: 1,
+    retain: true
+  });
+  console.log("[MQTT] Tag RFID enviada ao AGV:", mensagem);
+}
+
+/**
+ * Republica todo o cadastro de tags (retido) ao conectar ao broker,
+ * para o caso de o broker ter perdido as mensagens retidas.
+ */
+export function sincronizarTagsRfid(tags) {
+  tags.forEach(({ tagId, ...tag }) => publicarTagRfid(tagId, tag));
+  console.log(`[MQTT] Cadastro de tags RFID sincronizado (${tags.length} tags)`);
+}
+
+/**
+ * Envia um comando de calibração do sensor de cor ao AGV
+ * (sample/save/reset/abort). O resultado volta em agv/color/calibration.
+ */
+export function publicarCalibracaoCor(comando) {
+  client.publish("agv/color/calibrate", JSON.stringify(comando), { qos: 1 });
+  console.log("[MQTT] Comando de calibração de cor enviado:", comando);
+}
@@ -3,6 +3,7 @@ import { getStatus } from "../controllers/dataController.js";
 import { generateRoute } from "../controllers/routeController.js";
 import rfidRoutes from "./rfidRoutes.js";
 import { broadcast } from "../services/socketService.js";
+import { publicarCalibracaoCor } from "../controllers/mqttController.js";
 
 const router = Router();
 
@@ -26,4 +27,31 @@ router.post("/test/color", (req, res) => {
   res.json({ success: true, data: testData });
 });
 
+/**
+ * POST /api/color/calibration
+ * Calibração do sensor de cor com o AGV parado sobre o marcador
+ * Body: { cmd: "sample", color: "Verde" } | { cmd: "save" | "reset" | "abort" }
+ */
+router.post("/color/calibration", (req, res) => {
+  const { cmd, color } = req.body;
+  const comandos = ["sample", "save", "reset", "abort"];
+
+  if (!comandos.includes(cmd)) {
+    return res.status(400).json({
+      success: false,
+      error: `cmd deve ser um de: ${comandos.join(", ")}`
+    });
+  }
+  if (cmd === "sample" && (typeof color !== "string" || !color.trim())) {
+    return res.status(400).json({
+      success: false,
+      error: "color é obrigatório para cmd=sample"
+    });
+  }
+
+  const comando = cmd === "sample" ? { cmd, color: color.trim() } : { cmd };
+  publicarCalibracaoCor(comando);
+  res.status(202).json({ success: true, command: comando });
+});
+
 export default router;
@@ -7,6 +7,7 @@ import {
   deleteTag,
   tagExists
 } from "../services/rfidService.js";
+import { publicarTagRfid } from "../controllers/mqttController.js";
 
 const router = Router();
 
@@ -47,11 +48,11 @@ router.get("/tags/:tagId", (req, res) => {
 /**
  * POST /api/rfid/tags
  * Cadastra uma nova tag
- * Body: { tagId: "ABC123", itemName: "Caixa de Peças" }
+ * Body: { tagId: "ABC123", itemName: "Caixa de Peças", node: "Lilás" (opcional) }
  */
 router.post("/tags", (req, res) => {
   try {
-    const { tagId, itemName } = req.body;
+    const { tagId, itemName, node } = req.body;
 
     if (!tagId || !itemName) {
       return res.status(400).json({
@@ -60,6 +61,13 @@ router.post("/tags", (req, res) => {
       });
     }
 
+    if (node != null && typeof node !== "string") {
+      return res.status(400).json({
+        success: false,
+        error: "node deve ser o nome de um nó do mapa"
+      });
+    }
+
     if (tagExists(tagId)) {
       return res.status(409).json({
         success: false,
@@ -67,7 +75,8 @@ router.post("/tags", (req, res) => {
       });
     }
 
-    const tag = registerTag(tagId, itemName);
+    const tag = registerTag(tagId, itemName, node);
+    publicarTagRfid(tagId, tag);
     res.status(201).json({ success: true, tag: { tagId, ...tag } });
   } catch (error) {
     console.error("[RFID ROUTES] Erro ao cadastrar tag:", error);
@@ -77,22 +86,30 @@ router.post("/tags", (req, res) => {
 
 /**
  * PUT /api/rfid/tags/:tagId
- * Renomeia uma tag existente
- * Body: { itemName: "Novo Nome" }
+ * Renomeia uma tag existente e/ou troca o nó do mapa
+ * Body: { itemName: "Novo Nome", node: "Lilás" } (node null ou "" remove o nó)
  */
 router.put("/tags/:tagId", (req, res) => {
   try {
     const { tagId } = req.params;
-    const { itemName } = req.body;
+    const { itemName, node } = req.body;
+
+    if (!itemName && node === undefined) {
+      return res.status(400).json({
+        success: false,
+        error: "itemName ou node é obrigatório"
+      });
+    }
 
-    if (!itemName) {
+    if (node != null && typeof node !== "string") {
       return res.status(400).json({
         success: false,
-        error: "itemName é obrigatório"
+        error: "node deve ser o nome de um nó do mapa"
       });
     }
 
-    const tag = renameTag(tagId, itemName);
+    const tag = renameTag(tagId, itemName, node);
+    publicarTagRfid(tagId, tag);
     res.json({ success: true, tag: { tagId, ...tag } });
   } catch (error) {
     console.error("[RFID ROUTES] Erro ao renomear tag:", error);
@@ -113,6 +130,7 @@ router.delete("/tags/:tagId", (req, res) => {
   try {
     const { tagId } = req.params;
     const deletedTag = deleteTag(tagId);
+    publicarTagRfid(tagId, null);
     res.json({ success: true, tag: { tagId, ...deletedTag } });
   } catch (error) {
     console.error("[RFID ROUTES] Erro ao deletar tag:", error);
@@ -6,7 +6,7 @@ const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 const RFID_DB_PATH = path.join(__dirname, '../../data/rfid-tags.json');
 
-// Estrutura: { "tag_id": { name: "Nome do Item", createdAt: timestamp, updatedAt: timestamp } }
+// Estrutura: { "tag_id": { name: "Nome do Item", node: "Nó do mapa" (opcional), createdAt: timestamp, updatedAt: timestamp } }
 let rfidDatabase = {};
 
 /**
@@ -49,9 +49,10 @@ function saveDatabase() {
 }
 
 /**
- * Cadastra uma nova tag RFID com um nome de item
+ * Cadastra uma nova tag RFID com um nome de item e, opcionalmente, o nó do
+ * mapa onde ela está (usado pelo AGV para se localizar)
  */
-export function registerTag(tagId, itemName) {
+export function registerTag(tagId, itemName, node) {
   if (!tagId || !itemName) {
     throw new Error('Tag ID e nome do item são obrigatórios');
   }
@@ -59,12 +60,13 @@ export function registerTag(tagId, itemName) {
   const now = Date.now();
   rfidDatabase[tagId] = {
     name: itemName,
+    ...(node ? { node } : {}),
     createdAt: now,
     updatedAt: now
   };
 
   saveDatabase();
-  console.log(`[RFID SERVICE] ✅ Tag cadastrada: ${tagId} -> ${itemName}`);
+  console.log(`[RFID SERVICE] ✅ Tag cadastrada: ${tagId} -> ${itemName}${node ? ` (nó ${node})` : ''}`);
   return rfidDatabase[tagId];
 }
 
@@ -86,22 +88,31 @@ export function getAllTags() {
 }
 
 /**
- * Renomeia um item associado a uma tag
+ * Renomeia um item associado a uma tag e/ou troca o nó do mapa.
+ * newName ou node undefined mantém o valor; node null ou "" remove o nó.
  */
-export function renameTag(tagId, newName) {
+export function renameTag(tagId, newName, node) {
   if (!rfidDatabase[tagId]) {
     throw new Error('Tag não encontrada');
   }
 
-  if (!newName) {
-    throw new Error('Novo nome é obrigatório');
+  if (!newName && node === undefined) {
+    throw new Error('Novo nome ou nó é obrigatório');
   }
 
-  rfidDatabase[tagId].name = newName;
+  if (newName) {
+    rfidDatabase[tagId].name = newName;
+  }
+  if (node) {
+    rfidDatabase[tagId].node = node;
+  } else if (node !== undefined) {
+    delete rfidDatabase[tagId].node;
+  }
   rfidDatabase[tagId].updatedAt = Date.now();
 
   saveDatabase();
-  console.log(`[RFID SERVICE] ✏️ Tag renomeada: ${tagId} -> ${newName}`);
+  console.log(`[RFID SERVICE] ✏️ Tag alterada: ${tagId} -> ${rfidDatabase[tagId].name}` +
+    (rfidDatabase[tagId].node ? ` (nó ${rfidDatabase[tagId].node})` : ''));
   return rfidDatabase[tagId];
 }
 